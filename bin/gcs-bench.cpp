@@ -0,0 +1,601 @@
+// -----------------------------------------------------------------
+// gcs-bench
+//
+// Benchmark and regression harness for the planning pipeline.
+//
+// Generates synthetic calendars (weekly / daily / monthly series,
+// COUNT and UNTIL bounds, EXDATEs, RECURRENCE-ID overrides, and YAML
+// descriptions with sun-relative start times), then times each stage:
+//
+//   native.parse   gcs::IcsPushParser          (gcs-export parse-ics)
+//   native.expand  gcs::expandSeries           (gcs-export expand)
+//   native.order   gcs::relaxBundleOrder       (gcs-export order)
+//   php.parse      IcsParser::parse()
+//   php.expand     SchedulerRunner::run() on parsed events
+//   php.order      SchedulerPlanner steps 2-5 (bundles, order, flatten)
+//   php.diff       SchedulerDiff::compute()
+//   php.incremental  re-plan of every 10th UID edited, checked against
+//                    a full plan (a mismatch fails the run)
+//
+// PHP stages run through bin/gcs-bench.php and only with --php. The
+// best of --runs runs is reported per stage, with throughput (series
+// per second) and the peak RSS of the process that ran it.
+//
+// Baselines: --write-baseline stores the results in --baseline=FILE;
+// a later run with the same --baseline fails (exit 1) when any stage
+// is slower than baseline * (1 + --tolerance) and more than
+// BASELINE_NOISE_MS slower in absolute terms. Baselines are per
+// machine; record one on the target device.
+//
+// Build (own target next to gcs-export; no libfpp needed):
+//   g++ -std=c++17 -O2 -Ibin bin/gcs-bench.cpp -ljsoncpp -o bin/gcs-bench
+//
+// Usage:
+//   gcs-bench [--sizes=10,100,1000,10000] [--runs=3] [--work-dir=DIR]
+//             [--php[=BIN]] [--php-script=FILE]
+//             [--baseline=FILE [--write-baseline]] [--tolerance=0.25]
+// -----------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#include <jsoncpp/json/json.h>
+
+#include "gcs/BundleOrder.h"
+#include "gcs/CivilDate.h"
+#include "gcs/DayMask.h"
+#include "gcs/IcsParse.h"
+#include "gcs/MappedFile.h"
+#include "gcs/RruleExpand.h"
+#include "gcs/ZoneClock.h"
+
+static const char* BENCH_TZ = "America/Chicago";
+
+// Matches SchedulerPlanner::MAX_ORDER_PASSES
+static const int BENCH_MAX_ORDER_PASSES = 50;
+
+// Report order
+static const char* BENCH_STAGES[] = {
+    "native.parse", "native.expand", "native.order",
+    "php.parse", "php.expand", "php.order", "php.diff", "php.incremental",
+};
+
+// Regressions smaller than this are timer noise on small sizes
+static const double BASELINE_NOISE_MS = 2.0;
+
+struct BenchOptions {
+    std::vector<int> sizes = { 10, 100, 1000, 10000 };
+    int runs = 3;
+    std::string workDir = "/tmp/gcs-bench";
+    std::string php;            // empty: PHP stages skipped
+    std::string phpScript;
+    std::string baseline;
+    bool writeBaseline = false;
+    double tolerance = 0.25;
+};
+
+struct StageResult {
+    double ms = 0.0;            // best run
+    long long peakKb = 0;
+};
+
+typedef std::map<std::string, StageResult> StageResults;    // "native.parse@1000"
+
+static double msSince(std::chrono::steady_clock::time_point t)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t).count();
+}
+
+static long long peakRssKb()
+{
+    struct rusage ru {};
+    return ::getrusage(RUSAGE_SELF, &ru) == 0 ? static_cast<long long>(ru.ru_maxrss) : 0;
+}
+
+// -----------------------------------------------------------------
+// Synthetic calendar
+//
+// Deterministic for a given size (fixed LCG seed); dates are relative
+// to today so the planner horizon and expiry rules see live series.
+// -----------------------------------------------------------------
+class BenchRandom {
+public:
+    explicit BenchRandom(unsigned long long seed) : state_(seed) {}
+
+    int below(int n)
+    {
+        state_ = state_ * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<int>((state_ >> 33) % static_cast<unsigned long long>(n));
+    }
+
+private:
+    unsigned long long state_;
+};
+
+static std::string icsDate(int day)
+{
+    const gcs::CivilDate c = gcs::civilFromDays(day);
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "%04d%02d%02d", c.year, c.month, c.day);
+    return buf;
+}
+
+static std::string icsDateTime(int day, int sod)
+{
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "T%02d%02d%02d", sod / 3600, (sod / 60) % 60, sod % 60);
+    return icsDate(day) + buf;
+}
+
+static bool writeSyntheticIcs(const std::string& path, int nSeries)
+{
+    static const char* DAY_CODES[] = { "SU", "MO", "TU", "WE", "TH", "FR", "SA" };
+    static const char* SYMBOLIC[] = { "Dawn", "SunRise", "SunSet", "Dusk" };
+
+    BenchRandom rnd(0x9e3779b97f4a7c15ULL ^ static_cast<unsigned long long>(nSeries));
+    const int today = static_cast<int>(std::time(nullptr) / 86400);
+
+    std::ostringstream out;
+    out << "BEGIN:VCALENDAR\r\nVERSION:2.0\r\nPRODID:-//gcs-bench//EN\r\n"
+        << "X-WR-TIMEZONE:" << BENCH_TZ << "\r\n";
+
+    for (int i = 0; i < nSeries; i++) {
+        const int startDay = today - 60 + rnd.below(360);
+        const int sod = (8 + rnd.below(15)) * 3600 + rnd.below(4) * 900;
+        const int duration = (2 + rnd.below(11)) * 900;
+        const int kind = i % 10;
+
+        const std::string uid = "bench-" + std::to_string(i) + "@gcs-bench";
+
+        out << "BEGIN:VEVENT\r\n"
+            << "UID:" << uid << "\r\n"
+            << "SUMMARY:cmd:Bench Command " << (i % 97) << "\r\n"
+            << "DTSTART;TZID=" << BENCH_TZ << ":" << icsDateTime(startDay, sod) << "\r\n"
+            << "DTEND;TZID=" << BENCH_TZ << ":" << icsDateTime(startDay, sod + duration) << "\r\n";
+
+        bool recurring = true;
+        switch (kind) {
+            case 0: case 1: case 2: case 3: {
+                std::string byDay;
+                const int mask = 1 + rnd.below(127);
+                for (int d = 0; d < 7; d++) {
+                    if (mask & (1 << d)) {
+                        byDay += (byDay.empty() ? "" : ",") + std::string(DAY_CODES[d]);
+                    }
+                }
+                out << "RRULE:FREQ=WEEKLY;BYDAY=" << byDay << "\r\n";
+                break;
+            }
+            case 4: case 5:
+                out << "RRULE:FREQ=DAILY\r\n";
+                break;
+            case 6:
+                out << "RRULE:FREQ=MONTHLY;BYMONTHDAY=" << (1 + rnd.below(28)) << "\r\n";
+                break;
+            case 7:
+                out << "RRULE:FREQ=WEEKLY;COUNT=" << (5 + rnd.below(40)) << "\r\n";
+                break;
+            case 8:
+                out << "RRULE:FREQ=DAILY;UNTIL=" << icsDate(startDay + 30 + rnd.below(300)) << "T235959Z\r\n";
+                break;
+            default:
+                recurring = false;
+                break;
+        }
+
+        if (recurring && i % 4 == 0) {
+            out << "EXDATE;TZID=" << BENCH_TZ << ":"
+                << icsDateTime(startDay + 7, sod) << "," << icsDateTime(startDay + 14, sod) << "\r\n";
+        }
+
+        if (i % 5 == 0) {
+            out << "DESCRIPTION:stopType: graceful\\nstart:\\n  symbolic: "
+                << SYMBOLIC[rnd.below(4)] << "\\n  offsetMinutes: " << (rnd.below(61) - 30) << "\r\n";
+        }
+
+        out << "END:VEVENT\r\n";
+
+        if (recurring && kind != 6 && i % 7 == 0) {
+            const int rid = startDay + 21;
+            out << "BEGIN:VEVENT\r\n"
+                << "UID:" << uid << "\r\n"
+                << "SUMMARY:cmd:Bench Command " << (i % 97) << "\r\n"
+                << "RECURRENCE-ID;TZID=" << BENCH_TZ << ":" << icsDateTime(rid, sod) << "\r\n"
+                << "DTSTART;TZID=" << BENCH_TZ << ":" << icsDateTime(rid, sod + 3600) << "\r\n"
+                << "DTEND;TZID=" << BENCH_TZ << ":" << icsDateTime(rid, sod + 3600 + duration) << "\r\n"
+                << "END:VEVENT\r\n";
+        }
+    }
+
+    out << "END:VCALENDAR\r\n";
+
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    f << out.str();
+    return static_cast<bool>(f);
+}
+
+// -----------------------------------------------------------------
+// Native stages (in-process, same code paths as gcs-export)
+// -----------------------------------------------------------------
+struct NativeRun {
+    double parseMs = 0.0;
+    double expandMs = 0.0;
+    double orderMs = 0.0;
+    size_t events = 0;
+    size_t occurrences = 0;
+    int passes = 0;
+};
+
+/** Series view of the parsed events, grouped by UID in first-seen order */
+struct BenchSeries {
+    Json::Value base;   // null for override-only UIDs
+    Json::Value overrides = Json::Value(Json::arrayValue);
+};
+
+static std::string ymdOf(const std::string& wall)
+{
+    return wall.substr(0, 10);
+}
+
+static gcs::PackedBundle bundleFromBase(const Json::Value& base, const std::string& guardYmd)
+{
+    const std::string start = base["start"].asString();
+    const Json::Value& rrule = base["rrule"];
+
+    std::string endYmd = guardYmd;
+    const std::string until = rrule.get("UNTIL", "").asString();
+    if (until.size() >= 8) {
+        endYmd = until.substr(0, 4) + "-" + until.substr(4, 2) + "-" + until.substr(6, 2);
+    } else if (!rrule.isObject()) {
+        endYmd = ymdOf(start);
+    }
+
+    int startDay = 0;
+    gcs::order::parseYmd(ymdOf(start), startDay);
+
+    gcs::DayMask mask = gcs::dayMaskOf(gcs::weekdayFromDays(startDay));
+    if (rrule.get("FREQ", "").asString() == "DAILY") {
+        mask = gcs::DAYMASK_ALL;
+    } else if (rrule.isMember("BYDAY")) {
+        mask = 0;
+        for (const std::string& code : gcs::rrule::splitList(rrule["BYDAY"].asString())) {
+            const int dow = gcs::rrule::dowFromCode(code.size() > 2 ? code.substr(code.size() - 2) : code);
+            if (dow >= 0) {
+                mask |= gcs::dayMaskOf(dow);
+            }
+        }
+    }
+
+    Json::Value v(Json::objectValue);
+    v["start"] = ymdOf(start);
+    v["end"] = endYmd < ymdOf(start) ? ymdOf(start) : endYmd;
+    v["dayMask"] = static_cast<int>(mask);
+    v["startTime"] = start.substr(11);
+    v["endTime"] = base["end"].asString().substr(11);
+
+    gcs::PackedBundle b;
+    gcs::packBundle(v, b);
+    return b;
+}
+
+static NativeRun runNativeStages(const std::string& icsPath)
+{
+    NativeRun r;
+
+    const time_t now = std::time(nullptr);
+    const int guardYear = gcs::civilFromDays(static_cast<int>(now / 86400)).year + 5;
+    const std::string guardYmd = std::to_string(guardYear) + "-12-31";
+
+    gcs::ZoneClock clock(BENCH_TZ);
+
+    gcs::WallSeconds horizonStart = gcs::wallFromTime(clock.local(now));
+    gcs::WallSeconds horizonEnd = gcs::wallFromParts(guardYear, 12, 31, 0, 0, 0);
+
+    // Parse
+    gcs::MappedFile file;
+    if (!file.open(icsPath)) {
+        return r;
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    gcs::IcsPushParser parser(clock, now, true);
+    parser.setHorizonEnd(clock.toEpoch(gcs::WallTime{ guardYear, 12, 31, 0, 0, 0 }, clock.fppZone()));
+    std::vector<Json::Value> events;
+    parser.setEventSink([&events](const gcs::IcsEvent& ev) {
+        events.push_back(gcs::icsEventToJson(ev));
+    });
+    parser.feed(file.data(), file.size());
+    parser.finish();
+    r.parseMs = msSince(t0);
+    r.events = events.size();
+
+    std::vector<BenchSeries> series;
+    std::map<std::string, size_t> byUid;
+    for (const Json::Value& ev : events) {
+        const std::string uid = ev["uid"].asString();
+        auto it = byUid.find(uid);
+        if (it == byUid.end()) {
+            it = byUid.emplace(uid, series.size()).first;
+            series.emplace_back();
+        }
+        BenchSeries& s = series[it->second];
+        if (ev["isOverride"].asBool()) {
+            Json::Value ov(Json::objectValue);
+            ov["rid"] = ev["recurrenceId"];
+            ov["start"] = ev["start"];
+            ov["end"] = ev["end"];
+            s.overrides.append(ov);
+        } else if (s.base.isNull()) {
+            s.base = ev;
+        }
+    }
+
+    // Expand (request decoding included, as in gcs-export expand)
+    t0 = std::chrono::steady_clock::now();
+    std::vector<gcs::Occurrence> occs;
+    for (const BenchSeries& s : series) {
+        Json::Value req(Json::objectValue);
+        if (!s.base.isNull()) {
+            req["start"] = s.base["start"];
+            req["end"] = s.base["end"];
+            req["rrule"] = s.base["rrule"];
+            req["exDates"] = s.base["exDates"];
+        }
+        req["overrides"] = s.overrides;
+
+        if (gcs::expandSeries(gcs::seriesFromJson(req), horizonStart, horizonEnd, clock, occs)) {
+            r.occurrences += occs.size();
+        }
+    }
+    r.expandMs = msSince(t0);
+
+    // Order (baseline sort + dominance relaxation)
+    t0 = std::chrono::steady_clock::now();
+    std::vector<gcs::PackedBundle> bundles;
+    for (const BenchSeries& s : series) {
+        if (!s.base.isNull()) {
+            bundles.push_back(bundleFromBase(s.base, guardYmd));
+        }
+    }
+    std::stable_sort(bundles.begin(), bundles.end(), [](const gcs::PackedBundle& a, const gcs::PackedBundle& b) {
+        return a.startDay != b.startDay ? a.startDay < b.startDay : a.startSec < b.startSec;
+    });
+    const gcs::OrderResult order = gcs::relaxBundleOrder(bundles, BENCH_MAX_ORDER_PASSES);
+    r.orderMs = msSince(t0);
+    r.passes = order.passes;
+
+    return r;
+}
+
+// -----------------------------------------------------------------
+// PHP stages (bin/gcs-bench.php prints one JSON object)
+// -----------------------------------------------------------------
+static bool runPhpStages(const BenchOptions& opts, const std::string& icsPath, Json::Value& out)
+{
+    const std::string cmd = opts.php + " " + opts.phpScript + " " + icsPath +
+        " " + std::to_string(opts.runs) + " " + BENCH_TZ + " 2>/dev/null";
+
+    FILE* p = ::popen(cmd.c_str(), "r");
+    if (!p) {
+        return false;
+    }
+
+    std::string body;
+    char buf[4096];
+    size_t n = 0;
+    while ((n = std::fread(buf, 1, sizeof(buf), p)) > 0) {
+        body.append(buf, n);
+    }
+    const int rc = ::pclose(p);
+
+    Json::CharReaderBuilder rb;
+    std::unique_ptr<Json::CharReader> reader(rb.newCharReader());
+    std::string errs;
+    // Parsed even on failure: a failed check reports {"ok": false, "error"}
+    const bool parsed = reader->parse(body.data(), body.data() + body.size(), &out, &errs) && out.isObject();
+    return rc == 0 && parsed && out.get("ok", false).asBool();
+}
+
+// -----------------------------------------------------------------
+// Baseline
+// -----------------------------------------------------------------
+static bool loadBaseline(const std::string& path, std::map<std::string, double>& out)
+{
+    std::ifstream in(path);
+    Json::Value v;
+    Json::CharReaderBuilder rb;
+    std::string errs;
+    if (!in || !Json::parseFromStream(rb, in, &v, &errs) || !v["stages"].isObject()) {
+        return false;
+    }
+    for (const std::string& key : v["stages"].getMemberNames()) {
+        out[key] = v["stages"][key].asDouble();
+    }
+    return true;
+}
+
+static bool writeBaseline(const std::string& path, const StageResults& results)
+{
+    Json::Value v(Json::objectValue);
+    v["format"] = 1;
+    v["stages"] = Json::Value(Json::objectValue);
+    for (const auto& kv : results) {
+        v["stages"][kv.first] = kv.second.ms;
+    }
+
+    std::ofstream f(path, std::ios::trunc);
+    f << v.toStyledString();
+    return static_cast<bool>(f);
+}
+
+// -----------------------------------------------------------------
+// Main
+// -----------------------------------------------------------------
+static std::vector<int> parseSizes(const char* s)
+{
+    std::vector<int> sizes;
+    for (const std::string& item : gcs::rrule::splitList(s)) {
+        const int n = std::atoi(item.c_str());
+        if (n > 0) {
+            sizes.push_back(n);
+        }
+    }
+    return sizes;
+}
+
+static std::string dirnameOfArg0(const char* argv0)
+{
+    const std::string s = argv0;
+    const size_t slash = s.find_last_of('/');
+    return slash == std::string::npos ? "." : s.substr(0, slash);
+}
+
+static void record(StageResults& results, const std::string& key, double ms, long long peakKb)
+{
+    auto it = results.find(key);
+    if (it == results.end() || ms < it->second.ms) {
+        results[key] = { ms, peakKb };
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions opts;
+    opts.phpScript = dirnameOfArg0(argv[0]) + "/gcs-bench.php";
+
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        if (std::strncmp(a, "--sizes=", 8) == 0) {
+            opts.sizes = parseSizes(a + 8);
+        } else if (std::strncmp(a, "--runs=", 7) == 0) {
+            opts.runs = std::max(1, std::atoi(a + 7));
+        } else if (std::strncmp(a, "--work-dir=", 11) == 0) {
+            opts.workDir = a + 11;
+        } else if (std::strcmp(a, "--php") == 0) {
+            opts.php = "php";
+        } else if (std::strncmp(a, "--php=", 6) == 0) {
+            opts.php = a + 6;
+        } else if (std::strncmp(a, "--php-script=", 13) == 0) {
+            opts.phpScript = a + 13;
+        } else if (std::strncmp(a, "--baseline=", 11) == 0) {
+            opts.baseline = a + 11;
+        } else if (std::strcmp(a, "--write-baseline") == 0) {
+            opts.writeBaseline = true;
+        } else if (std::strncmp(a, "--tolerance=", 12) == 0) {
+            opts.tolerance = std::max(0.0, std::atof(a + 12));
+        } else {
+            std::cerr << "Usage: gcs-bench [--sizes=10,100,1000,10000] [--runs=N] [--work-dir=DIR]"
+                         " [--php[=BIN]] [--php-script=FILE] [--baseline=FILE [--write-baseline]]"
+                         " [--tolerance=FRACTION]\n";
+            return 2;
+        }
+    }
+
+    if (opts.writeBaseline && opts.baseline.empty()) {
+        std::cerr << "ERROR: --write-baseline needs --baseline=FILE\n";
+        return 2;
+    }
+
+    ::mkdir(opts.workDir.c_str(), 0755);
+
+    StageResults results;
+
+    std::printf("%-16s %8s %12s %14s %10s\n", "stage", "series", "best ms", "series/s", "peak KB");
+
+    for (int n : opts.sizes) {
+        const std::string icsPath = opts.workDir + "/bench-" + std::to_string(n) + ".ics";
+        if (!writeSyntheticIcs(icsPath, n)) {
+            std::cerr << "ERROR: Unable to write " << icsPath << "\n";
+            return 2;
+        }
+
+        const std::string at = "@" + std::to_string(n);
+
+        for (int run = 0; run < opts.runs; run++) {
+            const NativeRun r = runNativeStages(icsPath);
+            const long long kb = peakRssKb();
+            record(results, "native.parse" + at, r.parseMs, kb);
+            record(results, "native.expand" + at, r.expandMs, kb);
+            record(results, "native.order" + at, r.orderMs, kb);
+        }
+
+        if (!opts.php.empty()) {
+            Json::Value php;
+            if (!runPhpStages(opts, icsPath, php)) {
+                std::cerr << "ERROR: PHP stages failed for " << icsPath;
+                if (php.isObject() && php["error"].isString()) {
+                    std::cerr << ": " << php["error"].asString();
+                }
+                std::cerr << "\n";
+                return 2;
+            }
+            for (const std::string& stage : php["stages"].getMemberNames()) {
+                record(results, "php." + stage + at,
+                       php["stages"][stage]["ms"].asDouble(),
+                       php["peakKb"].asInt64());
+            }
+        }
+
+        for (const char* stage : BENCH_STAGES) {
+            auto it = results.find(stage + at);
+            if (it == results.end()) {
+                continue;
+            }
+            const double perSec = it->second.ms > 0.0 ? n * 1000.0 / it->second.ms : 0.0;
+            std::printf("%-16s %8d %12.2f %14.0f %10lld\n",
+                        stage, n, it->second.ms, perSec, it->second.peakKb);
+        }
+    }
+
+    if (opts.baseline.empty()) {
+        return 0;
+    }
+
+    if (opts.writeBaseline) {
+        if (!writeBaseline(opts.baseline, results)) {
+            std::cerr << "ERROR: Unable to write " << opts.baseline << "\n";
+            return 2;
+        }
+        std::printf("baseline written: %s\n", opts.baseline.c_str());
+        return 0;
+    }
+
+    std::map<std::string, double> base;
+    if (!loadBaseline(opts.baseline, base)) {
+        std::cerr << "ERROR: Unable to read baseline " << opts.baseline << "\n";
+        return 2;
+    }
+
+    int regressions = 0;
+    for (const auto& kv : results) {
+        auto it = base.find(kv.first);
+        if (it == base.end()) {
+            continue;
+        }
+        const double limit = it->second * (1.0 + opts.tolerance);
+        if (kv.second.ms > limit && kv.second.ms - it->second > BASELINE_NOISE_MS) {
+            std::printf("REGRESSION %s: %.2f ms (baseline %.2f ms, limit %.2f ms)\n",
+                        kv.first.c_str(), kv.second.ms, it->second, limit);
+            regressions++;
+        }
+    }
+
+    if (regressions > 0) {
+        return 1;
+    }
+    std::printf("no regressions against %s\n", opts.baseline.c_str());
+    return 0;
+}
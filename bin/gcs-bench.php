@@ -0,0 +1,232 @@
+<?php
+declare(strict_types=1);
+
+/**
+ * gcs-bench PHP stages
+ *
+ * Run by bin/gcs-bench (see gcs-bench.cpp) for one synthetic calendar.
+ * Times the PHP implementation of each planning stage and prints one
+ * JSON object:
+ *   {"ok", "peakKb", "counts": {...},
+ *    "stages": {"parse"|"expand"|"order"|"diff"|"incremental": {"ms"}}}
+ * or {"ok": false, "error"} (exit 1) when the incremental check fails.
+ *
+ * Usage: php gcs-bench.php <calendar.ics> <runs> <timezone>
+ *
+ * NOTES:
+ * - The native engine and the plan cache are disabled, so every stage
+ *   runs in PHP
+ * - "order" is SchedulerPlanner steps 2-5 on the runner result; above
+ *   the managed-entry cap it still runs in full and then reports the
+ *   limit error, so the diff input is planned in cap-sized slices
+ * - The diff runs against a copy of the desired entries with every
+ *   10th changed, every 20th missing, and 10% unmanaged entries added
+ * - "incremental" re-plans with every 10th UID edited (end +15 min)
+ *   against the bundle cache of the unedited plan, as planIncremental()
+ *   does, and checks the result equals a full plan of the edited
+ *   calendar (runtime.verify_incremental, without touching runtime/)
+ */
+
+if (PHP_SAPI !== 'cli') {
+    return;
+}
+
+$icsPath = (string)($argv[1] ?? '');
+$runs    = max(1, (int)($argv[2] ?? 3));
+$tz      = (string)($argv[3] ?? 'UTC');
+
+require_once __DIR__ . '/../src/bootstrap.php';
+
+date_default_timezone_set($tz);
+
+$body = @file_get_contents($icsPath);
+if (!is_string($body) || $body === '') {
+    fwrite(STDERR, "ERROR: Unable to read {$icsPath}\n");
+    exit(2);
+}
+
+$cfg = Config::defaults();
+$cfg['runtime']['native_engine']  = false;
+$cfg['runtime']['plan_cache_ttl'] = 0;
+
+/**
+ * Best wall time of $runs calls, and the last result.
+ *
+ * @return array{0:float,1:mixed}
+ */
+function gcsBenchBest(int $runs, callable $fn): array
+{
+    $best  = INF;
+    $value = null;
+    for ($i = 0; $i < $runs; $i++) {
+        $t0    = hrtime(true);
+        $value = $fn();
+        $best  = min($best, (hrtime(true) - $t0) / 1e6);
+    }
+    return [$best, $value];
+}
+
+/**
+ * Planner steps 2-5 in $sliceSize slices of the runner's series (see
+ * "order" above); the BundleCache entries of the planned series land
+ * in $bundleEntries.
+ *
+ * @param array<string,array<string,mixed>> $cached
+ * @return array<string,mixed>
+ */
+function gcsBenchPlan(
+    ReflectionMethod $planDesired,
+    array $cfg,
+    array $runnerResult,
+    string $guardDate,
+    int $sliceSize,
+    array $cached = [],
+    ?array &$bundleEntries = null
+): array {
+    $bundleEntries = [];
+    $out = ['desiredEntries' => [], 'desiredBundles' => [], 'errors' => []];
+
+    foreach (array_chunk($runnerResult['series'] ?? [], $sliceSize) as $slice) {
+        $entries = [];
+        $part = $planDesired->invokeArgs(null, [
+            $cfg, ['ok' => true, 'series' => $slice], $guardDate, false, $cached, &$entries,
+        ]);
+        if (empty($part['ok'])) {
+            $out['errors'][] = $part['error'] ?? null;
+            continue;
+        }
+        array_push($out['desiredEntries'], ...$part['desiredEntries']);
+        array_push($out['desiredBundles'], ...$part['desiredBundles']);
+        $bundleEntries += $entries;
+    }
+
+    return $out;
+}
+
+$now        = new DateTime('now');
+$horizonEnd = FPPSemantics::getSchedulerGuardDate();
+$guardDate  = $horizonEnd->format('Y-m-d');
+
+$stages = [];
+
+/* ---------- parse ---------- */
+[$ms, $events] = gcsBenchBest($runs, static function () use ($body, $now, $horizonEnd) {
+    return (new IcsParser())->parse($body, $now, $horizonEnd);
+});
+$stages['parse'] = ['ms' => round($ms, 2)];
+
+/* ---------- expand ---------- */
+[$ms, $runnerResult] = gcsBenchBest($runs, static function () use ($cfg, $events) {
+    return (new SchedulerRunner($cfg))->run([['url' => 'bench', 'events' => $events]]);
+});
+$stages['expand'] = ['ms' => round($ms, 2)];
+
+/* ---------- order (planner steps 2-5) ---------- */
+$planDesired = new ReflectionMethod(SchedulerPlanner::class, 'planDesired');
+$planDesired->setAccessible(true);
+
+[$ms, $desired] = gcsBenchBest($runs, static function () use ($planDesired, $cfg, $runnerResult, $guardDate) {
+    return $planDesired->invoke(null, $cfg, $runnerResult, $guardDate, false);
+});
+$stages['order'] = ['ms' => round($ms, 2)];
+
+$desiredEntries = $desired['desiredEntries'] ?? null;
+if (!is_array($desiredEntries)) {
+    $limit = (int)($desired['error']['limit'] ?? 100);
+    $desiredEntries = [];
+    foreach (array_chunk($runnerResult['series'] ?? [], max(1, $limit)) as $slice) {
+        $part = $planDesired->invoke(null, $cfg, ['ok' => true, 'series' => $slice], $guardDate, false);
+        array_push($desiredEntries, ...($part['desiredEntries'] ?? []));
+    }
+}
+
+/* ---------- diff ---------- */
+$existingRows = [];
+foreach ($desiredEntries as $i => $entry) {
+    if ($i % 20 === 19) {
+        continue;
+    }
+    if ($i % 10 === 0) {
+        $entry['enabled'] = empty($entry['enabled']) ? 1 : 0;
+    }
+    $existingRows[] = $entry;
+
+    if ($i % 10 === 5) {
+        $existingRows[] = [
+            'enabled'   => 1,
+            'playlist'  => 'Unmanaged ' . $i,
+            'day'       => 7,
+            'startTime' => '12:00:00',
+            'endTime'   => '13:00:00',
+        ];
+    }
+}
+
+[$ms, $diff] = gcsBenchBest($runs, static function () use ($desiredEntries, $existingRows) {
+    $existing = [];
+    foreach ($existingRows as $row) {
+        $existing[] = new ExistingScheduleEntry($row);
+    }
+    return (new SchedulerDiff($desiredEntries, new SchedulerState($existing)))->compute();
+});
+$stages['diff'] = ['ms' => round($ms, 2)];
+
+/* ---------- incremental (edited UIDs vs. full plan) ---------- */
+$sliceSize = is_array($desired['desiredEntries'] ?? null)
+    ? max(1, count($runnerResult['series'] ?? []))
+    : max(1, (int)($desired['error']['limit'] ?? 100));
+
+gcsBenchPlan($planDesired, $cfg, $runnerResult, $guardDate, $sliceSize, [], $seed);
+$known = array_map(static fn(array $e): string => (string)$e['hash'], $seed);
+
+$editUids = [];
+$seen     = 0;
+foreach ($events as $ev) {
+    $uid = (string)($ev['uid'] ?? '');
+    if ($uid !== '' && !isset($editUids[$uid])) {
+        $editUids[$uid] = ($seen++ % 10 === 0);
+    }
+}
+$editUids = array_filter($editUids);
+
+$edited = [];
+foreach ($events as $ev) {
+    if (isset($editUids[(string)($ev['uid'] ?? '')])) {
+        $ev['end'] = date('Y-m-d H:i:s', (int)strtotime((string)$ev['end']) + 900);
+    }
+    $edited[] = $ev;
+}
+$editedSources = [['url' => 'bench', 'events' => $edited]];
+
+[$ms, $incremental] = gcsBenchBest($runs, static function () use (
+    $planDesired, $cfg, $editedSources, $known, $seed, $guardDate, $sliceSize
+) {
+    $result = (new SchedulerRunner($cfg))->run($editedSources, $known);
+    return gcsBenchPlan($planDesired, $cfg, $result, $guardDate, $sliceSize, $seed);
+});
+$stages['incremental'] = ['ms' => round($ms, 2)];
+
+$full = gcsBenchPlan($planDesired, $cfg, (new SchedulerRunner($cfg))->run($editedSources), $guardDate, $sliceSize);
+if (serialize($incremental) !== serialize($full)) {
+    echo json_encode([
+        'ok'    => false,
+        'error' => 'Incremental plan differs from full plan (' . count($editUids) . ' edited UIDs)',
+    ], JSON_UNESCAPED_SLASHES), "\n";
+    exit(1);
+}
+
+echo json_encode([
+    'ok'     => true,
+    'peakKb' => intdiv(memory_get_peak_usage(), 1024),
+    'counts' => [
+        'events'   => count($events),
+        'series'   => count($runnerResult['series'] ?? []),
+        'entries'  => count($desiredEntries),
+        'existing' => count($existingRows),
+        'creates'  => count($diff->creates()),
+        'updates'  => count($diff->updates()),
+        'deletes'  => count($diff->deletes()),
+        'edited'   => count($editUids),
+    ],
+    'stages' => $stages,
+], JSON_UNESCAPED_SLASHES), "\n";
@@ -1,18 +1,180 @@
+#include <algorithm>
 #include <iostream>
+#include <memory>
 #include <fstream>
 #include <string>
+#include <cerrno>
 #include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include <jsoncpp/json/json.h>
 
 #include "settings.h"
 #include "FPPLocale.h"
 
-static const char* OUTPUT_PATH =
-    "/home/fpp/media/plugins/GoogleCalendarScheduler/runtime/fpp-env.json";
+#include "gcs/AtomicFile.h"
+#include "gcs/BundleOrder.h"
+#include "gcs/Digest.h"
+#include "gcs/EnvSnapshot.h"
+#include "gcs/ExportWatcher.h"
+#include "gcs/HolidayTable.h"
+#include "gcs/IcsExport.h"
+#include "gcs/IcsFetch.h"
+#include "gcs/IcsParse.h"
+#include "gcs/Log.h"
+#include "gcs/MappedFile.h"
+#include "gcs/Metrics.h"
+#include "gcs/RecordStream.h"
+#include "gcs/RruleExpand.h"
+#include "gcs/SchedulePatch.h"
+#include "gcs/SunTable.h"
+#include "gcs/TargetIndex.h"
+#include "gcs/WorkerPool.h"
+
+// Default destination; --output-dir=DIR lets one binary serve
+// several plugin instances
+static const char* DEFAULT_OUTPUT_DIR =
+    "/home/fpp/media/plugins/GoogleCalendarScheduler/runtime";
+
+static const char* OUTPUT_FILE = "fpp-env.json";
+
+// Inputs watched in --watch mode
+static const char* FPP_MEDIA_DIR     = "/home/fpp/media";
+static const char* FPP_SETTINGS_FILE = "settings";
+static const char* FPP_LOCALE_DIR    = "/opt/fpp/etc/locale";
+
+// Indexed for TargetResolver.php (see gcs/TargetIndex.h) and watched
+static const char* FPP_PLAYLIST_DIR  = "/home/fpp/media/playlists";
+static const char* FPP_SEQUENCE_DIR  = "/home/fpp/media/sequences";
+
+// Binary companion (see gcs/EnvSnapshot.h); JSON stays the debug format
+static const char* SNAPSHOT_FILE = "fpp-env.bin";
+
+// Auto-sync (--watch): runtime.auto_sync_interval is read from the
+// plugin config; the worker sits next to this binary
+static const char* PLUGIN_CONFIG_FILE = "/home/fpp/media/config/plugin.googleCalendarScheduler.json";
+static const char* WORKER_SCRIPT      = "gcs-worker.php";
+static const int AUTO_SYNC_MIN_SECONDS = 60;     // AutoSync::MIN_INTERVAL
+static const int AUTO_SYNC_RECHECK_SECONDS = 60; // config re-read while disabled
+
+// -----------------------------------------------------------------
+// Command line options (all optional; defaults match plugin.php)
+// -----------------------------------------------------------------
+struct ExportOptions {
+    int sunYears = gcs::SUN_TABLE_DEFAULT_YEARS;
+    int holidayYears = gcs::HOLIDAY_TABLE_DEFAULT_YEARS;
+    bool force = false;     // rewrite even when the digest is unchanged
+    std::string outputDir = DEFAULT_OUTPUT_DIR;
+    bool watch = false;     // stay resident and re-export on change
+    int refreshSeconds = 3600;
+};
+
+static int parseIntArg(const char* arg, const char* prefix, int fallback)
+{
+    const size_t n = std::strlen(prefix);
+    if (std::strncmp(arg, prefix, n) != 0) {
+        return fallback;
+    }
+    int v = std::atoi(arg + n);
+    return (v > 0) ? v : fallback;
+}
+
+static ExportOptions parseOptions(int argc, char** argv)
+{
+    ExportOptions opts;
+    for (int i = 1; i < argc; i++) {
+        opts.sunYears = parseIntArg(argv[i], "--sun-years=", opts.sunYears);
+        opts.holidayYears = parseIntArg(argv[i], "--holiday-years=", opts.holidayYears);
+        opts.refreshSeconds = parseIntArg(argv[i], "--refresh=", opts.refreshSeconds);
+        if (std::strcmp(argv[i], "--force") == 0) {
+            opts.force = true;
+        }
+        if (std::strcmp(argv[i], "--watch") == 0) {
+            opts.watch = true;
+        }
+        if (std::strncmp(argv[i], "--output-dir=", 13) == 0 && argv[i][13] != '\0') {
+            opts.outputDir = argv[i] + 13;
+            while (opts.outputDir.size() > 1 && opts.outputDir.back() == '/') {
+                opts.outputDir.pop_back();
+            }
+        }
+    }
+    return opts;
+}
+
+static int currentLocalYear()
+{
+    time_t now = std::time(nullptr);
+    struct tm lt {};
+    localtime_r(&now, &lt);
+    return lt.tm_year + 1900;
+}
+
+// -----------------------------------------------------------------
+// Change detection
+//
+// The digest covers every input the output is derived from: FPP
+// settings, the raw locale, the media target index, and the table
+// windows (which move with the current year). Equal digest =>
+// byte-identical output.
+// -----------------------------------------------------------------
+static std::string computeEnvDigest(
+    double lat, double lon, const std::string& tz,
+    const Json::Value& locale, const Json::Value& targetIndex,
+    const ExportOptions& opts, int year)
+{
+    Json::StreamWriterBuilder wb;
+    wb["indentation"] = "";
+
+    gcs::Fnv1a64 h;
+    h.add(static_cast<long long>(gcs::ENV_SNAPSHOT_VERSION))
+     .add(lat)
+     .add(lon)
+     .add(tz)
+     .add(Json::writeString(wb, locale))
+     .add(Json::writeString(wb, targetIndex))
+     .add(static_cast<long long>(opts.sunYears))
+     .add(static_cast<long long>(opts.holidayYears))
+     .add(static_cast<long long>(year));
+    return h.hex();
+}
 
-int main()
+static std::string readExistingDigest(const std::string& path)
 {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        return std::string();
+    }
+
+    Json::Value existing;
+    Json::CharReaderBuilder rb;
+    std::string errs;
+    if (!Json::parseFromStream(rb, in, &existing, &errs) || !existing.isObject()) {
+        return std::string();
+    }
+
+    return existing["envDigest"].asString();
+}
+
+static bool fileExists(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return in.is_open();
+}
+
+static int runExport(const ExportOptions& opts)
+{
+    const std::string outputPath   = opts.outputDir + "/" + OUTPUT_FILE;
+    const std::string snapshotPath = opts.outputDir + "/" + SNAPSHOT_FILE;
+
+    // Stage timings go to <outputDir>/metrics.jsonl (see gcs/Metrics.h)
+    gcs::StageMetrics metrics;
+
     Json::Value root(Json::objectValue);
     root["schemaVersion"] = 1;
     root["source"] = "gcs-export";
@@ -20,12 +182,14 @@ int main()
     // -------------------------------------------------------------
     // Initialize FPP settings (REQUIRED for getSetting / locale)
     // -------------------------------------------------------------
+    metrics.start("load_settings");
     try {
-        LoadSettings("/home/fpp/media");
+        LoadSettings(FPP_MEDIA_DIR);
     } catch (...) {
         // LoadSettings should not throw, but we never allow exporter to crash
-        std::cerr << "WARN: LoadSettings threw unexpectedly\n";
+        gcs::LogLine(gcs::LogLevel::Warn) << "LoadSettings threw unexpectedly";
     }
+    metrics.stop("load_settings");
 
     // -------------------------------------------------------------
     // Read canonical settings
@@ -41,16 +205,69 @@ int main()
     root["longitude"] = lon;
     root["timezone"]  = tz;
 
+    // All local-time math below (sun table) uses the FPP timezone
+    if (!tz.empty()) {
+        setenv("TZ", tz.c_str(), 1);
+        tzset();
+    }
+
+    const int year = currentLocalYear();
+
     // -------------------------------------------------------------
     // Locale data (best-effort)
     // -------------------------------------------------------------
+    metrics.start("locale");
+    Json::Value locale = Json::nullValue;
     try {
-        Json::Value locale = LocaleHolder::GetLocale();
-        root["rawLocale"] = locale;
+        locale = LocaleHolder::GetLocale();
     } catch (...) {
         // Locale failure must never abort export
-        std::cerr << "WARN: Unable to load FPP locale\n";
-        root["rawLocale"] = Json::nullValue;
+        gcs::LogLine(gcs::LogLevel::Warn) << "Unable to load FPP locale";
+        locale = Json::nullValue;
+    }
+    metrics.stop("locale");
+
+    // -------------------------------------------------------------
+    // Media target index (one directory walk per export)
+    // -------------------------------------------------------------
+    metrics.start("targets");
+    const Json::Value targetIndex = gcs::buildTargetIndex(FPP_PLAYLIST_DIR, FPP_SEQUENCE_DIR);
+    metrics.stop("targets");
+
+    // -------------------------------------------------------------
+    // Skip the rewrite when nothing changed (no SD-card write,
+    // mtime stays stable for PHP-side caches)
+    // -------------------------------------------------------------
+    metrics.start("digest");
+    const std::string digest = computeEnvDigest(lat, lon, tz, locale, targetIndex, opts, year);
+    const bool unchanged = !opts.force &&
+        fileExists(snapshotPath) &&
+        readExistingDigest(outputPath) == digest;
+    metrics.stop("digest");
+
+    metrics.set("unchanged", unchanged);
+    if (unchanged) {
+        metrics.append(opts.outputDir, "export");
+        return 0;
+    }
+
+    metrics.start("tables");
+
+    root["envDigest"] = digest;
+    root["rawLocale"] = locale;
+    root["targetIndex"] = targetIndex;
+
+    if (locale.isObject()) {
+        // Resolved dates start one year back so schedules that began
+        // last year (and guard-year lookahead) stay inside the table
+        const int startYear = year - 1;
+        Json::Value holidayDates(Json::objectValue);
+        holidayDates["startYear"] = startYear;
+        holidayDates["years"] = opts.holidayYears;
+        holidayDates["dates"] = gcs::buildHolidayDates(locale, startYear, opts.holidayYears);
+        root["holidayDates"] = holidayDates;
+    } else {
+        root["holidayDates"] = Json::nullValue;
     }
 
     // -------------------------------------------------------------
@@ -62,29 +279,1009 @@ int main()
     if (lat == 0.0 || lon == 0.0) {
         ok = false;
         errors.append("Latitude/Longitude not present or zero");
-        std::cerr << "WARN: Latitude/Longitude not present (or zero)\n";
+        gcs::LogLine(gcs::LogLevel::Warn) << "Latitude/Longitude not present (or zero)";
     }
 
     if (tz.empty()) {
         ok = false;
         errors.append("Timezone not present");
-        std::cerr << "WARN: Timezone not present\n";
+        gcs::LogLine(gcs::LogLevel::Warn) << "Timezone not present";
+    }
+
+    // -------------------------------------------------------------
+    // Sun table (only meaningful with real coordinates)
+    // -------------------------------------------------------------
+    if (lat != 0.0 && lon != 0.0) {
+        root["sunTable"] = gcs::buildSunTable(
+            lat, lon, tz, year, opts.sunYears
+        );
+    } else {
+        root["sunTable"] = Json::nullValue;
     }
 
     root["ok"] = ok;
     root["errors"] = errors;
+    metrics.stop("tables");
 
     // -------------------------------------------------------------
-    // Write output atomically
+    // Write output atomically (temp + fsync + rename + dir fsync).
+    // The snapshot goes first: the JSON digest is what marks the
+    // pair as current, so a crash in between forces a re-export.
     // -------------------------------------------------------------
-    std::ofstream out(OUTPUT_PATH, std::ios::out | std::ios::trunc);
-    if (!out.is_open()) {
-        std::cerr << "ERROR: Unable to write " << OUTPUT_PATH << "\n";
+    metrics.start("write");
+    if (!gcs::writeFileAtomic(snapshotPath, gcs::buildEnvSnapshot(root))) {
+        gcs::LogLine(gcs::LogLevel::Error) << "Unable to write " << snapshotPath;
         return 2;
     }
 
-    out << root.toStyledString();
-    out.close();
+    if (!gcs::writeFileAtomic(outputPath, root.toStyledString())) {
+        gcs::LogLine(gcs::LogLevel::Error) << "Unable to write " << outputPath;
+        return 2;
+    }
+    metrics.stop("write");
 
+    metrics.append(opts.outputDir, "export");
     return 0; // exporter should never fail hard
-}
\ No newline at end of file
+}
+
+// -----------------------------------------------------------------
+// Streaming event output shared by parse-ics and fetch-ics --parse.
+//
+// Events are written to stdout as the parser accepts them, so the
+// process never holds the whole event array:
+//   {"events": [...], <trailer fields>}
+// or, with --format=bin, EVENT records closed by one META record
+// (see gcs/RecordStream.h).
+// -----------------------------------------------------------------
+struct IcsParseOptions {
+    std::string tz;             // FPP zone (PHP date_default_timezone_get())
+    time_t now = 0;
+    bool hasNow = false;
+    time_t horizonEnd = 0;
+    bool hasHorizon = false;
+    bool binary = false;        // --format=bin
+};
+
+/** Consume --tz= / --now= / --horizon-end= / --format=; false if argv[i] is not one */
+static bool parseIcsOption(const char* arg, IcsParseOptions& o)
+{
+    if (std::strcmp(arg, "--format=bin") == 0) {
+        o.binary = true;
+    } else if (std::strcmp(arg, "--format=json") == 0) {
+        o.binary = false;
+    } else if (std::strncmp(arg, "--tz=", 5) == 0) {
+        o.tz = arg + 5;
+    } else if (std::strncmp(arg, "--now=", 6) == 0) {
+        o.now = static_cast<time_t>(std::atoll(arg + 6));
+        o.hasNow = true;
+    } else if (std::strncmp(arg, "--horizon-end=", 14) == 0) {
+        o.horizonEnd = static_cast<time_t>(std::atoll(arg + 14));
+        o.hasHorizon = true;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+class IcsEventStream {
+public:
+    /** header: write the record stream header (binary, single calendar) */
+    IcsEventStream(bool binary, bool header) : binary_(binary), records_(std::cout)
+    {
+        wb_["indentation"] = "";
+        wb_["emitUTF8"] = true;
+
+        if (binary_ && header) {
+            records_.header(gcs::RECORD_KIND_CALENDARS);
+        }
+    }
+
+    void attach(gcs::IcsPushParser& parser)
+    {
+        if (binary_) {
+            parser.setEventSink([this](const gcs::IcsEvent& ev) { records_.event(ev); });
+            return;
+        }
+
+        std::cout << "{\"events\":[";
+        parser.setEventSink([this](const gcs::IcsEvent& ev) {
+            if (count_++ > 0) {
+                std::cout << ',';
+            }
+            std::cout << Json::writeString(wb_, gcs::icsEventToJson(ev));
+        });
+    }
+
+    /** Close the array and append the remaining top-level fields */
+    void close(const gcs::IcsPushParser& parser, Json::Value trailer)
+    {
+        trailer["ok"] = true;
+        trailer["calendarTz"] = parser.calendarTz();
+        trailer["calendarTzDefaulted"] = parser.calendarTzDefaulted();
+        trailer["droppedBeyondHorizon"] = Json::UInt64(parser.droppedBeyondHorizon());
+        trailer["droppedExpired"] = Json::UInt64(parser.droppedExpired());
+
+        if (binary_) {
+            records_.meta(trailer);
+            records_.flush();
+            return;
+        }
+
+        // "{...}" -> ",..." after the array
+        const std::string t = Json::writeString(wb_, trailer);
+        std::cout << "]," << t.substr(1) << "\n";
+        std::cout.flush();
+    }
+
+private:
+    bool binary_;
+    gcs::RecordWriter records_;
+    Json::StreamWriterBuilder wb_;
+    size_t count_ = 0;
+};
+
+static void configureParser(gcs::IcsPushParser& parser, const IcsParseOptions& o)
+{
+    if (o.hasHorizon) {
+        parser.setHorizonEnd(o.horizonEnd);
+    }
+}
+
+// -----------------------------------------------------------------
+// parse-ics <file> [--tz=ZONE] [--now=EPOCH] [--horizon-end=EPOCH]
+//           [--format=json|bin]
+//
+// Native IcsParser::parse(): prints {"ok", "calendarTz",
+// "calendarTzDefaulted", "droppedBeyondHorizon", "droppedExpired",
+// "events"} as compact JSON on stdout, or one calendar as a record
+// stream. --now also prunes finished series (gcs/IcsParse.h).
+// -----------------------------------------------------------------
+static int runParseIcs(int argc, char** argv)
+{
+    std::string path;
+    IcsParseOptions po;
+
+    for (int i = 2; i < argc; i++) {
+        if (!parseIcsOption(argv[i], po) && path.empty()) {
+            path = argv[i];
+        }
+    }
+
+    gcs::MappedFile file;
+    if (path.empty() || !file.open(path)) {
+        gcs::LogLine(gcs::LogLevel::Error) << "Unable to read ICS file " << path;
+        return 2;
+    }
+
+    gcs::ZoneClock clock(po.tz);
+    gcs::IcsPushParser parser(clock, po.now, po.hasNow);
+    configureParser(parser, po);
+
+    IcsEventStream out(po.binary, true);
+    out.attach(parser);
+    parser.feed(file.data(), file.size());
+    parser.finish();
+    out.close(parser, Json::Value(Json::objectValue));
+
+    return 0;
+}
+
+// -----------------------------------------------------------------
+// fetch-ics <url> [<url> ...] | -   [--cache-dir=DIR] [--timeout=SECONDS]
+//           [--jobs=N]
+//           [--parse [--tz=ZONE] [--now=EPOCH] [--horizon-end=EPOCH]
+//                    [--format=json|bin]]
+//
+// Conditional download into the ICS cache (see gcs/IcsFetch.h). With
+// "-" the URLs are read from stdin as {"urls": [...]}: calendar URLs
+// carry their access token, and argv is visible to every local user
+// (NativeEngine always uses this form). One
+// URL prints a single calendar object:
+//   {"ok", "url", "status": "fetched" | "not_modified", "path",
+//    "bytes", "wireBytes", "etag", "lastModified", "digest"}
+// Several URLs are fetched (and parsed) concurrently in forked workers,
+// at most --jobs at a time, and print
+//   {"ok", "calendars": [<calendar object> | {"url", "ok": false}]}
+// in argument order. The cache dir defaults to the plugin runtime dir.
+//
+// --parse also runs the parse-ics parser and adds its fields. With
+// --format=bin the output is one record stream instead: per calendar,
+// its EVENT records and a META record with the other fields. A
+// downloaded body is parsed while it streams in (no in-memory copy);
+// on not_modified the cached body is mapped and parsed instead. A
+// failure after output has started exits non-zero; callers must
+// discard stdout in that case.
+// -----------------------------------------------------------------
+static const size_t MAX_PARALLEL_FETCHES = 8;
+
+struct FetchOptions {
+    std::string cacheDir = DEFAULT_OUTPUT_DIR;
+    long timeout = 10;
+    bool parse = false;
+    IcsParseOptions po;
+    bool worker = false;    // forked per-calendar job (no stream header)
+};
+
+static int fetchOneCalendar(const std::string& url, const FetchOptions& fo)
+{
+    gcs::ZoneClock clock(fo.po.tz);
+    gcs::IcsPushParser parser(clock, fo.po.now, fo.po.hasNow);
+    configureParser(parser, fo.po);
+
+    IcsEventStream stream(fo.parse && fo.po.binary, !fo.worker);
+    if (fo.parse) {
+        stream.attach(parser);
+    }
+
+    gcs::IcsHttpClient client(fo.timeout);
+    const gcs::FetchResult r = gcs::fetchIcsCached(client, url, fo.cacheDir,
+        [&](const char* p, size_t n) {
+            if (fo.parse) {
+                parser.feed(p, n);
+            }
+            return true;
+        });
+
+    if (r.status == gcs::FetchStatus::Failed) {
+        gcs::LogLine(gcs::LogLevel::Error) << "ICS fetch failed (" << gcs::redactIcsUrl(url) << "): " << r.error;
+        return 1;
+    }
+
+    const std::string bodyPath = gcs::icsCacheBase(fo.cacheDir, url) + ".ics";
+
+    if (fo.parse && r.status == gcs::FetchStatus::NotModified) {
+        gcs::MappedFile file;
+        if (!file.open(bodyPath)) {
+            gcs::LogLine(gcs::LogLevel::Error) << "Unable to read ICS cache " << bodyPath;
+            return 1;
+        }
+        parser.feed(file.data(), file.size());
+    }
+
+    Json::Value out(Json::objectValue);
+    out["ok"] = true;
+    out["url"] = url;
+    out["status"] = (r.status == gcs::FetchStatus::NotModified) ? "not_modified" : "fetched";
+    out["path"] = bodyPath;
+    out["bytes"] = Json::Int64(r.bytes);
+    out["wireBytes"] = Json::Int64(r.wireBytes);
+    out["etag"] = r.etag;
+    out["lastModified"] = r.lastModified;
+    out["digest"] = r.digest;
+
+    if (fo.parse) {
+        parser.finish();
+        stream.close(parser, out);
+        return 0;
+    }
+
+    Json::StreamWriterBuilder wb;
+    wb["indentation"] = "";
+    std::cout << Json::writeString(wb, out) << "\n";
+
+    return 0;
+}
+
+static int fetchCalendarsParallel(const std::vector<std::string>& urls, const FetchOptions& fo, size_t jobs)
+{
+    std::vector<std::string> outPaths;
+    for (size_t i = 0; i < urls.size(); i++) {
+        outPaths.push_back(fo.cacheDir + "/.fetch-" + std::to_string(::getpid()) + "-" + std::to_string(i) + ".json");
+    }
+
+    FetchOptions workerOpts = fo;
+    workerOpts.worker = true;
+
+    const std::vector<int> status = gcs::runForkedJobs(outPaths, jobs,
+        [&](size_t i) { return fetchOneCalendar(urls[i], workerOpts); });
+
+    if (fo.parse && fo.po.binary) {
+        gcs::RecordWriter records(std::cout);
+        records.header(gcs::RECORD_KIND_CALENDARS);
+
+        for (size_t i = 0; i < urls.size(); i++) {
+            gcs::MappedFile file;
+            if (status[i] == 0 && file.open(outPaths[i]) && file.size() > 0) {
+                std::cout.write(file.data(), static_cast<std::streamsize>(file.size()));
+            } else {
+                Json::Value failed(Json::objectValue);
+                failed["ok"] = false;
+                failed["url"] = urls[i];
+                records.meta(failed);
+            }
+            ::unlink(outPaths[i].c_str());
+        }
+        records.flush();
+        return 0;
+    }
+
+    Json::StreamWriterBuilder wb;
+    wb["indentation"] = "";
+
+    std::cout << "{\"ok\":true,\"calendars\":[";
+    for (size_t i = 0; i < urls.size(); i++) {
+        if (i > 0) {
+            std::cout << ',';
+        }
+
+        gcs::MappedFile file;
+        if (status[i] == 0 && file.open(outPaths[i]) && file.size() > 0) {
+            size_t n = file.size();
+            while (n > 0 && file.data()[n - 1] == '\n') n--;
+            std::cout.write(file.data(), static_cast<std::streamsize>(n));
+        } else {
+            Json::Value failed(Json::objectValue);
+            failed["ok"] = false;
+            failed["url"] = urls[i];
+            std::cout << Json::writeString(wb, failed);
+        }
+
+        ::unlink(outPaths[i].c_str());
+    }
+    std::cout << "]}\n";
+
+    return 0;
+}
+
+static int runFetchIcs(int argc, char** argv)
+{
+    std::vector<std::string> urls;
+    FetchOptions fo;
+    size_t jobs = MAX_PARALLEL_FETCHES;
+    bool urlsFromStdin = false;
+
+    for (int i = 2; i < argc; i++) {
+        if (std::strncmp(argv[i], "--cache-dir=", 12) == 0) {
+            fo.cacheDir = argv[i] + 12;
+        } else if (std::strncmp(argv[i], "--timeout=", 10) == 0) {
+            fo.timeout = std::max(1L, std::atol(argv[i] + 10));
+        } else if (std::strncmp(argv[i], "--jobs=", 7) == 0) {
+            jobs = static_cast<size_t>(std::max(1L, std::atol(argv[i] + 7)));
+        } else if (std::strcmp(argv[i], "--parse") == 0) {
+            fo.parse = true;
+        } else if (std::strcmp(argv[i], "-") == 0) {
+            urlsFromStdin = true;
+        } else if (!parseIcsOption(argv[i], fo.po) && argv[i][0] != '-') {
+            urls.push_back(argv[i]);
+        }
+    }
+
+    if (urlsFromStdin) {
+        Json::Value req;
+        Json::CharReaderBuilder rb;
+        std::string errs;
+        if (!Json::parseFromStream(rb, std::cin, &req, &errs) || !req.isObject() || !req["urls"].isArray()) {
+            gcs::LogLine(gcs::LogLevel::Error) << "Invalid fetch-ics request: " << errs;
+            return 2;
+        }
+        for (const Json::Value& url : req["urls"]) {
+            if (url.isString() && !url.asString().empty()) {
+                urls.push_back(url.asString());
+            }
+        }
+    }
+
+    if (urls.empty()) {
+        std::cerr << "Usage: gcs-export fetch-ics <url> [<url> ...] | - [--cache-dir=DIR] [--timeout=SECONDS] [--jobs=N] [--parse ...]\n";
+        return 2;
+    }
+
+    if (urls.size() == 1) {
+        return fetchOneCalendar(urls[0], fo);
+    }
+
+    return fetchCalendarsParallel(urls, fo, jobs);
+}
+
+// -----------------------------------------------------------------
+// expand [--tz=ZONE] [--format=json|bin]   (request JSON on stdin)
+//
+// Bulk occurrence expansion for SchedulerRunner:
+//   in : {"horizonStart", "horizonEnd", "series": [{"start", "end",
+//         "rrule", "exDates", "overrides": [{"rid", "start", "end"}]}]}
+//   out: {"ok", "series": [[{"start", "end", "isOverride"}] | null]}
+//        or one SERIES record per series (gcs/RecordStream.h)
+// null marks a series the caller must expand in PHP.
+// -----------------------------------------------------------------
+static int runExpand(int argc, char** argv)
+{
+    std::string tz;
+    bool binary = false;
+    for (int i = 2; i < argc; i++) {
+        if (std::strncmp(argv[i], "--tz=", 5) == 0) {
+            tz = argv[i] + 5;
+        } else if (std::strcmp(argv[i], "--format=bin") == 0) {
+            binary = true;
+        }
+    }
+
+    Json::Value req;
+    Json::CharReaderBuilder rb;
+    std::string errs;
+    if (!Json::parseFromStream(rb, std::cin, &req, &errs) || !req.isObject()) {
+        gcs::LogLine(gcs::LogLevel::Error) << "Invalid expand request: " << errs;
+        return 2;
+    }
+
+    gcs::WallSeconds horizonStart = 0, horizonEnd = 0;
+    if (!gcs::parseWall(req["horizonStart"].asString(), horizonStart) ||
+        !gcs::parseWall(req["horizonEnd"].asString(), horizonEnd)) {
+        gcs::LogLine(gcs::LogLevel::Error) << "Invalid expand horizon";
+        return 2;
+    }
+
+    gcs::ZoneClock clock(tz);
+    std::vector<gcs::Occurrence> occs;
+
+    if (binary) {
+        gcs::RecordWriter records(std::cout);
+        records.header(gcs::RECORD_KIND_SERIES);
+
+        for (const Json::Value& item : req["series"]) {
+            const gcs::SeriesInput in = gcs::seriesFromJson(item);
+            const bool ok = gcs::expandSeries(in, horizonStart, horizonEnd, clock, occs);
+            records.series(ok ? &occs : nullptr);
+        }
+        records.flush();
+        return 0;
+    }
+
+    Json::Value series(Json::arrayValue);
+    for (const Json::Value& item : req["series"]) {
+        const gcs::SeriesInput in = gcs::seriesFromJson(item);
+
+        if (!gcs::expandSeries(in, horizonStart, horizonEnd, clock, occs)) {
+            series.append(Json::nullValue);
+            continue;
+        }
+
+        Json::Value list(Json::arrayValue);
+        for (const gcs::Occurrence& o : occs) {
+            Json::Value occ(Json::objectValue);
+            occ["start"] = gcs::formatWall(o.start);
+            occ["end"] = gcs::formatWall(o.end);
+            occ["isOverride"] = o.isOverride;
+            list.append(occ);
+        }
+        series.append(list);
+    }
+
+    Json::Value out(Json::objectValue);
+    out["ok"] = true;
+    out["series"] = series;
+
+    Json::StreamWriterBuilder wb;
+    wb["indentation"] = "";
+    std::cout << Json::writeString(wb, out) << "\n";
+
+    return 0;
+}
+
+// -----------------------------------------------------------------
+// order   (request JSON on stdin)
+//
+// SchedulerPlanner dominance ordering on the baseline-sorted bundles:
+//   in : {"maxPasses", "bundles": [{"start", "end", "dayMask",
+//         "startTime", "endTime"}]}
+//   out: {"ok", "order": [input index, ...], "passes", "swaps"}
+// Exit 3 when the input holds a mutually dominating pair.
+// -----------------------------------------------------------------
+static int runOrder()
+{
+    Json::Value req;
+    Json::CharReaderBuilder rb;
+    std::string errs;
+    if (!Json::parseFromStream(rb, std::cin, &req, &errs) || !req.isObject()) {
+        gcs::LogLine(gcs::LogLevel::Error) << "Invalid order request: " << errs;
+        return 2;
+    }
+
+    const Json::Value& items = req["bundles"];
+    std::vector<gcs::PackedBundle> bundles;
+    bundles.reserve(items.size());
+
+    for (const Json::Value& item : items) {
+        gcs::PackedBundle b;
+        if (!gcs::packBundle(item, b)) {
+            gcs::LogLine(gcs::LogLevel::Error) << "Invalid bundle in order request";
+            return 2;
+        }
+        bundles.push_back(b);
+    }
+
+    const gcs::OrderResult r =
+        gcs::relaxBundleOrder(bundles, req.get("maxPasses", 50).asInt());
+
+    if (!r.ok) {
+        gcs::LogLine(gcs::LogLevel::Error) << "Mutually dominating bundles; order not computed";
+        return 3;
+    }
+
+    Json::Value order(Json::arrayValue);
+    for (int idx : r.order) {
+        order.append(idx);
+    }
+
+    Json::Value out(Json::objectValue);
+    out["ok"] = true;
+    out["order"] = order;
+    out["passes"] = r.passes;
+    out["swaps"] = r.swaps;
+
+    Json::StreamWriterBuilder wb;
+    wb["indentation"] = "";
+    std::cout << Json::writeString(wb, out) << "\n";
+
+    return 0;
+}
+
+// -----------------------------------------------------------------
+// apply-schedule   (request JSON on stdin)
+//
+// Minimal-rewrite schedule.json update for SchedulerApply (see
+// gcs/SchedulePatch.h):
+//   in : {"path", "expectDigest", "backupStamp", "keepBackups",
+//         "entries": [{"keep": existing index} | {"json": entry text}]}
+//   out: {"ok", "bytes", "kept", "written", "backup", "unchanged"}
+// "json" is json_encode(JSON_PRETTY_PRINT) of one entry. The delta
+// backup is written and the old file is hard-linked to <path>.prev
+// (no copy) before schedule.json is replaced; an unchanged file is
+// left alone. Exit 3 when schedule.json is missing, invalid, or its
+// bytes no longer hash (fnv1a64) to expectDigest, i.e. it was edited
+// after the plan was made (the caller then uses its own path).
+// -----------------------------------------------------------------
+static int runApplySchedule()
+{
+    Json::Value req;
+    Json::CharReaderBuilder rb;
+    std::string errs;
+    if (!Json::parseFromStream(rb, std::cin, &req, &errs) || !req.isObject() ||
+        !req["path"].isString() || !req["entries"].isArray()) {
+        gcs::LogLine(gcs::LogLevel::Error) << "Invalid apply-schedule request: " << errs;
+        return 2;
+    }
+
+    const std::string path = req["path"].asString();
+
+    std::vector<gcs::SchedulePatchOp> ops;
+    ops.reserve(req["entries"].size());
+    for (const Json::Value& e : req["entries"]) {
+        gcs::SchedulePatchOp op;
+        if (e.isMember("keep") && e["keep"].isInt()) {
+            op.keep = e["keep"].asInt();
+        } else if (e["json"].isString()) {
+            op.json = e["json"].asString();
+        } else {
+            gcs::LogLine(gcs::LogLevel::Error) << "Invalid apply-schedule entry";
+            return 2;
+        }
+        ops.push_back(op);
+    }
+
+    gcs::SchedulePatch patch;
+    if (!patch.load(path, errs)) {
+        gcs::LogLine(gcs::LogLevel::Error) << errs;
+        return 3;
+    }
+    const std::string digest = gcs::Fnv1a64().update(patch.data(), patch.size()).hex();
+    if (digest != req.get("expectDigest", "").asString()) {
+        gcs::LogLine(gcs::LogLevel::Error) << "schedule.json changed since it was planned";
+        return 3;
+    }
+
+    std::string built;
+    if (!patch.build(ops, built, errs)) {
+        gcs::LogLine(gcs::LogLevel::Error) << errs;
+        return 2;
+    }
+
+    size_t kept = 0;
+    for (const gcs::SchedulePatchOp& op : ops) {
+        kept += (op.keep >= 0) ? 1 : 0;
+    }
+
+    Json::StreamWriterBuilder wb;
+    wb["indentation"] = "";
+
+    Json::Value out(Json::objectValue);
+    out["ok"] = true;
+    out["bytes"] = Json::UInt64(built.size());
+    out["kept"] = Json::UInt64(kept);
+    out["written"] = Json::UInt64(ops.size() - kept);
+    out["backup"] = "";
+    out["unchanged"] = (built.size() == patch.size() &&
+        std::memcmp(built.data(), patch.data(), built.size()) == 0);
+
+    if (out["unchanged"].asBool()) {
+        std::cout << Json::writeString(wb, out) << "\n";
+        return 0;
+    }
+
+    // A fresh name per apply; same-second applies get a suffix
+    std::string backup = path + ".delta-" + req.get("backupStamp", "").asString();
+    for (int n = 1; fileExists(backup); n++) {
+        backup = path + ".delta-" + req.get("backupStamp", "").asString() + "-" + std::to_string(n);
+    }
+
+    if (!gcs::writeFileAtomic(backup, Json::writeString(wb, patch.deltaFrom(built)) + "\n")) {
+        gcs::LogLine(gcs::LogLevel::Error) << "Unable to write backup " << backup;
+        return 1;
+    }
+
+    // The delta alone is lost to any edit made outside the plugin. The
+    // old inode is kept as <path>.prev by a hard link: the rename below
+    // gives schedule.json a new inode, so nothing is rewritten on flash
+    const std::string full = gcs::scheduleFullBackupPath(path);
+    const std::string fullTmp = full + ".tmp." + std::to_string(::getpid());
+    ::unlink(fullTmp.c_str());
+    if (::link(path.c_str(), fullTmp.c_str()) != 0 || ::rename(fullTmp.c_str(), full.c_str()) != 0) {
+        ::unlink(fullTmp.c_str());
+        ::unlink(backup.c_str());
+        gcs::LogLine(gcs::LogLevel::Error) << "Unable to link backup " << full << ": " << std::strerror(errno);
+        return 1;
+    }
+
+    gcs::AtomicFileWriter w(path);
+    w.copyModeFrom(path);
+    if (!w.write(built.data(), built.size()) || !w.commit()) {
+        ::unlink(backup.c_str());
+        gcs::LogLine(gcs::LogLevel::Error) << "Unable to replace " << path;
+        return 1;
+    }
+
+    gcs::rotateScheduleDeltas(path, static_cast<size_t>(std::max(1, req.get("keepBackups", 10).asInt())));
+
+    out["backup"] = backup;
+    std::cout << Json::writeString(wb, out) << "\n";
+    return 0;
+}
+
+// -----------------------------------------------------------------
+// restore-schedule <schedule.json> [<delta>]
+//
+// Roll schedule.json back one apply using a delta backup (default:
+// the newest). The delta is removed once it has been applied, so
+// repeated runs walk further back. When schedule.json was edited
+// since the newest apply, the newest delta no longer matches and the
+// full copy (<path>.prev) it was written with is restored instead.
+// -----------------------------------------------------------------
+static int runRestoreSchedule(int argc, char** argv)
+{
+    if (argc < 3) {
+        std::cerr << "Usage: gcs-export restore-schedule <schedule.json> [<delta>]\n";
+        return 2;
+    }
+
+    const std::string path = argv[2];
+    std::string deltaPath;
+    bool newest = false;
+    if (argc >= 4) {
+        deltaPath = argv[3];
+    } else {
+        newest = true;
+        const std::vector<std::string> deltas = gcs::listScheduleDeltas(path);
+        if (deltas.empty()) {
+            gcs::LogLine(gcs::LogLevel::Error) << "No delta backups for " << path;
+            return 1;
+        }
+        deltaPath = deltas.back();
+    }
+
+    Json::Value delta;
+    Json::CharReaderBuilder rb;
+    std::string errs;
+    std::ifstream in(deltaPath);
+    if (!in || !Json::parseFromStream(rb, in, &delta, &errs) || !delta.isObject()) {
+        gcs::LogLine(gcs::LogLevel::Error) << "Unable to read delta " << deltaPath;
+        return 1;
+    }
+
+    gcs::MappedFile cur;
+    if (!cur.open(path)) {
+        gcs::LogLine(gcs::LogLevel::Error) << "Unable to read " << path;
+        return 1;
+    }
+
+    const std::string fullPath = gcs::scheduleFullBackupPath(path);
+    bool fromFull = false;
+
+    std::string prev;
+    if (!gcs::restoreFromDelta(cur.data(), cur.size(), delta, prev, errs)) {
+        gcs::MappedFile full;
+        if (!newest || !full.open(fullPath) ||
+            gcs::Fnv1a64().update(full.data(), full.size()).hex() != delta.get("prev", "").asString()) {
+            gcs::LogLine(gcs::LogLevel::Error) << errs;
+            return 3;
+        }
+        prev.assign(full.data(), full.size());
+        fromFull = true;
+    }
+
+    gcs::AtomicFileWriter w(path);
+    w.copyModeFrom(path);
+    if (!w.write(prev.data(), prev.size()) || !w.commit()) {
+        gcs::LogLine(gcs::LogLevel::Error) << "Unable to replace " << path;
+        return 1;
+    }
+    ::unlink(deltaPath.c_str());
+    if (newest) {
+        ::unlink(fullPath.c_str());     // describes the delta just consumed
+    }
+
+    Json::Value out(Json::objectValue);
+    out["ok"] = true;
+    out["path"] = path;
+    out["delta"] = deltaPath;
+    out["full"] = fromFull;
+    out["bytes"] = Json::UInt64(prev.size());
+
+    Json::StreamWriterBuilder wb;
+    wb["indentation"] = "";
+    std::cout << Json::writeString(wb, out) << "\n";
+    return 0;
+}
+
+// -----------------------------------------------------------------
+// export-ics [<entries.json>|-] [--out=FILE|-] [--env-dir=DIR] [--tz=ZONE]
+//
+// Native ExportService (see gcs/IcsExport.h): a JSON array of
+// schedule.json entries in (default stdin), an RFC5545 calendar out.
+// Events are written as they are adapted. With --out=FILE the file is
+// replaced atomically and a summary is printed:
+//   {"ok", "events", "skipped", "bytes", "path", "warnings": [...]}
+// Without it the calendar goes to stdout and warnings to the log.
+// The zone is --tz, else the exported FPP zone, else UTC.
+// -----------------------------------------------------------------
+static int runExportIcs(int argc, char** argv)
+{
+    std::string inPath = "-";
+    std::string outPath = "-";
+    std::string envDir = DEFAULT_OUTPUT_DIR;
+    std::string tz;
+    for (int i = 2; i < argc; i++) {
+        if (std::strncmp(argv[i], "--out=", 6) == 0 && argv[i][6] != '\0') {
+            outPath = argv[i] + 6;
+        } else if (std::strncmp(argv[i], "--env-dir=", 10) == 0 && argv[i][10] != '\0') {
+            envDir = argv[i] + 10;
+        } else if (std::strncmp(argv[i], "--tz=", 5) == 0) {
+            tz = argv[i] + 5;
+        } else if (argv[i][0] != '-' || std::strcmp(argv[i], "-") == 0) {
+            inPath = argv[i];
+        }
+    }
+
+    Json::Value entries;
+    Json::CharReaderBuilder rb;
+    std::string errs;
+    bool parsed = false;
+    if (inPath == "-") {
+        parsed = Json::parseFromStream(rb, std::cin, &entries, &errs);
+    } else {
+        std::ifstream in(inPath);
+        parsed = in && Json::parseFromStream(rb, in, &entries, &errs);
+    }
+    if (!parsed || !entries.isArray()) {
+        gcs::LogLine(gcs::LogLevel::Error) << "Invalid export-ics entries: " << errs;
+        return 2;
+    }
+
+    // Missing or unreadable env: no coordinates, sun table or holidays
+    Json::Value envRoot;
+    {
+        std::ifstream in(envDir + "/" + OUTPUT_FILE);
+        if (!in || !Json::parseFromStream(rb, in, &envRoot, &errs)) {
+            envRoot = Json::Value(Json::objectValue);
+        }
+    }
+    const gcs::ExportEnv env = gcs::exportEnvFromJson(envRoot);
+
+    if (!gcs::ZoneClock::isValidZone(tz)) {
+        tz = gcs::ZoneClock::isValidZone(env.timezone) ? env.timezone : "UTC";
+    }
+
+    const bool toFile = (outPath != "-");
+    std::unique_ptr<gcs::AtomicFileWriter> file;
+    if (toFile) {
+        file.reset(new gcs::AtomicFileWriter(outPath));
+        if (!file->isOpen()) {
+            gcs::LogLine(gcs::LogLevel::Error) << "Unable to write " << outPath;
+            return 1;
+        }
+    }
+
+    gcs::IcsLineWriter lines([&](const char* p, size_t n) {
+        if (toFile) {
+            return file->write(p, n);
+        }
+        std::cout.write(p, static_cast<std::streamsize>(n));
+        return static_cast<bool>(std::cout);
+    });
+
+    const time_t now = std::time(nullptr);
+    gcs::ZoneClock clock(tz);
+    gcs::ScheduleEntryExporter exporter(clock, env, now);
+    gcs::IcsCalendarWriter cal(lines, clock, now);
+
+    std::vector<std::string> warnings;
+    unsigned long long events = 0;
+    unsigned long long skipped = 0;
+
+    cal.begin();
+    gcs::ExportEvent ev;
+    for (const Json::Value& entry : entries) {
+        if (!entry.isObject() || !exporter.adapt(entry, ev, warnings)) {
+            skipped++;
+            continue;
+        }
+        cal.event(ev);
+        events++;
+    }
+    cal.end();
+
+    if (!lines.flush() || (toFile && !file->commit())) {
+        gcs::LogLine(gcs::LogLevel::Error) << "Unable to write " << (toFile ? outPath : "ICS output");
+        return 1;
+    }
+
+    if (!toFile) {
+        std::cout.flush();
+        if (!warnings.empty()) {
+            gcs::LogLine(gcs::LogLevel::Warn) << "export-ics: " << warnings.size() << " warning(s)";
+        }
+        return 0;
+    }
+
+    Json::Value w(Json::arrayValue);
+    for (const std::string& s : warnings) {
+        w.append(s);
+    }
+
+    Json::Value out(Json::objectValue);
+    out["ok"] = true;
+    out["events"] = Json::UInt64(events);
+    out["skipped"] = Json::UInt64(skipped);
+    out["bytes"] = Json::UInt64(lines.bytes());
+    out["path"] = outPath;
+    out["warnings"] = w;
+
+    Json::StreamWriterBuilder wb;
+    wb["indentation"] = "";
+    std::cout << Json::writeString(wb, out) << "\n";
+    return 0;
+}
+
+// -----------------------------------------------------------------
+// Auto-sync timer (--watch)
+//
+// Every runtime.auto_sync_interval seconds the watcher starts
+// "php gcs-worker.php --auto-sync" fully detached (double fork, own
+// session) and returns at once; the worker does the conditional
+// fetch, change detection and apply (src/Apply/AutoSync.php). The
+// config is re-read on each cycle, so enabling or retuning the
+// interval needs no daemon restart.
+// -----------------------------------------------------------------
+static int readAutoSyncInterval()
+{
+    std::ifstream in(PLUGIN_CONFIG_FILE);
+    Json::Value cfg;
+    Json::CharReaderBuilder rb;
+    std::string errs;
+    if (!in || !Json::parseFromStream(rb, in, &cfg, &errs) || !cfg.isObject()) {
+        return 0;
+    }
+
+    const Json::Value& v = cfg["runtime"]["auto_sync_interval"];
+    const int interval = v.isNumeric() ? v.asInt() : 0;
+    return interval <= 0 ? 0 : std::max(AUTO_SYNC_MIN_SECONDS, interval);
+}
+
+static std::string workerScriptPath()
+{
+    char exe[4096];
+    const ssize_t n = ::readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    if (n <= 0) {
+        return "";
+    }
+    std::string dir(exe, static_cast<size_t>(n));
+    const size_t slash = dir.rfind('/');
+    return (slash == std::string::npos) ? "" : dir.substr(0, slash + 1) + WORKER_SCRIPT;
+}
+
+static void spawnAutoSyncWorker(const std::string& script)
+{
+    gcs::flushLog();
+
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        gcs::LogLine(gcs::LogLevel::Warn) << "auto-sync: fork failed: " << std::strerror(errno);
+        return;
+    }
+
+    if (pid == 0) {
+        // Intermediate child: the grandchild is reparented to init, so
+        // the watcher never waits on a long sync
+        ::setsid();
+        if (::fork() != 0) {
+            ::_exit(0);
+        }
+
+        const int devnull = ::open("/dev/null", O_RDWR);
+        if (devnull >= 0) {
+            ::dup2(devnull, STDIN_FILENO);
+            ::dup2(devnull, STDOUT_FILENO);
+            ::dup2(devnull, STDERR_FILENO);
+        }
+        ::execlp("php", "php", script.c_str(), "--auto-sync", static_cast<char*>(nullptr));
+        ::_exit(127);
+    }
+
+    int status = 0;
+    while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+}
+
+/** Watcher periodic task: seconds until the next check */
+static int autoSyncTick(const std::string& script)
+{
+    const int interval = readAutoSyncInterval();
+    if (interval == 0 || script.empty()) {
+        return AUTO_SYNC_RECHECK_SECONDS;
+    }
+
+    spawnAutoSyncWorker(script);
+    return interval;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc >= 2 && std::strcmp(argv[1], "parse-ics") == 0) {
+        return runParseIcs(argc, argv);
+    }
+
+    if (argc >= 2 && std::strcmp(argv[1], "fetch-ics") == 0) {
+        return runFetchIcs(argc, argv);
+    }
+
+    if (argc >= 2 && std::strcmp(argv[1], "expand") == 0) {
+        return runExpand(argc, argv);
+    }
+
+    if (argc >= 2 && std::strcmp(argv[1], "order") == 0) {
+        return runOrder();
+    }
+
+    if (argc >= 2 && std::strcmp(argv[1], "apply-schedule") == 0) {
+        return runApplySchedule();
+    }
+
+    if (argc >= 2 && std::strcmp(argv[1], "restore-schedule") == 0) {
+        return runRestoreSchedule(argc, argv);
+    }
+
+    if (argc >= 2 && std::strcmp(argv[1], "export-ics") == 0) {
+        return runExportIcs(argc, argv);
+    }
+
+    ExportOptions opts = parseOptions(argc, argv);
+
+    if (!opts.watch) {
+        return runExport(opts);
+    }
+
+    const std::vector<gcs::WatchTarget> targets = {
+        { FPP_MEDIA_DIR, FPP_SETTINGS_FILE },
+        { FPP_LOCALE_DIR, "" },
+        { FPP_PLAYLIST_DIR, "" },
+        { FPP_SEQUENCE_DIR, "" },
+    };
+
+    const std::string workerScript = workerScriptPath();
+
+    return gcs::runExportWatcher(
+        opts.outputDir,
+        targets,
+        opts.refreshSeconds,
+        [&opts]() { return runExport(opts); },
+        [&workerScript]() { return autoSyncTick(workerScript); }
+    );
+}
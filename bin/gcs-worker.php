@@ -0,0 +1,34 @@
+<?php
+declare(strict_types=1);
+
+/**
+ * gcs-worker
+ *
+ * Background sync worker: runs the preview / apply jobs queued by the
+ * UI (see src/Apply/SyncJobs.php) and exits when the queue is empty.
+ * Started detached by SyncJobs::submit(); running it by hand is safe,
+ * since only one worker holds the queue lock at a time.
+ *
+ * With --auto-sync it first runs one AutoSync check (started that way
+ * by the gcs-export watcher every runtime.auto_sync_interval seconds).
+ *
+ * Usage: php gcs-worker.php [--auto-sync]
+ */
+
+if (PHP_SAPI !== 'cli') {
+    return;
+}
+
+require_once __DIR__ . '/../src/bootstrap.php';
+
+// Planning a large calendar may take longer than a web request would allow
+set_time_limit(0);
+ignore_user_abort(true);
+
+$autoSync = in_array('--auto-sync', $argv ?? [], true)
+    ? static function (): void {
+        AutoSync::tick(Config::load());
+    }
+    : null;
+
+SyncJobs::runWorker($autoSync);
@@ -0,0 +1,142 @@
+#pragma once
+
+// -----------------------------------------------------------------
+// AtomicFile
+//
+// Crash-safe file replacement: write to a temp file in the same
+// directory, fsync it, rename(2) over the target, then fsync the
+// directory so the rename itself is durable.
+//
+// Readers (PHP bootstrap on every page load) therefore see either the
+// previous complete file or the new complete file, never a partial one.
+// -----------------------------------------------------------------
+
+#include <cerrno>
+#include <cstdio>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace gcs {
+
+inline std::string dirnameOf(const std::string& path)
+{
+    const size_t slash = path.find_last_of('/');
+    if (slash == std::string::npos) {
+        return ".";
+    }
+    return (slash == 0) ? "/" : path.substr(0, slash);
+}
+
+inline bool fsyncDirectory(const std::string& dir)
+{
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        return false;
+    }
+    const bool ok = (::fsync(fd) == 0);
+    ::close(fd);
+    return ok;
+}
+
+/**
+ * Streaming variant of writeFileAtomic(): data is appended to the temp
+ * file as it arrives and only replaces the target on commit(). A writer
+ * destroyed without commit() removes its temp file.
+ */
+class AtomicFileWriter {
+public:
+    explicit AtomicFileWriter(const std::string& path)
+        : path_(path), tmp_(path + ".tmp." + std::to_string(::getpid()))
+    {
+        fd_ = ::open(tmp_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    }
+
+    ~AtomicFileWriter() { abort(); }
+
+    AtomicFileWriter(const AtomicFileWriter&) = delete;
+    AtomicFileWriter& operator=(const AtomicFileWriter&) = delete;
+
+    bool isOpen() const { return fd_ >= 0; }
+
+    /** Give the temp file other's permission bits (if other exists) */
+    void copyModeFrom(const std::string& other)
+    {
+        struct stat st {};
+        if (fd_ >= 0 && ::stat(other.c_str(), &st) == 0) {
+            ::fchmod(fd_, st.st_mode & 07777);
+        }
+    }
+
+    bool write(const char* data, size_t n)
+    {
+        if (fd_ < 0) {
+            return false;
+        }
+        while (n > 0) {
+            ssize_t w = ::write(fd_, data, n);
+            if (w < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            data += w;
+            n -= static_cast<size_t>(w);
+        }
+        return true;
+    }
+
+    bool commit()
+    {
+        if (fd_ < 0) {
+            return false;
+        }
+
+        bool ok = (::fsync(fd_) == 0);
+        ok = (::close(fd_) == 0) && ok;
+        fd_ = -1;
+
+        if (!ok || ::rename(tmp_.c_str(), path_.c_str()) != 0) {
+            ::unlink(tmp_.c_str());
+            return false;
+        }
+
+        // Best-effort: the new contents are already in place
+        fsyncDirectory(dirnameOf(path_));
+        committed_ = true;
+        return true;
+    }
+
+    void abort()
+    {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        if (!committed_) {
+            ::unlink(tmp_.c_str());
+            committed_ = true;
+        }
+    }
+
+private:
+    std::string path_;
+    std::string tmp_;
+    int fd_ = -1;
+    bool committed_ = false;
+};
+
+/**
+ * Atomically replace path with data. Returns false (and leaves the
+ * existing file untouched) on any failure.
+ */
+inline bool writeFileAtomic(const std::string& path, const std::string& data)
+{
+    AtomicFileWriter w(path);
+    return w.write(data.data(), data.size()) && w.commit();
+}
+
+} // namespace gcs
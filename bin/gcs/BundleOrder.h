@@ -0,0 +1,255 @@
+#pragma once
+
+// -----------------------------------------------------------------
+// BundleOrder (gcs-export order)
+//
+// Native port of the SchedulerPlanner dominance relaxation (step 3b).
+//
+// Each bundle is decoded once into a packed struct (epoch-day range,
+// day mask, start/end seconds). A sweep line over the date ranges
+// finds the overlapping pairs up front; since dominates() is false for
+// any non-overlapping pair, the scan "nearest entry above B that B
+// dominates" only needs to look at B's overlap neighbours.
+//
+// The pass structure, move rule and pass cap are the PHP loop's, so
+// the resulting order is identical to SchedulerPlanner's. A plain
+// topological sort is deliberately not used: the relaxation is
+// order-dependent (not confluent), and exact parity is required.
+//
+// Mutually dominating pairs (same start date and time, both active on
+// that weekday) can make the PHP loop bubble them past each other
+// forever; such inputs are refused so the caller keeps its own path.
+// -----------------------------------------------------------------
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <jsoncpp/json/json.h>
+
+#include "CivilDate.h"
+#include "DayMask.h"
+
+namespace gcs {
+
+struct PackedBundle {
+    int startDay = 0;       // range.start (epoch day)
+    int endDay = 0;         // range.end (epoch day)
+    int startDow = 0;       // weekday of range.start (0 = Sunday)
+    DayMask days = 0;
+    int startSec = 0;       // template start time-of-day
+    int endSec = 0;         // template end time-of-day (raw, no wrap)
+};
+
+namespace order {
+
+/** Strict "Y-m-d" -> epoch day */
+inline bool parseYmd(const std::string& s, int& out)
+{
+    int y = 0, m = 0, d = 0;
+    char tail = 0;
+    if (s.size() != 10 || s[4] != '-' || s[7] != '-' ||
+        std::sscanf(s.c_str(), "%4d-%2d-%2d%c", &y, &m, &d, &tail) != 3) {
+        return false;
+    }
+    out = daysFromCivil(y, m, d);
+    return true;
+}
+
+/** SchedulerPlanner::timeToSeconds() */
+inline int timeToSeconds(const std::string& raw)
+{
+    size_t b = 0, e = raw.size();
+    while (b < e && (raw[b] == ' ' || raw[b] == '\t' || raw[b] == '\n' || raw[b] == '\r' || raw[b] == '\0' || raw[b] == '\x0B')) b++;
+    while (e > b && (raw[e - 1] == ' ' || raw[e - 1] == '\t' || raw[e - 1] == '\n' || raw[e - 1] == '\r' || raw[e - 1] == '\0' || raw[e - 1] == '\x0B')) e--;
+    const std::string t = raw.substr(b, e - b);
+
+    auto dig = [&t](size_t i) { return t[i] >= '0' && t[i] <= '9'; };
+
+    if ((t.size() != 5 && t.size() != 8) || !dig(0) || !dig(1) || t[2] != ':' || !dig(3) || !dig(4)) {
+        return 0;
+    }
+    int s = 0;
+    if (t.size() == 8) {
+        if (t[5] != ':' || !dig(6) || !dig(7)) return 0;
+        s = (t[6] - '0') * 10 + (t[7] - '0');
+    }
+    return ((t[0] - '0') * 10 + (t[1] - '0')) * 3600 + ((t[3] - '0') * 10 + (t[4] - '0')) * 60 + s;
+}
+
+inline bool timeWindowsOverlap(int as, int ae, int bs, int be)
+{
+    if (ae <= as) ae += 86400;
+    if (be <= bs) be += 86400;
+    return !(ae <= bs || be <= as);
+}
+
+} // namespace order
+
+/** basesOverlapVerbose()['overlaps'] */
+inline bool bundlesOverlap(const PackedBundle& a, const PackedBundle& b)
+{
+    if (a.endDay <= b.startDay || b.endDay <= a.startDay) return false;
+    if (!dayMaskOverlaps(a.days, b.days)) return false;
+    return order::timeWindowsOverlap(a.startSec, a.endSec, b.startSec, b.endSec);
+}
+
+/** blocksStartAtIntendedMoment(a, b) */
+inline bool blocksStartAtIntendedMoment(const PackedBundle& a, const PackedBundle& b)
+{
+    if (b.startDay < a.startDay || b.startDay >= a.endDay) return false;
+    if (!dayMaskHas(a.days, b.startDow)) return false;
+
+    int aEnd = a.endSec;
+    if (aEnd <= a.startSec) aEnd += 86400;
+
+    if (a.startSec < b.startSec) return false;
+    return b.startSec >= a.startSec && b.startSec < aEnd;
+}
+
+/** dominates(a, b), for a pair already known to overlap */
+inline bool dominatesOverlapping(const PackedBundle& a, const PackedBundle& b)
+{
+    if (a.startSec > b.startSec) return true;
+    if (a.startSec == b.startSec && a.startDay > b.startDay) return true;
+    if (a.startSec == b.startSec && b.startDay > a.startDay) return false;
+    return blocksStartAtIntendedMoment(a, b);
+}
+
+/**
+ * Overlap neighbours per bundle (sweep over date ranges).
+ */
+inline std::vector<std::vector<int>> overlapNeighbours(const std::vector<PackedBundle>& bundles)
+{
+    const int n = static_cast<int>(bundles.size());
+    std::vector<std::vector<int>> nb(n);
+
+    std::vector<int> byStart(n);
+    for (int i = 0; i < n; i++) byStart[i] = i;
+    std::sort(byStart.begin(), byStart.end(), [&](int x, int y) {
+        return bundles[x].startDay < bundles[y].startDay ||
+               (bundles[x].startDay == bundles[y].startDay && x < y);
+    });
+
+    std::vector<int> active;
+    for (int cur : byStart) {
+        const PackedBundle& c = bundles[cur];
+
+        // Touching ranges do not overlap (end <= start)
+        active.erase(std::remove_if(active.begin(), active.end(), [&](int a) {
+            return bundles[a].endDay <= c.startDay;
+        }), active.end());
+
+        for (int a : active) {
+            if (bundlesOverlap(bundles[a], c)) {
+                nb[a].push_back(cur);
+                nb[cur].push_back(a);
+            }
+        }
+
+        if (c.endDay > c.startDay) {
+            active.push_back(cur);
+        }
+    }
+
+    return nb;
+}
+
+struct OrderResult {
+    bool ok = false;            // false: mutually dominating pair found
+    std::vector<int> order;     // order[position] = input index
+    int passes = 0;
+    int swaps = 0;
+};
+
+/**
+ * SchedulerPlanner step 3b on a baseline-sorted bundle list.
+ */
+inline OrderResult relaxBundleOrder(const std::vector<PackedBundle>& bundles, int maxPasses)
+{
+    const int n = static_cast<int>(bundles.size());
+    const std::vector<std::vector<int>> nb = overlapNeighbours(bundles);
+
+    OrderResult r;
+
+    for (int a = 0; a < n; a++) {
+        for (int b : nb[a]) {
+            if (a < b && dominatesOverlapping(bundles[a], bundles[b]) &&
+                dominatesOverlapping(bundles[b], bundles[a])) {
+                return r;
+            }
+        }
+    }
+
+    r.ok = true;
+    r.order.resize(n);
+    std::vector<int> pos(n);
+    for (int i = 0; i < n; i++) {
+        r.order[i] = i;
+        pos[i] = i;
+    }
+
+    while (r.passes < maxPasses) {
+        r.passes++;
+        bool changed = false;
+
+        for (int j = 0; j < n; j++) {
+            const int b = r.order[j];
+
+            // Nearest entry above B that B dominates
+            int target = -1;
+            for (int a : nb[b]) {
+                const int p = pos[a];
+                if (p < j && p > target && dominatesOverlapping(bundles[b], bundles[a])) {
+                    target = p;
+                }
+            }
+
+            if (target < 0) {
+                continue;
+            }
+
+            for (int k = j; k > target; k--) {
+                r.order[k] = r.order[k - 1];
+                pos[r.order[k]] = k;
+            }
+            r.order[target] = b;
+            pos[b] = target;
+
+            r.swaps++;
+            changed = true;
+
+            // Same continuation as the PHP loop ($j = $i; then $j++)
+            j = target;
+        }
+
+        if (!changed) {
+            break;
+        }
+    }
+
+    return r;
+}
+
+/**
+ * Decode one "order" request bundle; false if any field is malformed
+ * (the caller then uses the PHP loop, which tolerates odd values).
+ */
+inline bool packBundle(const Json::Value& v, PackedBundle& out)
+{
+    if (!order::parseYmd(v["start"].asString(), out.startDay) ||
+        !order::parseYmd(v["end"].asString(), out.endDay) ||
+        !v["dayMask"].isInt() || v["dayMask"].asInt() < 0 || v["dayMask"].asInt() > DAYMASK_ALL) {
+        return false;
+    }
+
+    out.days = static_cast<DayMask>(v["dayMask"].asInt());
+
+    out.startDow = weekdayFromDays(out.startDay);
+    out.startSec = order::timeToSeconds(v["startTime"].asString());
+    out.endSec = order::timeToSeconds(v["endTime"].asString());
+    return true;
+}
+
+} // namespace gcs
@@ -0,0 +1,73 @@
+#pragma once
+
+// -----------------------------------------------------------------
+// ByteWriter
+//
+// Little-endian append buffer shared by the binary formats
+// (EnvSnapshot.h, RecordStream.h); PHP reads them with unpack().
+// -----------------------------------------------------------------
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace gcs {
+
+class ByteWriter {
+public:
+    void u8(uint8_t v) { buf_.push_back(static_cast<char>(v)); }
+
+    void u16(uint16_t v)
+    {
+        u8(static_cast<uint8_t>(v & 0xff));
+        u8(static_cast<uint8_t>(v >> 8));
+    }
+
+    void u32(uint32_t v)
+    {
+        u16(static_cast<uint16_t>(v & 0xffff));
+        u16(static_cast<uint16_t>(v >> 16));
+    }
+
+    void i32(int32_t v) { u32(static_cast<uint32_t>(v)); }
+
+    void u64(uint64_t v)
+    {
+        u32(static_cast<uint32_t>(v & 0xffffffffu));
+        u32(static_cast<uint32_t>(v >> 32));
+    }
+
+    void i64(int64_t v) { u64(static_cast<uint64_t>(v)); }
+
+    void f64(double v)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        u64(bits);
+    }
+
+    void bytes(const std::string& s) { buf_.append(s); }
+
+    void fixed(const std::string& s, size_t len)
+    {
+        std::string out = s.substr(0, len > 0 ? len - 1 : 0);
+        out.resize(len, '\0');
+        buf_.append(out);
+    }
+
+    void str16(const std::string& s)
+    {
+        const std::string v = s.substr(0, 0xffff);
+        u16(static_cast<uint16_t>(v.size()));
+        buf_.append(v);
+    }
+
+    const std::string& data() const { return buf_; }
+    size_t size() const { return buf_.size(); }
+    void clear() { buf_.clear(); }
+
+private:
+    std::string buf_;
+};
+
+} // namespace gcs
@@ -0,0 +1,87 @@
+#pragma once
+
+// -----------------------------------------------------------------
+// CivilDate
+//
+// Proleptic Gregorian date arithmetic on integer epoch days
+// (days since 1970-01-01). Shared by the sun and holiday tables.
+//
+// - No time zones
+// - No allocation
+// - No libc date functions (safe for any year in range)
+// -----------------------------------------------------------------
+
+#include <cstdio>
+#include <string>
+
+namespace gcs {
+
+struct CivilDate {
+    int year  = 1970;
+    int month = 1;  // 1..12
+    int day   = 1;  // 1..31
+};
+
+// Howard Hinnant's days_from_civil
+inline int daysFromCivil(int y, int m, int d)
+{
+    y -= (m <= 2) ? 1 : 0;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int>(doe) - 719468;
+}
+
+inline CivilDate civilFromDays(int z)
+{
+    z += 719468;
+    const int era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int y = static_cast<int>(yoe) + era * 400;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    const unsigned d = doy - (153 * mp + 2) / 5 + 1;
+    const unsigned m = mp < 10 ? mp + 3 : mp - 9;
+
+    CivilDate out;
+    out.year  = y + (m <= 2 ? 1 : 0);
+    out.month = static_cast<int>(m);
+    out.day   = static_cast<int>(d);
+    return out;
+}
+
+// 0 = Sunday .. 6 = Saturday (matches FPP / PHP date('w'))
+inline int weekdayFromDays(int z)
+{
+    return (z >= -4) ? (z + 4) % 7 : (z + 5) % 7 + 6;
+}
+
+inline bool isLeapYear(int y)
+{
+    return (y % 4 == 0 && y % 100 != 0) || (y % 400 == 0);
+}
+
+inline int daysInMonth(int y, int m)
+{
+    static const int kDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (m == 2 && isLeapYear(y)) {
+        return 29;
+    }
+    return (m >= 1 && m <= 12) ? kDays[m - 1] : 0;
+}
+
+inline std::string formatYmd(const CivilDate& c)
+{
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "%04d-%02d-%02d", c.year, c.month, c.day);
+    return buf;
+}
+
+inline std::string formatYmd(int epochDay)
+{
+    return formatYmd(civilFromDays(epochDay));
+}
+
+} // namespace gcs
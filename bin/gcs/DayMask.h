@@ -0,0 +1,70 @@
+#pragma once
+
+// -----------------------------------------------------------------
+// DayMask
+//
+// Canonical weekday set shared by the native engines and mirrored by
+// src/Core/DayMask.php: bit 0 = Sunday .. bit 6 = Saturday (the same
+// numbering as weekdayFromDays() and PHP's date('w')).
+//
+// Overlap and containment are single AND/compare operations; the FPP
+// scheduler "day" enum is a table lookup.
+// -----------------------------------------------------------------
+
+#include <cstdint>
+
+namespace gcs {
+
+using DayMask = uint8_t;
+
+static const DayMask DAYMASK_NONE = 0x00;
+static const DayMask DAYMASK_ALL  = 0x7F;
+
+/** dow: 0 = Sunday .. 6 = Saturday */
+inline DayMask dayMaskOf(int dow)
+{
+    return static_cast<DayMask>(1u << dow);
+}
+
+inline bool dayMaskHas(DayMask mask, int dow)
+{
+    return dow >= 0 && dow < 7 && (mask & (1u << dow)) != 0;
+}
+
+inline bool dayMaskOverlaps(DayMask a, DayMask b)
+{
+    return (a & b) != 0;
+}
+
+/** true if every day in inner is also in outer (inner non-empty) */
+inline bool dayMaskContains(DayMask inner, DayMask outer)
+{
+    return inner != 0 && (inner & outer) == inner;
+}
+
+/*
+ * FPP scheduler "day" enum (ScheduleEntry.cpp): 0..6 single weekday,
+ * 7 everyday, 8 weekdays, 9 weekends, 10 M/W/F, 11 T/Th,
+ * 12 Sun-Thu, 13 Fri/Sat.
+ */
+static const DayMask FPP_DAY_ENUM_MASKS[14] = {
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40,
+    0x7F, 0x3E, 0x41, 0x2A, 0x14, 0x1F, 0x60,
+};
+
+/** FPP enum -> mask; DAYMASK_NONE for unknown values */
+inline DayMask dayMaskFromFppEnum(int en)
+{
+    return (en >= 0 && en < 14) ? FPP_DAY_ENUM_MASKS[en] : DAYMASK_NONE;
+}
+
+/** Mask -> FPP enum; -1 when FPP has no selector for this set */
+inline int dayMaskToFppEnum(DayMask mask)
+{
+    for (int en = 0; en < 14; en++) {
+        if (FPP_DAY_ENUM_MASKS[en] == mask) return en;
+    }
+    return -1;
+}
+
+} // namespace gcs
@@ -0,0 +1,67 @@
+#pragma once
+
+// -----------------------------------------------------------------
+// Digest
+//
+// FNV-1a 64-bit content digest. Used for change detection only
+// (not cryptographic): the exporter hashes its inputs and skips the
+// rewrite when the digest matches what is already on disk.
+//
+// update() over a whole body equals PHP's hash('fnv1a64', $body),
+// so content digests can be computed on either side.
+// -----------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace gcs {
+
+class Fnv1a64 {
+public:
+    Fnv1a64& add(const std::string& s)
+    {
+        for (unsigned char c : s) {
+            h_ ^= c;
+            h_ *= 0x100000001b3ULL;
+        }
+        // Field separator so ("ab","c") != ("a","bc")
+        h_ ^= 0xff;
+        h_ *= 0x100000001b3ULL;
+        return *this;
+    }
+
+    /** Raw bytes, no separator (streamed content digests) */
+    Fnv1a64& update(const char* p, size_t n)
+    {
+        for (size_t i = 0; i < n; i++) {
+            h_ ^= static_cast<unsigned char>(p[i]);
+            h_ *= 0x100000001b3ULL;
+        }
+        return *this;
+    }
+
+    Fnv1a64& add(long long v) { return add(std::to_string(v)); }
+
+    Fnv1a64& add(double v)
+    {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.9f", v);
+        return add(std::string(buf));
+    }
+
+    uint64_t value() const { return h_; }
+
+    std::string hex() const
+    {
+        char buf[17];
+        std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(h_));
+        return std::string(buf);
+    }
+
+private:
+    uint64_t h_ = 0xcbf29ce484222325ULL;
+};
+
+} // namespace gcs
@@ -0,0 +1,267 @@
+#pragma once
+
+// -----------------------------------------------------------------
+// EnvSnapshot
+//
+// Compact, versioned binary companion to fpp-env.json
+// (runtime/fpp-env.bin). PHP reads it with fread()/unpack() and
+// only touches the sections it needs; the JSON file remains the
+// debug / human-readable format.
+//
+// Layout (all integers little-endian):
+//
+//   0   char[4]  magic "GCSE"
+//   4   u16      format version (ENV_SNAPSHOT_VERSION)
+//   6   u16      section count
+//   8   u32      flags (bit 0 = ok)
+//   12  u32      header size (offset of section directory)
+//   16  f64      latitude
+//   24  f64      longitude
+//   32  char[64] timezone (NUL padded)
+//   96  section directory, 16 bytes per section:
+//         char[4] id, u32 offset, u32 length, u32 count
+//
+// Sections:
+//   SUNT  i32 startEpochDay, u32 days, then days x 4 x u32
+//         (dawn, sunrise, sunset, dusk seconds since local midnight)
+//   HDEF  holiday definitions, count records of:
+//         u16 nameLen, name, i8 month, i8 day,
+//         u8 calcType (0 none, 1 easter, 2 head, 3 tail),
+//         i8 calcMonth, i8 dow, i8 week, i16 offset
+//   HDAT  resolved holiday dates: i32 startYear, u32 years, then
+//         count records of: u16 nameLen, name, years x i32 epochDay
+//         (HOLIDAY_UNRESOLVED = -1 when the holiday has no date)
+//   EDIG  envDigest as 16 lowercase hex chars (same value as JSON)
+//   TIDX  media target index (see TargetIndex.h): str16 stamp, then
+//         count records of: u8 kind (1 playlist, 2 sequence), str16 name
+//   EERR  export errors (JSON "errors"), count x str16 message; only
+//         written when there are any
+//
+// Unknown sections must be ignored by readers.
+// -----------------------------------------------------------------
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <jsoncpp/json/json.h>
+
+#include "ByteWriter.h"
+#include "CivilDate.h"
+#include "HolidayTable.h"
+#include "TargetIndex.h"
+
+namespace gcs {
+
+static const uint16_t ENV_SNAPSHOT_VERSION = 1;
+static const size_t   ENV_SNAPSHOT_HEADER  = 96;
+static const size_t   ENV_SNAPSHOT_TZ_LEN  = 64;
+
+struct SnapshotSection {
+    std::string id;     // 4 chars
+    std::string body;
+    uint32_t    count = 0;
+};
+
+inline SnapshotSection buildSunSection(const Json::Value& sunTable)
+{
+    SnapshotSection sec;
+    sec.id = "SUNT";
+
+    const Json::Value& times = sunTable["times"];
+    const std::string start = sunTable["startDate"].asString();
+
+    int y = 0, m = 0, d = 0;
+    if (std::sscanf(start.c_str(), "%d-%d-%d", &y, &m, &d) != 3) {
+        return sec;
+    }
+
+    ByteWriter w;
+    w.i32(daysFromCivil(y, m, d));
+    w.u32(times.size());
+    for (const Json::Value& row : times) {
+        for (Json::ArrayIndex i = 0; i < 4; i++) {
+            w.u32(static_cast<uint32_t>(row[i].asInt()));
+        }
+    }
+
+    sec.body  = w.data();
+    sec.count = times.size();
+    return sec;
+}
+
+inline uint8_t holidayCalcType(const Json::Value& calc)
+{
+    if (!calc.isObject()) {
+        return 0;
+    }
+    const std::string type = calc["type"].asString();
+    if (type == "easter") return 1;
+    if (type == "head")   return 2;
+    if (type == "tail")   return 3;
+    return 0;
+}
+
+inline SnapshotSection buildHolidaySection(const Json::Value& locale)
+{
+    SnapshotSection sec;
+    sec.id = "HDEF";
+
+    const Json::Value& holidays = locale.isObject() ? locale["holidays"] : Json::Value();
+    if (!holidays.isArray()) {
+        return sec;
+    }
+
+    ByteWriter w;
+    for (const Json::Value& h : holidays) {
+        if (!h.isObject() || !h["shortName"].isString()) {
+            continue;
+        }
+
+        const Json::Value& calc = h["calc"];
+        const bool hasCalc = calc.isObject();
+
+        w.str16(h["shortName"].asString());
+        w.u8(static_cast<uint8_t>(h["month"].asInt()));
+        w.u8(static_cast<uint8_t>(h["day"].asInt()));
+        w.u8(holidayCalcType(calc));
+        w.u8(static_cast<uint8_t>(hasCalc ? calc["month"].asInt() : 0));
+        w.u8(static_cast<uint8_t>(hasCalc ? calc["dow"].asInt() : 0));
+        w.u8(static_cast<uint8_t>(hasCalc ? calc["week"].asInt() : 0));
+        w.u16(static_cast<uint16_t>(static_cast<int16_t>(hasCalc ? calc["offset"].asInt() : 0)));
+        sec.count++;
+    }
+
+    sec.body = w.data();
+    return sec;
+}
+
+inline SnapshotSection buildHolidayDatesSection(const Json::Value& table)
+{
+    SnapshotSection sec;
+    sec.id = "HDAT";
+
+    const int years = table["years"].asInt();
+
+    ByteWriter w;
+    w.i32(table["startYear"].asInt());
+    w.u32(static_cast<uint32_t>(years > 0 ? years : 0));
+
+    const Json::Value& dates = table["dates"];
+    for (const std::string& name : dates.getMemberNames()) {
+        const Json::Value& list = dates[name];
+
+        w.str16(name);
+        for (int i = 0; i < years; i++) {
+            int y = 0, m = 0, d = 0;
+            const std::string ymd = list[i].asString();
+            if (std::sscanf(ymd.c_str(), "%d-%d-%d", &y, &m, &d) == 3) {
+                w.i32(daysFromCivil(y, m, d));
+            } else {
+                w.i32(HOLIDAY_UNRESOLVED);
+            }
+        }
+        sec.count++;
+    }
+
+    sec.body = w.data();
+    return sec;
+}
+
+inline SnapshotSection buildTargetIndexSection(const Json::Value& index)
+{
+    SnapshotSection sec;
+    sec.id = "TIDX";
+
+    ByteWriter w;
+    w.str16(index["stamp"].asString());
+
+    const struct {
+        const char* key;
+        TargetKind kind;
+    } lists[] = {
+        { "playlists", TargetKind::Playlist },
+        { "sequences", TargetKind::Sequence },
+    };
+
+    for (const auto& l : lists) {
+        for (const Json::Value& name : index[l.key]) {
+            w.u8(static_cast<uint8_t>(l.kind));
+            w.str16(name.asString());
+            sec.count++;
+        }
+    }
+
+    sec.body = w.data();
+    return sec;
+}
+
+/**
+ * Serialize the snapshot from the same Json root written to fpp-env.json.
+ */
+inline std::string buildEnvSnapshot(const Json::Value& root)
+{
+    std::vector<SnapshotSection> sections;
+
+    if (root["sunTable"].isObject()) {
+        sections.push_back(buildSunSection(root["sunTable"]));
+    }
+    sections.push_back(buildHolidaySection(root["rawLocale"]));
+    if (root["holidayDates"].isObject()) {
+        sections.push_back(buildHolidayDatesSection(root["holidayDates"]));
+    }
+    if (root["envDigest"].isString()) {
+        SnapshotSection dig;
+        dig.id = "EDIG";
+        dig.body = root["envDigest"].asString();
+        dig.count = 1;
+        sections.push_back(dig);
+    }
+    if (root["targetIndex"].isObject()) {
+        sections.push_back(buildTargetIndexSection(root["targetIndex"]));
+    }
+    if (root["errors"].isArray() && !root["errors"].empty()) {
+        SnapshotSection err;
+        err.id = "EERR";
+        ByteWriter ew;
+        for (const Json::Value& e : root["errors"]) {
+            ew.str16(e.asString());
+            err.count++;
+        }
+        err.body = ew.data();
+        sections.push_back(err);
+    }
+
+    const size_t dirSize = sections.size() * 16;
+
+    ByteWriter w;
+    w.bytes("GCSE");
+    w.u16(ENV_SNAPSHOT_VERSION);
+    w.u16(static_cast<uint16_t>(sections.size()));
+    w.u32(root["ok"].asBool() ? 1u : 0u);
+    w.u32(static_cast<uint32_t>(ENV_SNAPSHOT_HEADER));
+    w.f64(root["latitude"].asDouble());
+    w.f64(root["longitude"].asDouble());
+    w.fixed(root["timezone"].asString(), ENV_SNAPSHOT_TZ_LEN);
+
+    uint32_t offset = static_cast<uint32_t>(ENV_SNAPSHOT_HEADER + dirSize);
+    for (const SnapshotSection& sec : sections) {
+        std::string id = sec.id;
+        id.resize(4, '\0');
+        w.bytes(id);
+        w.u32(offset);
+        w.u32(static_cast<uint32_t>(sec.body.size()));
+        w.u32(sec.count);
+        offset += static_cast<uint32_t>(sec.body.size());
+    }
+
+    for (const SnapshotSection& sec : sections) {
+        w.bytes(sec.body);
+    }
+
+    return w.data();
+}
+
+} // namespace gcs
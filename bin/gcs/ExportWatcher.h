@@ -0,0 +1,275 @@
+#pragma once
+
+// -----------------------------------------------------------------
+// ExportWatcher (gcs-export --watch)
+//
+// Resident mode: watch the FPP settings file, the locale directory
+// and the playlist / sequence directories (target index) with inotify
+// and re-run the export only when they change.
+//
+// Each export runs in a forked child so that LoadSettings() and the
+// locale holder start from a clean process every time (libfpp keeps
+// both in process-wide state). The parent never touches FPP state.
+//
+// A periodic re-export (default hourly) covers year rollover of the
+// sun/holiday windows; the digest check makes it a no-op otherwise.
+//
+// An optional periodic task runs on its own deadline (gcs-export uses
+// it to start the auto-sync worker). Both deadlines are monotonic, so
+// inotify traffic never postpones either of them.
+//
+// Liveness: <outputDir>/gcs-export.pid holds the daemon pid while it
+// runs, so plugin.php can skip shelling out. Single instance: the
+// daemon holds an exclusive flock on <outputDir>/gcs-export.lock for
+// its lifetime (the pid file is replaced by rename, so it cannot carry
+// the lock); a second daemon started by a concurrent page load exits.
+// -----------------------------------------------------------------
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/file.h>
+#include <sys/inotify.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "AtomicFile.h"
+#include "Log.h"
+
+namespace gcs {
+
+static const char* WATCH_PID_FILE = "gcs-export.pid";
+static const char* WATCH_LOCK_FILE = "gcs-export.lock";
+
+// Quiet period after the last change before exporting
+static const int WATCH_DEBOUNCE_MS = 500;
+
+struct WatchTarget {
+    std::string dir;
+    std::string name;   // only this entry; empty = any entry in dir
+};
+
+namespace detail {
+
+inline volatile sig_atomic_t& watchStopFlag()
+{
+    static volatile sig_atomic_t flag = 0;
+    return flag;
+}
+
+inline void onWatchSignal(int)
+{
+    watchStopFlag() = 1;
+}
+
+inline bool pidAlive(pid_t pid)
+{
+    return pid > 0 && (::kill(pid, 0) == 0 || errno == EPERM);
+}
+
+inline pid_t readPidFile(const std::string& path)
+{
+    std::ifstream in(path);
+    long pid = 0;
+    if (in >> pid) {
+        return static_cast<pid_t>(pid);
+    }
+    return 0;
+}
+
+/**
+ * Drain pending inotify events; true if any matched a target.
+ */
+inline bool drainEvents(int fd, const std::vector<int>& wds, const std::vector<WatchTarget>& targets)
+{
+    alignas(struct inotify_event) char buf[4096];
+    bool matched = false;
+
+    for (;;) {
+        ssize_t n = ::read(fd, buf, sizeof(buf));
+        if (n <= 0) {
+            break;
+        }
+
+        for (char* p = buf; p < buf + n; ) {
+            const struct inotify_event* ev = reinterpret_cast<const struct inotify_event*>(p);
+            for (size_t i = 0; i < wds.size(); i++) {
+                if (wds[i] != ev->wd) {
+                    continue;
+                }
+                if (targets[i].name.empty() ||
+                    (ev->len > 0 && targets[i].name == ev->name)) {
+                    matched = true;
+                }
+            }
+            p += sizeof(struct inotify_event) + ev->len;
+        }
+    }
+
+    return matched;
+}
+
+inline int exportInChild(const std::function<int()>& exportOnce)
+{
+    flushLog();
+
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        LogLine(LogLevel::Error) << "fork failed: " << std::strerror(errno);
+        return 2;
+    }
+
+    if (pid == 0) {
+        const int rc = exportOnce();
+        flushLog();
+        ::_exit(rc);
+    }
+
+    int status = 0;
+    while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 2;
+}
+
+} // namespace detail
+
+/**
+ * Run until SIGTERM/SIGINT. Returns the process exit code.
+ *
+ * periodic (optional) runs in this process right after startup and
+ * then whenever its deadline passes; it returns the seconds until its
+ * next run and must not block.
+ */
+inline int runExportWatcher(
+    const std::string& outputDir,
+    const std::vector<WatchTarget>& targets,
+    int refreshSeconds,
+    const std::function<int()>& exportOnce,
+    const std::function<int()>& periodic = nullptr)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const std::string pidPath = outputDir + "/" + WATCH_PID_FILE;
+
+    const std::string lockPath = outputDir + "/" + WATCH_LOCK_FILE;
+
+    // Held until exit; forked export children share it, exec'd
+    // processes do not inherit it
+    const int lockFd = ::open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (lockFd < 0) {
+        LogLine(LogLevel::Error) << "Unable to open " << lockPath << ": " << std::strerror(errno);
+        return 2;
+    }
+    if (::flock(lockFd, LOCK_EX | LOCK_NB) != 0) {
+        LogLine(LogLevel::Info) << "gcs-export watcher already running (pid "
+                                << detail::readPidFile(pidPath) << ")";
+        ::close(lockFd);
+        return 0;
+    }
+
+    int fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        LogLine(LogLevel::Error) << "inotify unavailable: " << std::strerror(errno);
+        ::close(lockFd);
+        return 2;
+    }
+
+    std::vector<int> wds;
+    for (const WatchTarget& t : targets) {
+        int wd = ::inotify_add_watch(
+            fd, t.dir.c_str(),
+            IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE
+        );
+        if (wd < 0) {
+            LogLine(LogLevel::Warn) << "Unable to watch " << t.dir;
+        }
+        wds.push_back(wd);
+    }
+
+    if (!writeFileAtomic(pidPath, std::to_string(::getpid()) + "\n")) {
+        LogLine(LogLevel::Warn) << "Unable to write " << pidPath;
+    }
+
+    struct sigaction sa {};
+    sa.sa_handler = detail::onWatchSignal;
+    ::sigaction(SIGTERM, &sa, nullptr);
+    ::sigaction(SIGINT, &sa, nullptr);
+    ::signal(SIGHUP, SIG_IGN);
+
+    // Initial export so a fresh daemon never serves stale output
+    detail::exportInChild(exportOnce);
+
+    struct pollfd pfd {};
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+
+    Clock::time_point refreshAt = Clock::now() + std::chrono::seconds(refreshSeconds);
+    Clock::time_point taskAt = Clock::now();
+
+    while (!detail::watchStopFlag()) {
+        Clock::time_point now = Clock::now();
+
+        if (periodic && now >= taskAt) {
+            const int next = periodic();
+            taskAt = now + std::chrono::seconds(next > 0 ? next : 1);
+        }
+
+        if (now >= refreshAt) {
+            detail::exportInChild(exportOnce);
+            refreshAt = Clock::now() + std::chrono::seconds(refreshSeconds);
+            continue;
+        }
+
+        const Clock::time_point wake = (periodic && taskAt < refreshAt) ? taskAt : refreshAt;
+        const long long waitMs =
+            std::chrono::duration_cast<std::chrono::milliseconds>(wake - now).count() + 1;
+
+        int rc = ::poll(&pfd, 1, static_cast<int>(waitMs));
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LogLine(LogLevel::Error) << "poll failed: " << std::strerror(errno);
+            break;
+        }
+
+        if (rc == 0) {
+            continue;
+        }
+
+        if (!detail::drainEvents(fd, wds, targets)) {
+            continue;
+        }
+
+        // Editors and FPP write settings in several steps; wait for quiet
+        while (!detail::watchStopFlag() && ::poll(&pfd, 1, WATCH_DEBOUNCE_MS) > 0) {
+            detail::drainEvents(fd, wds, targets);
+        }
+
+        if (!detail::watchStopFlag()) {
+            detail::exportInChild(exportOnce);
+            refreshAt = Clock::now() + std::chrono::seconds(refreshSeconds);
+        }
+    }
+
+    ::close(fd);
+
+    if (detail::readPidFile(pidPath) == ::getpid()) {
+        ::unlink(pidPath.c_str());
+    }
+    ::close(lockFd);
+
+    return 0;
+}
+
+} // namespace gcs
@@ -0,0 +1,145 @@
+#pragma once
+
+// -----------------------------------------------------------------
+// HolidayTable
+//
+// Resolves every FPP locale holiday into concrete dates for a
+// window of years, so PHP resolution becomes a hash lookup.
+//
+// Rules are a direct port of HolidayResolver::dateFromHoliday():
+// - calc.type == "easter" : Easter Sunday + calc.offset days
+// - calc.type == "head"   : Nth weekday of calc.month
+// - calc.type == "tail"   : Nth-from-last weekday of calc.month
+// - otherwise             : fixed month/day (day overflow rolls into
+//                           the next month, like PHP DateTime)
+//
+// A calc block always wins over month/day (FPP uses month/day = 0).
+// -----------------------------------------------------------------
+
+#include <string>
+
+#include <jsoncpp/json/json.h>
+
+#include "CivilDate.h"
+
+namespace gcs {
+
+static const int HOLIDAY_TABLE_DEFAULT_YEARS = 7;
+
+// Sentinel for "does not resolve in this year"
+static const int HOLIDAY_UNRESOLVED = -1;
+
+// Anonymous Gregorian algorithm (same result as PHP easter_date())
+inline int easterEpochDay(int year)
+{
+    const int a = year % 19;
+    const int b = year / 100;
+    const int c = year % 100;
+    const int d = b / 4;
+    const int e = b % 4;
+    const int f = (b + 8) / 25;
+    const int g = (b - f + 1) / 3;
+    const int h = (19 * a + b - d - g + 15) % 30;
+    const int i = c / 4;
+    const int k = c % 4;
+    const int l = (32 + 2 * e + 2 * i - h - k) % 7;
+    const int m = (a + 11 * h + 22 * l) / 451;
+    const int month = (h + l - 7 * m + 114) / 31;
+    const int day = ((h + l - 7 * m + 114) % 31) + 1;
+    return daysFromCivil(year, month, day);
+}
+
+inline int resolveCalculatedHoliday(const Json::Value& calc, int year)
+{
+    const std::string type = calc["type"].asString();
+
+    if (type == "easter") {
+        return easterEpochDay(year) + calc["offset"].asInt();
+    }
+
+    if (!calc.isMember("month") || !calc.isMember("dow") || !calc.isMember("week")) {
+        return HOLIDAY_UNRESOLVED;
+    }
+
+    const int month = calc["month"].asInt();
+    const int dow   = calc["dow"].asInt();    // FPP: 0 = Sunday .. 6 = Saturday
+    const int week  = calc["week"].asInt();
+
+    if (month < 1 || month > 12) {
+        return HOLIDAY_UNRESOLVED;
+    }
+
+    if (type == "tail") {
+        int day = daysFromCivil(year, month, daysInMonth(year, month));
+        while (weekdayFromDays(day) != ((dow % 7) + 7) % 7) {
+            day--;
+        }
+        day -= (week - 1) * 7;
+
+        if (civilFromDays(day).month != month) {
+            return HOLIDAY_UNRESOLVED;
+        }
+        return day;
+    }
+
+    if (type == "head") {
+        const int first = daysFromCivil(year, month, 1);
+        const int delta = ((dow - weekdayFromDays(first)) % 7 + 7) % 7;
+        const int dom = 1 + delta + (week - 1) * 7;
+
+        if (dom < 1 || dom > daysInMonth(year, month)) {
+            return HOLIDAY_UNRESOLVED;
+        }
+        return first + dom - 1;
+    }
+
+    return HOLIDAY_UNRESOLVED;
+}
+
+inline int resolveHoliday(const Json::Value& def, int year)
+{
+    if (def["calc"].isObject()) {
+        return resolveCalculatedHoliday(def["calc"], year);
+    }
+
+    const int m = def["month"].asInt();
+    const int d = def["day"].asInt();
+    if (m >= 1 && m <= 12 && d >= 1 && d <= 31) {
+        return daysFromCivil(year, m, d);
+    }
+
+    return HOLIDAY_UNRESOLVED;
+}
+
+/**
+ * Build the fpp-env.json "holidayDates" map:
+ *   shortName -> ["YYYY-MM-DD" | "" (unresolved), ...] one per year,
+ *   starting at startYear.
+ */
+inline Json::Value buildHolidayDates(const Json::Value& locale, int startYear, int years)
+{
+    Json::Value out(Json::objectValue);
+
+    const Json::Value& holidays = locale.isObject() ? locale["holidays"] : Json::Value();
+    if (!holidays.isArray()) {
+        return out;
+    }
+
+    for (const Json::Value& h : holidays) {
+        if (!h.isObject() || !h["shortName"].isString()) {
+            continue;
+        }
+
+        Json::Value dates(Json::arrayValue);
+        for (int y = startYear; y < startYear + years; y++) {
+            const int day = resolveHoliday(h, y);
+            dates.append(day == HOLIDAY_UNRESOLVED ? std::string() : formatYmd(day));
+        }
+
+        out[h["shortName"].asString()] = dates;
+    }
+
+    return out;
+}
+
+} // namespace gcs
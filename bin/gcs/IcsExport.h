@@ -0,0 +1,1135 @@
+#pragma once
+
+// -----------------------------------------------------------------
+// IcsExport (gcs-export export-ics)
+//
+// Native ExportService: schedule entries in, RFC5545 calendar out.
+// Each entry is adapted as ScheduleEntryExportAdapter::adapt() does
+// and its VEVENT is written immediately, so only the entry being
+// converted is held in memory.
+//
+// Output matches src/Core/IcsWriter.php line for line:
+// - Lines are folded at 75 octets (never inside a UTF-8 sequence)
+// - VTIMEZONE lists the zone's transitions from a year back to six
+//   years ahead, computed once per run from the C library tz data
+// - UIDs are deterministic: "gcs-export-<fnv1a64>@local" over the
+//   event content, "-<n>" appended for the n-th identical event
+//
+// Environment (timezone, coordinates, sun table, holidays) comes
+// from the fpp-env.json written by the plain export, as FppEnvironment
+// supplies it to the PHP side.
+// -----------------------------------------------------------------
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <jsoncpp/json/json.h>
+
+#include "CivilDate.h"
+#include "DayMask.h"
+#include "Digest.h"
+#include "HolidayTable.h"
+#include "SunTable.h"
+#include "ZoneClock.h"
+
+namespace gcs {
+
+static const size_t ICS_FOLD_OCTETS = 75;
+
+// FPPSemantics::DEFAULT_ROUNDING_MINUTES
+static const int EXPORT_ROUNDING_MINUTES = 30;
+
+/* =================================================================
+ * Folded CRLF line output
+ * ================================================================= */
+
+class IcsLineWriter {
+public:
+    typedef std::function<bool(const char*, size_t)> Sink;
+
+    explicit IcsLineWriter(Sink sink) : sink_(std::move(sink)) {}
+
+    /** One content line; folded and CRLF-terminated */
+    void line(const std::string& s)
+    {
+        size_t at = 0;
+        bool first = true;
+
+        for (;;) {
+            const size_t limit = first ? ICS_FOLD_OCTETS : ICS_FOLD_OCTETS - 1;
+            if (!first) {
+                buf_ += ' ';
+            }
+            if (s.size() - at <= limit) {
+                buf_.append(s, at, std::string::npos);
+                break;
+            }
+
+            size_t cut = at + limit;
+            while (cut > at && (static_cast<unsigned char>(s[cut]) & 0xC0) == 0x80) {
+                cut--;
+            }
+            if (cut == at) {
+                cut = at + limit;
+            }
+
+            buf_.append(s, at, cut - at);
+            buf_ += "\r\n";
+            at = cut;
+            first = false;
+        }
+        buf_ += "\r\n";
+
+        if (buf_.size() >= FLUSH_BYTES) {
+            flush();
+        }
+    }
+
+    bool flush()
+    {
+        if (!buf_.empty()) {
+            ok_ = ok_ && sink_(buf_.data(), buf_.size());
+            bytes_ += buf_.size();
+            buf_.clear();
+        }
+        return ok_;
+    }
+
+    bool ok() const { return ok_; }
+
+    unsigned long long bytes() const { return bytes_ + buf_.size(); }
+
+private:
+    static const size_t FLUSH_BYTES = 65536;
+
+    Sink sink_;
+    std::string buf_;
+    unsigned long long bytes_ = 0;
+    bool ok_ = true;
+};
+
+/* =================================================================
+ * PHP value semantics for schedule.json fields
+ * ================================================================= */
+
+namespace exporter {
+
+inline bool isTrimChar(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\0' || c == '\x0B';
+}
+
+inline std::string trim(const std::string& s)
+{
+    size_t b = 0;
+    size_t e = s.size();
+    while (b < e && isTrimChar(s[b])) b++;
+    while (e > b && isTrimChar(s[e - 1])) e--;
+    return s.substr(b, e - b);
+}
+
+/** (string)$v */
+inline std::string str(const Json::Value& v)
+{
+    switch (v.type()) {
+    case Json::stringValue:
+        return v.asString();
+    case Json::intValue:
+        return std::to_string(v.asInt64());
+    case Json::uintValue:
+        return std::to_string(v.asUInt64());
+    case Json::realValue: {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.14G", v.asDouble());
+        return buf;
+    }
+    case Json::booleanValue:
+        return v.asBool() ? "1" : "";
+    case Json::arrayValue:
+    case Json::objectValue:
+        return "Array";
+    default:
+        return "";
+    }
+}
+
+/** (string)($v ?? $fallback) */
+inline std::string str(const Json::Value& v, const std::string& fallback)
+{
+    return v.isNull() ? fallback : str(v);
+}
+
+/** (int)$v */
+inline long long intval(const Json::Value& v, long long fallback = 0)
+{
+    switch (v.type()) {
+    case Json::intValue:
+        return v.asInt64();
+    case Json::uintValue:
+        return static_cast<long long>(v.asUInt64());
+    case Json::realValue:
+        return static_cast<long long>(v.asDouble());
+    case Json::booleanValue:
+        return v.asBool() ? 1 : 0;
+    case Json::stringValue:
+        return std::strtoll(v.asCString(), nullptr, 10);
+    case Json::arrayValue:
+    case Json::objectValue:
+        return v.empty() ? 0 : 1;
+    default:
+        return fallback;
+    }
+}
+
+/** empty($v) */
+inline bool isEmpty(const Json::Value& v)
+{
+    switch (v.type()) {
+    case Json::nullValue:
+        return true;
+    case Json::intValue:
+    case Json::uintValue:
+        return v.asInt64() == 0;
+    case Json::realValue:
+        return v.asDouble() == 0.0;
+    case Json::booleanValue:
+        return !v.asBool();
+    case Json::stringValue:
+        return v.asString().empty() || v.asString() == "0";
+    default:
+        return v.empty();
+    }
+}
+
+/** FPPSemantics::normalizeEnabled() (false, 0 and "0" disable) */
+inline bool isEnabled(const Json::Value& v)
+{
+    if (v.isBool()) {
+        return v.asBool();
+    }
+    if (v.type() == Json::intValue || v.type() == Json::uintValue) {
+        return v.asInt64() != 0;
+    }
+    return !(v.isString() && v.asString() == "0");
+}
+
+/** /^\d{N}-\d{N}-\d{N}$/-style fixed digit layout */
+inline bool matchesLayout(const std::string& s, const char* layout)
+{
+    const size_t n = std::strlen(layout);
+    if (s.size() != n) {
+        return false;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (layout[i] == 'd' ? (s[i] < '0' || s[i] > '9') : s[i] != layout[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline bool isYmd(const std::string& s) { return matchesLayout(s, "dddd-dd-dd"); }
+
+inline bool isHms(const std::string& s) { return matchesLayout(s, "dd:dd:dd"); }
+
+/** new DateTime($ymd) as an epoch day (day overflow rolls over) */
+inline bool ymdToDays(const std::string& ymd, int& out)
+{
+    int y = 0, m = 0, d = 0;
+    if (std::sscanf(ymd.c_str(), "%d-%d-%d", &y, &m, &d) != 3 ||
+        m < 1 || m > 12 || d < 1 || d > 31) {
+        return false;
+    }
+    out = daysFromCivil(y, m, d);
+    return true;
+}
+
+/** DateTime::format('Ymd\THis') */
+inline std::string icsStamp(const WallTime& w)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%04d%02d%02dT%02d%02d%02d",
+        w.year, w.month, w.day, w.hour, w.minute, w.second);
+    return buf;
+}
+
+/** IcsWriter::escapeText() */
+inline std::string escapeText(const std::string& s)
+{
+    std::string out;
+    out.reserve(s.size());
+    for (char c : s) {
+        switch (c) {
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case ',':  out += "\\,"; break;
+        case ';':  out += "\\;"; break;
+        default:   out += c;
+        }
+    }
+    return out;
+}
+
+/** IcsWriter::formatOffset() */
+inline std::string formatOffset(long seconds)
+{
+    const char sign = (seconds >= 0) ? '+' : '-';
+    seconds = std::labs(seconds);
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "%c%02d%02d", sign,
+        static_cast<int>(seconds / 3600 % 100), static_cast<int>((seconds % 3600) / 60));
+    return buf;
+}
+
+/** DayMask::toByDay(), Sunday first; '' for everyday / unknown */
+inline std::string byDayList(int dayEnum)
+{
+    static const char* CODES[] = { "SU", "MO", "TU", "WE", "TH", "FR", "SA" };
+
+    const DayMask mask = dayMaskFromFppEnum(dayEnum);
+    if (mask == DAYMASK_ALL) {
+        return "";
+    }
+
+    std::string out;
+    for (int dow = 0; dow < 7; dow++) {
+        if (dayMaskHas(mask, dow)) {
+            if (!out.empty()) {
+                out += ',';
+            }
+            out += CODES[dow];
+        }
+    }
+    return out;
+}
+
+} // namespace exporter
+
+/* =================================================================
+ * Runtime environment (fpp-env.json)
+ * ================================================================= */
+
+struct ExportEnv {
+    std::string timezone;
+
+    bool hasCoords = false;
+    double latitude = 0.0;
+    double longitude = 0.0;
+
+    // Sun table (only when it matches coordinates and zone)
+    bool hasSunTable = false;
+    int sunStartDay = 0;
+    Json::Value sunTimes;
+
+    // Exporter-resolved holiday dates
+    bool hasHolidayDates = false;
+    int holidayStartYear = 0;
+    int holidayYears = 0;
+    Json::Value holidayDates;
+
+    // Locale holiday definitions by shortName
+    Json::Value holidays = Json::Value(Json::objectValue);
+};
+
+/** FppEnvironment::loadFromFile() subset used by the export */
+inline ExportEnv exportEnvFromJson(const Json::Value& root)
+{
+    ExportEnv env;
+    if (!root.isObject()) {
+        return env;
+    }
+
+    if (root["timezone"].isString()) {
+        env.timezone = root["timezone"].asString();
+    }
+
+    env.hasCoords = root["latitude"].isNumeric() && root["longitude"].isNumeric();
+    if (env.hasCoords) {
+        env.latitude = root["latitude"].asDouble();
+        env.longitude = root["longitude"].asDouble();
+    }
+
+    const Json::Value& sun = root["sunTable"];
+    int y = 0, m = 0, d = 0;
+    if (env.hasCoords && sun.isObject() && sun["times"].isArray() &&
+        sun["startDate"].isString() &&
+        std::sscanf(sun["startDate"].asCString(), "%d-%d-%d", &y, &m, &d) == 3 &&
+        sun["latitude"].isNumeric() && sun["longitude"].isNumeric() &&
+        std::fabs(sun["latitude"].asDouble() - env.latitude) < 1e-9 &&
+        std::fabs(sun["longitude"].asDouble() - env.longitude) < 1e-9 &&
+        sun["timezone"].isString() && root["timezone"].isString() &&
+        sun["timezone"].asString() == env.timezone) {
+        env.hasSunTable = true;
+        env.sunStartDay = daysFromCivil(y, m, d);
+        env.sunTimes = sun["times"];
+    }
+
+    const Json::Value& hd = root["holidayDates"];
+    if (hd.isObject() && hd["startYear"].isInt() && hd["years"].isInt() && hd["dates"].isObject()) {
+        env.hasHolidayDates = true;
+        env.holidayStartYear = hd["startYear"].asInt();
+        env.holidayYears = hd["years"].asInt();
+        env.holidayDates = hd["dates"];
+    }
+
+    const Json::Value& locale = root["rawLocale"];
+    if (locale.isObject() && locale["holidays"].isArray()) {
+        for (const Json::Value& h : locale["holidays"]) {
+            if (h.isObject() && h["shortName"].isString()) {
+                env.holidays[h["shortName"].asString()] = h;
+            }
+        }
+    }
+
+    return env;
+}
+
+/* =================================================================
+ * Export events
+ * ================================================================= */
+
+/** Insertion-ordered YAML value (IcsWriter emits PHP array order) */
+struct YamlItem {
+    std::string key;
+    Json::Value value;              // scalar; ignored for maps
+    std::vector<YamlItem> children;
+    bool isMap = false;
+};
+
+struct ExportEvent {
+    std::string summary;
+    time_t start = 0;
+    time_t end = 0;
+    std::string rrule;              // '' = none
+    std::vector<YamlItem> yaml;
+};
+
+/**
+ * ScheduleEntryExportAdapter::adapt() with the FPPSemantics,
+ * HolidayResolver and SunTimeEstimator rules it relies on.
+ *
+ * The process TZ must be the export zone (see ZoneClock).
+ */
+class ScheduleEntryExporter {
+public:
+    ScheduleEntryExporter(ZoneClock& clock, const ExportEnv& env, time_t now)
+        : clock_(clock), env_(env), now_(now)
+    {
+        const WallTime today = clock_.local(now_);
+        currentYear_ = today.year;
+        todayDay_ = daysFromCivil(today.year, today.month, today.day);
+        nowSecondOfDay_ = today.hour * 3600 + today.minute * 60 + today.second;
+
+        struct tm lt {};
+        ::localtime_r(&now_, &lt);
+        nowOffsetHours_ = static_cast<double>(lt.tm_gmtoff) / 3600.0;
+    }
+
+    /** false = entry skipped (reason appended to warnings) */
+    bool adapt(const Json::Value& entry, ExportEvent& ev, std::vector<std::string>& warnings)
+    {
+        using namespace exporter;
+
+        const std::string playlist = trim(str(entry["playlist"], ""));
+        const std::string command = trim(str(entry["command"], ""));
+
+        /* ---------------- Determine entry type ---------------- */
+
+        std::string type;
+        std::string summary;
+
+        if (!command.empty()) {
+            summary = command;
+            type = "command";
+        } else if (!playlist.empty()) {
+            const bool isSequence = !isEmpty(entry["sequence"]);
+            type = isSequence ? "sequence" : "playlist";
+
+            summary = playlist;
+            if (isSequence && summary.size() >= 5) {
+                std::string ext = summary.substr(summary.size() - 5);
+                for (char& c : ext) {
+                    if (c >= 'A' && c <= 'Z') c = static_cast<char>(c + 32);
+                }
+                if (ext == ".fseq") {
+                    summary.resize(summary.size() - 5);
+                }
+            }
+        } else {
+            warnings.push_back("Skipped entry with no playlist, sequence, or command name");
+            return false;
+        }
+
+        /* ---------------- Date resolution ---------------- */
+
+        std::string startDate;
+        if (!resolveDate(str(entry["startDate"], ""), nullptr, warnings, "startDate", startDate)) {
+            warnings.push_back("Export: '" + summary + "' unable to resolve startDate; entry skipped.");
+            return false;
+        }
+
+        std::string endDate;
+        if (!resolveDate(str(entry["endDate"], ""), &startDate, warnings, "endDate", endDate)) {
+            warnings.push_back("Export: '" + summary + "' unable to resolve endDate; entry skipped.");
+            return false;
+        }
+
+        if (endDate < startDate) {
+            char buf[16];
+            std::snprintf(buf, sizeof(buf), "%04d", std::atoi(endDate.substr(0, 4).c_str()) + 1);
+            const std::string candidate = std::string(buf) + "-" + endDate.substr(endDate.size() >= 5 ? 5 : endDate.size());
+            warnings.push_back("Export: '" + summary + "' endDate adjusted across year boundary (" +
+                endDate + " → " + candidate + ").");
+            endDate = candidate;
+        }
+
+        int startDay = 0;
+        if (!ymdToDays(startDate, startDay)) {
+            warnings.push_back("Export: '" + summary + "' unable to resolve startDate; entry skipped.");
+            return false;
+        }
+
+        /* ---------------- DTSTART day-mask alignment ---------------- */
+
+        const int dayEnum = static_cast<int>(intval(entry["day"], 7));
+        const std::string byDay = (dayEnum != 7) ? byDayList(dayEnum) : std::string();
+        if (!byDay.empty()) {
+            const DayMask mask = dayMaskFromFppEnum(dayEnum);
+            if (!dayMaskHas(mask, weekdayFromDays(startDay))) {
+                for (int i = 1; i < 7; i++) {
+                    if (dayMaskHas(mask, weekdayFromDays(startDay + i))) {
+                        const std::string aligned = formatYmd(startDay + i);
+                        warnings.push_back("Export: '" + summary +
+                            "' startDate adjusted to first valid day-of-week (" +
+                            startDate + " → " + aligned + ").");
+                        startDate = aligned;
+                        startDay += i;
+                        break;
+                    }
+                }
+            }
+        }
+
+        /* ---------------- YAML (minimal, semantic) ---------------- */
+
+        ev.yaml.clear();
+
+        if (type != "playlist") {
+            addYaml(ev.yaml, "type", Json::Value(type));
+        }
+
+        if (!isEnabled(entry.isMember("enabled") ? entry["enabled"] : Json::Value(true))) {
+            addYaml(ev.yaml, "enabled", Json::Value(false));
+        }
+
+        if (type == "command") {
+            addYaml(ev.yaml, "command", Json::Value(command));
+
+            const Json::Value& args = entry["args"];
+            if ((args.isArray() || args.isObject()) && !args.empty()) {
+                std::string joined;
+                bool firstArg = true;
+                for (const Json::Value& a : args) {
+                    if (!firstArg) {
+                        joined += ',';
+                    }
+                    joined += str(a);
+                    firstArg = false;
+                }
+                addYaml(ev.yaml, "args", Json::Value(joined));
+            }
+
+            if (!isEmpty(entry["multisyncCommand"])) {
+                addYaml(ev.yaml, "multisync", Json::Value(true));
+                const std::string hosts = trim(str(entry["multisyncHosts"], ""));
+                if (!hosts.empty()) {
+                    addYaml(ev.yaml, "hosts", Json::Value(hosts));
+                }
+            }
+        }
+
+        const long long stopType = intval(entry["stopType"]);
+        if (stopType == 1) {
+            addYaml(ev.yaml, "stopType", Json::Value("hard"));
+        } else if (stopType == 2) {
+            addYaml(ev.yaml, "stopType", Json::Value("graceful_loop"));
+        }
+
+        // repeatToYaml(): ints never equal the string default
+        const long long repeat = intval(entry["repeat"]);
+        const std::string defaultRepeat = (type == "command") ? "none" : "immediate";
+        if (repeat >= 100) {
+            addYaml(ev.yaml, "repeat", Json::Value(Json::Int64(repeat / 100)));
+        } else {
+            const std::string r = (repeat == 1) ? "immediate" : "none";
+            if (r != defaultRepeat) {
+                addYaml(ev.yaml, "repeat", Json::Value(r));
+            }
+        }
+
+        /* ---------------- DTSTART ---------------- */
+
+        const std::string startTime = str(entry["startTime"], "00:00:00");
+
+        if (type == "command" && startTime == "00:00:00") {
+            warnings.push_back("Export: '" + summary + "' command startTime '00:00:00' is invalid; entry skipped.");
+            return false;
+        }
+
+        std::vector<YamlItem> startYaml;
+        if (!resolveTime(startDate, startTime, intval(entry["startTimeOffset"]),
+                         summary + " startTime", warnings, ev.start, &startYaml)) {
+            warnings.push_back("Export: '" + summary + "' invalid DTSTART; entry skipped.");
+            return false;
+        }
+
+        if (!startYaml.empty()) {
+            YamlItem start;
+            start.key = "start";
+            start.isMap = true;
+            start.children = startYaml;
+            ev.yaml.push_back(start);
+        }
+
+        const WallTime startWall = clock_.local(ev.start);
+
+        /* ---------------- DTEND ---------------- */
+
+        if (type == "command") {
+            // Commands are exported as 1-minute events for clean round-trip import
+            ev.end = ev.start + 60;
+        } else {
+            const std::string endTime = str(entry["endTime"], "");
+
+            if (endTime == "24:00:00") {
+                WallTime w = startWall;
+                w.day += 1;
+                w.hour = w.minute = w.second = 0;
+                ev.end = clock_.toEpoch(w, clock_.fppZone());
+            } else if (!resolveTime(formatYmd(daysFromCivil(startWall.year, startWall.month, startWall.day)),
+                                    endTime.empty() ? "00:00:00" : endTime,
+                                    intval(entry["endTimeOffset"]),
+                                    summary + " endTime", warnings, ev.end, nullptr)) {
+                warnings.push_back("Export: '" + summary + "' invalid DTEND; entry skipped.");
+                return false;
+            }
+
+            if (ev.end <= ev.start) {
+                WallTime w = clock_.local(ev.end);
+                w.day += 1;
+                ev.end = clock_.toEpoch(w, clock_.fppZone());
+            }
+        }
+
+        /* ---------------- RRULE ---------------- */
+
+        ev.rrule.clear();
+        if (startDate != endDate) {
+            int endDay = 0;
+            if (!ymdToDays(endDate, endDay)) {
+                warnings.push_back("Export: '" + summary + "' unable to resolve endDate; entry skipped.");
+                return false;
+            }
+
+            // Guard date is the single cap (matches FPP semantics)
+            const int guardDay = daysFromCivil(currentYear_ + 5, 12, 31);
+            if (endDay > guardDay) {
+                warnings.push_back("Export: '" + summary + "' endDate " + endDate +
+                    " clamped for Google compatibility.");
+                endDay = guardDay;
+            }
+
+            const CivilDate u = civilFromDays(endDay);
+            char until[24];
+            std::snprintf(until, sizeof(until), "%04d%02d%02dT235959", u.year, u.month, u.day);
+
+            ev.rrule = (dayEnum == 7 || byDay.empty())
+                ? std::string("FREQ=DAILY;UNTIL=") + until
+                : "FREQ=WEEKLY;BYDAY=" + byDay + ";UNTIL=" + until;
+        }
+
+        ev.summary = summary;
+        return true;
+    }
+
+private:
+    static void addYaml(std::vector<YamlItem>& yaml, const std::string& key, const Json::Value& value)
+    {
+        YamlItem item;
+        item.key = key;
+        item.value = value;
+        yaml.push_back(item);
+    }
+
+    /** HolidayResolver::dateFromHoliday(); HOLIDAY_UNRESOLVED if none */
+    int holiday(const std::string& name, int year) const
+    {
+        if (env_.hasHolidayDates) {
+            const int slot = year - env_.holidayStartYear;
+            if (slot >= 0 && slot < env_.holidayYears && env_.holidayDates.isMember(name)) {
+                int day = 0;
+                const Json::Value& ymd = env_.holidayDates[name][slot];
+                return (ymd.isString() && exporter::ymdToDays(ymd.asString(), day)) ? day : HOLIDAY_UNRESOLVED;
+            }
+        }
+
+        if (!env_.holidays.isMember(name)) {
+            return HOLIDAY_UNRESOLVED;
+        }
+        return resolveHoliday(env_.holidays[name], year);
+    }
+
+    /** FPPSemantics::resolveDate() */
+    bool resolveDate(
+        const std::string& rawIn,
+        const std::string* fallback,
+        std::vector<std::string>& warnings,
+        const std::string& context,
+        std::string& out) const
+    {
+        const std::string raw = exporter::trim(rawIn);
+
+        // Absolute date (year 0000 = "every year")
+        if (exporter::isYmd(raw)) {
+            if (raw.compare(0, 5, "0000-") == 0) {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "%04d", currentYear_);
+                out = std::string(buf) + raw.substr(4);
+            } else {
+                out = raw;
+            }
+            return true;
+        }
+
+        // Holiday (resolved via FPP locale)
+        if (!raw.empty()) {
+            int yearHint = fallback ? std::atoi(fallback->substr(0, 4).c_str()) : currentYear_;
+            int day = holiday(raw, yearHint);
+
+            // Standalone holiday far in the future: prefer last year's
+            if (!fallback && day != HOLIDAY_UNRESOLVED && day > todayDay_ + 180) {
+                const int alt = holiday(raw, yearHint - 1);
+                if (alt != HOLIDAY_UNRESOLVED) {
+                    day = alt;
+                }
+            }
+
+            // Range bound before its fallback: roll forward one year. The
+            // PHP fallback carries the current time of day, so a holiday
+            // on the fallback date itself also rolls.
+            int fbDay = 0;
+            if (fallback && day != HOLIDAY_UNRESOLVED && exporter::ymdToDays(*fallback, fbDay) &&
+                (day < fbDay || (day == fbDay && nowSecondOfDay_ > 0))) {
+                const int alt = holiday(raw, yearHint + 1);
+                if (alt != HOLIDAY_UNRESOLVED) {
+                    day = alt;
+                }
+            }
+
+            if (day != HOLIDAY_UNRESOLVED) {
+                out = formatYmd(day);
+                return true;
+            }
+        }
+
+        warnings.push_back("Export: " + context + " '" + raw + "' invalid.");
+        return false;
+    }
+
+    /** FPPSemantics::combineDateTime() */
+    bool combine(const std::string& ymd, const std::string& hms, time_t& out)
+    {
+        WallTime w;
+        if (!exporter::isYmd(ymd) || !exporter::isHms(hms) ||
+            std::sscanf(ymd.c_str(), "%d-%d-%d", &w.year, &w.month, &w.day) != 3 ||
+            std::sscanf(hms.c_str(), "%d:%d:%d", &w.hour, &w.minute, &w.second) != 3) {
+            return false;
+        }
+        out = clock_.toEpoch(w, clock_.fppZone());
+        return true;
+    }
+
+    /** SunTimeEstimator::formatSeconds() */
+    static std::string formatSunSeconds(long long baseSeconds, long long offsetMinutes)
+    {
+        long long seconds = baseSeconds + offsetMinutes * 60;
+        if (seconds < 0) {
+            seconds = 0;
+        }
+
+        const long long minutes = std::llround(static_cast<double>(seconds) / 60.0);
+        const long long rounded = std::llround(static_cast<double>(minutes) / EXPORT_ROUNDING_MINUTES) *
+            EXPORT_ROUNDING_MINUTES;
+
+        long long hours = rounded / 60;
+        long long mins = rounded % 60;
+        if (hours > 23) {
+            hours = 23;
+            mins = 59;
+        }
+
+        char buf[16];
+        std::snprintf(buf, sizeof(buf), "%02d:%02d:00", static_cast<int>(hours), static_cast<int>(mins));
+        return buf;
+    }
+
+    /** Unrounded base seconds of a symbolic time on date */
+    bool sunSeconds(const std::string& date, const std::string& symbolic, long long& out) const
+    {
+        int col = -1;
+        if (symbolic == "Dawn")    col = 0;
+        if (symbolic == "SunRise") col = 1;
+        if (symbolic == "SunSet")  col = 2;
+        if (symbolic == "Dusk")    col = 3;
+
+        int y = 0, m = 0, d = 0;
+        if (col < 0 || !exporter::isYmd(date) ||
+            std::sscanf(date.c_str(), "%d-%d-%d", &y, &m, &d) != 3) {
+            return false;
+        }
+
+        // Exported table first (FPPSemantics::lookupSunTable())
+        if (env_.hasSunTable) {
+            const long long idx = static_cast<long long>(daysFromCivil(y, m, d)) - env_.sunStartDay;
+            if (idx >= 0 && idx < static_cast<long long>(env_.sunTimes.size())) {
+                const Json::Value& cell = env_.sunTimes[static_cast<Json::ArrayIndex>(idx)][col];
+                if (cell.isInt()) {
+                    out = cell.asInt();
+                    return true;
+                }
+            }
+        }
+
+        // SunTimeEstimator::estimate(): the day of year at local noon,
+        // but the UTC offset of "now"
+        struct tm noon {};
+        noon.tm_year = y - 1900;
+        noon.tm_mon = m - 1;
+        noon.tm_mday = d;
+        noon.tm_hour = 12;
+        noon.tm_isdst = -1;
+        if (std::mktime(&noon) == static_cast<time_t>(-1)) {
+            return false;
+        }
+
+        const int dayOfYear = noon.tm_yday + 1;
+        const double lngHour = env_.longitude / 15.0;
+        const bool rise = (col == 0 || col == 1);
+        const double zenith = (col == 0 || col == 3) ? -6.0 : -0.833;
+
+        out = calcSolarTime(dayOfYear, env_.latitude, lngHour, rise, zenith, nowOffsetHours_);
+        return true;
+    }
+
+    /** ScheduleEntryExportAdapter::resolveTime() */
+    bool resolveTime(
+        const std::string& date,
+        const std::string& time,
+        long long offsetMinutes,
+        const std::string& context,
+        std::vector<std::string>& warnings,
+        time_t& out,
+        std::vector<YamlItem>* yaml)
+    {
+        if (exporter::isHms(time)) {
+            if (!combine(date, time, out)) {
+                warnings.push_back("Export: " + context + " unable to combine date/time '" +
+                    date + " " + time + "'.");
+                return false;
+            }
+            return true;
+        }
+
+        if (time == "Dawn" || time == "SunRise" || time == "SunSet" || time == "Dusk") {
+            long long base = 0;
+            std::string display;
+            if (env_.hasCoords && sunSeconds(date, time, base)) {
+                display = formatSunSeconds(base, offsetMinutes);
+            }
+
+            if (display.empty() || !combine(date, display, out)) {
+                warnings.push_back("Export: " + context + " unable to resolve symbolic time '" + time + "'.");
+                return false;
+            }
+
+            if (yaml != nullptr) {
+                yaml->clear();
+                addYaml(*yaml, "symbolic", Json::Value(time));
+                addYaml(*yaml, "offsetMinutes", Json::Value(Json::Int64(offsetMinutes)));
+                addYaml(*yaml, "displayTime", Json::Value(display));
+            }
+            return true;
+        }
+
+        warnings.push_back("Export: " + context + " unrecognized time format '" + time + "'.");
+        return false;
+    }
+
+    ZoneClock& clock_;
+    const ExportEnv& env_;
+    time_t now_;
+    int currentYear_ = 1970;
+    int todayDay_ = 0;
+    int nowSecondOfDay_ = 0;
+    double nowOffsetHours_ = 0.0;
+};
+
+/* =================================================================
+ * Calendar writer (IcsWriter::build())
+ * ================================================================= */
+
+namespace exporter {
+
+inline void emitYamlValue(std::vector<std::string>& lines, const YamlItem& item, int indent)
+{
+    const std::string pad(static_cast<size_t>(indent) * 2, ' ');
+
+    if (item.isMap) {
+        lines.push_back(pad + item.key + ":");
+        for (const YamlItem& c : item.children) {
+            emitYamlValue(lines, c, indent + 1);
+        }
+        return;
+    }
+
+    std::string value;
+    if (item.value.isBool()) {
+        value = item.value.asBool() ? "true" : "false";
+    } else if (item.value.isNumeric()) {
+        value = str(item.value);
+    } else if (item.value.isString()) {
+        value = trim(item.value.asString());
+    } else {
+        return;
+    }
+
+    lines.push_back(pad + item.key + ": " + value);
+}
+
+/** IcsWriter::emitYamlBlock() */
+inline std::string emitYamlBlock(const std::vector<YamlItem>& yaml)
+{
+    std::vector<std::string> lines;
+    lines.push_back("```yaml");
+
+    // Stable, human-friendly ordering
+    static const char* PREFERRED[] = { "stopType", "repeat", "start", "end" };
+    std::vector<bool> done(yaml.size(), false);
+    for (const char* k : PREFERRED) {
+        for (size_t i = 0; i < yaml.size(); i++) {
+            if (!done[i] && yaml[i].key == k) {
+                emitYamlValue(lines, yaml[i], 0);
+                done[i] = true;
+            }
+        }
+    }
+    for (size_t i = 0; i < yaml.size(); i++) {
+        if (!done[i]) {
+            emitYamlValue(lines, yaml[i], 0);
+        }
+    }
+
+    lines.push_back("```");
+
+    std::string out;
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (i > 0) {
+            out += '\n';
+        }
+        out += lines[i];
+    }
+    return out;
+}
+
+} // namespace exporter
+
+/**
+ * IcsWriter::buildVtimezone() for the process zone.
+ *
+ * Transitions come from sampling localtime_r() every few hours and
+ * bisecting each change to the second; the window is now - 1 year
+ * to now + 6 years as in PHP.
+ */
+inline std::vector<std::string> buildVtimezone(const std::string& zone, time_t now)
+{
+    struct ZoneState {
+        long offset = 0;
+        int isDst = 0;
+        std::string abbr;
+
+        bool operator!=(const ZoneState& o) const
+        {
+            return offset != o.offset || isDst != o.isDst || abbr != o.abbr;
+        }
+    };
+
+    const auto stateAt = [](time_t t) {
+        struct tm lt {};
+        ::localtime_r(&t, &lt);
+        ZoneState s;
+        s.offset = lt.tm_gmtoff;
+        s.isDst = lt.tm_isdst > 0 ? 1 : 0;
+        s.abbr = lt.tm_zone ? lt.tm_zone : "";
+        return s;
+    };
+
+    std::vector<std::string> lines;
+    lines.push_back("BEGIN:VTIMEZONE");
+    lines.push_back("TZID:" + zone);
+
+    const time_t minTs = now - 365L * 24 * 3600;
+    const time_t maxTs = now + 6L * 365 * 24 * 3600;
+    const time_t step = 6 * 3600;
+
+    time_t prevT = minTs - 1;
+    ZoneState prev = stateAt(prevT);
+
+    for (time_t t = minTs - 1 + step; prevT < maxTs; t += step) {
+        if (t > maxTs) {
+            t = maxTs;
+        }
+
+        const ZoneState cur = stateAt(t);
+        if (cur != prev) {
+            // First second of the new state in (prevT, t]
+            time_t lo = prevT;
+            time_t hi = t;
+            while (hi - lo > 1) {
+                const time_t mid = lo + (hi - lo) / 2;
+                if (stateAt(mid) != prev) {
+                    hi = mid;
+                } else {
+                    lo = mid;
+                }
+            }
+
+            const ZoneState next = stateAt(hi);
+            const std::string type = next.isDst ? "DAYLIGHT" : "STANDARD";
+            struct tm lt {};
+            ::localtime_r(&hi, &lt);
+            WallTime w;
+            w.year = lt.tm_year + 1900;
+            w.month = lt.tm_mon + 1;
+            w.day = lt.tm_mday;
+            w.hour = lt.tm_hour;
+            w.minute = lt.tm_min;
+            w.second = lt.tm_sec;
+
+            lines.push_back("BEGIN:" + type);
+            lines.push_back("DTSTART:" + exporter::icsStamp(w));
+            lines.push_back("TZOFFSETFROM:" + exporter::formatOffset(prev.offset));
+            lines.push_back("TZOFFSETTO:" + exporter::formatOffset(next.offset));
+            if (!next.abbr.empty()) {
+                lines.push_back("TZNAME:" + exporter::escapeText(next.abbr));
+            }
+            lines.push_back("END:" + type);
+
+            prev = next;
+            prevT = hi;
+            t = hi;
+            continue;
+        }
+
+        prevT = t;
+    }
+
+    lines.push_back("END:VTIMEZONE");
+    return lines;
+}
+
+class IcsCalendarWriter {
+public:
+    IcsCalendarWriter(IcsLineWriter& out, ZoneClock& clock, time_t now)
+        : out_(out), clock_(clock), tz_(clock.fppZone())
+    {
+        struct tm gm {};
+        ::gmtime_r(&now, &gm);
+        char buf[24];
+        std::strftime(buf, sizeof(buf), "%Y%m%dT%H%M%SZ", &gm);
+        dtstamp_ = buf;
+        now_ = now;
+    }
+
+    void begin()
+    {
+        out_.line("BEGIN:VCALENDAR");
+        out_.line("PRODID:-//GoogleCalendarScheduler//Scheduler Export//EN");
+        out_.line("VERSION:2.0");
+        out_.line("CALSCALE:GREGORIAN");
+        out_.line("METHOD:PUBLISH");
+        out_.line("X-WR-TIMEZONE:" + tz_);
+
+        for (const std::string& l : buildVtimezone(tz_, now_)) {
+            out_.line(l);
+        }
+    }
+
+    void event(const ExportEvent& ev)
+    {
+        using namespace exporter;
+
+        const std::string start = icsStamp(clock_.local(ev.start));
+        const std::string end = icsStamp(clock_.local(ev.end));
+        const std::string yamlText = ev.yaml.empty() ? std::string() : emitYamlBlock(ev.yaml);
+
+        out_.line("BEGIN:VEVENT");
+        out_.line("DTSTART;TZID=" + tz_ + ":" + start);
+        out_.line("DTEND;TZID=" + tz_ + ":" + end);
+
+        if (!ev.rrule.empty()) {
+            out_.line("RRULE:" + ev.rrule);
+        }
+
+        if (!ev.summary.empty()) {
+            out_.line("SUMMARY:" + escapeText(ev.summary));
+        }
+
+        if (!yamlText.empty()) {
+            out_.line("DESCRIPTION:" + escapeText(yamlText));
+        }
+
+        out_.line("DTSTAMP:" + dtstamp_);
+        out_.line("UID:" + uid(ev.summary, start, end, ev.rrule, yamlText));
+        out_.line("END:VEVENT");
+    }
+
+    void end()
+    {
+        out_.line("END:VCALENDAR");
+    }
+
+private:
+    /** IcsWriter::generateUid() */
+    std::string uid(
+        const std::string& summary,
+        const std::string& start,
+        const std::string& end,
+        const std::string& rrule,
+        const std::string& yamlText)
+    {
+        const std::string content = summary + "\n" + start + "\n" + end + "\n" + rrule + "\n" + yamlText;
+
+        Fnv1a64 h;
+        h.update(content.data(), content.size());
+        const std::string hex = h.hex();
+
+        const int n = ++seen_[hex];
+        return "gcs-export-" + hex + (n > 1 ? "-" + std::to_string(n) : std::string()) + "@local";
+    }
+
+    IcsLineWriter& out_;
+    ZoneClock& clock_;
+    std::string tz_;
+    std::string dtstamp_;
+    time_t now_ = 0;
+    std::map<std::string, int> seen_;
+};
+
+} // namespace gcs
@@ -0,0 +1,380 @@
+#pragma once
+
+// -----------------------------------------------------------------
+// IcsFetch (gcs-export fetch-ics)
+//
+// Conditional, compressed calendar download via libcurl.
+//
+// The last good response per URL is cached as two files in the cache
+// dir (<key> = FNV-1a of the URL, so several calendars can share it):
+//   ics-cache-<key>.ics   decoded body
+//   ics-cache-<key>.json  {"url", "etag", "lastModified", "bytes",
+//                          "digest"}
+// "digest" is the FNV-1a of the decoded body (hash('fnv1a64') in
+// PHP), computed while it streams; a 304 reports the cached one.
+// Requests for the same URL send If-None-Match / If-Modified-Since
+// from the metadata; a 304 leaves the cached body in place and is
+// reported as "not_modified". Bodies stream straight to disk through
+// AtomicFileWriter, so the previous cache survives a failed transfer.
+//
+// Content-Encoding is negotiated by libcurl (every encoding it was
+// built with: gzip/deflate, br, zstd). One easy handle is kept per
+// IcsHttpClient, so consecutive requests reuse the connection.
+//
+// SSL verification is disabled to match IcsFetcher.php.
+// -----------------------------------------------------------------
+
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <string>
+
+#include <strings.h>
+#include <unistd.h>
+
+#include <curl/curl.h>
+#include <jsoncpp/json/json.h>
+
+#include "AtomicFile.h"
+#include "Digest.h"
+#include "MappedFile.h"
+
+namespace gcs {
+
+/** Cache path prefix for url; append ".ics" / ".json" */
+inline std::string icsCacheBase(const std::string& cacheDir, const std::string& url)
+{
+    return cacheDir + "/ics-cache-" + Fnv1a64().add(url).hex();
+}
+
+/**
+ * url reduced to scheme://host for logs: calendar URLs carry their
+ * access token in the path or query (userinfo is dropped as well).
+ */
+inline std::string redactIcsUrl(const std::string& url)
+{
+    const size_t scheme = url.find("://");
+    if (scheme == std::string::npos) {
+        return "<url>";
+    }
+
+    size_t host = scheme + 3;
+    const size_t end = url.find_first_of("/?#", host);
+    const size_t at = url.rfind('@', end == std::string::npos ? url.size() : end);
+    if (at != std::string::npos && at >= host) {
+        host = at + 1;
+    }
+    return url.substr(0, scheme + 3) + url.substr(host, end == std::string::npos ? std::string::npos : end - host);
+}
+
+struct IcsCacheMeta {
+    std::string url;
+    std::string etag;
+    std::string lastModified;
+    long long bytes = 0;
+    std::string digest;
+};
+
+enum class FetchStatus { Fetched, NotModified, Failed };
+
+struct FetchResult {
+    FetchStatus status = FetchStatus::Failed;
+    long httpCode = 0;
+    long long bytes = 0;        // decoded body bytes (Fetched)
+    long long wireBytes = 0;    // bytes actually transferred
+    std::string etag;
+    std::string lastModified;
+    std::string digest;         // body content digest (Fetched / NotModified)
+    std::string error;
+};
+
+/**
+ * Receives the decoded body as it arrives; returning false aborts the
+ * transfer.
+ */
+typedef std::function<bool(const char*, size_t)> FetchSink;
+
+namespace fetch {
+
+inline std::string trimHeaderValue(const char* p, size_t n)
+{
+    size_t b = 0;
+    while (b < n && (p[b] == ' ' || p[b] == '\t')) b++;
+    while (n > b && (p[n - 1] == '\r' || p[n - 1] == '\n' || p[n - 1] == ' ' || p[n - 1] == '\t')) n--;
+    return std::string(p + b, n - b);
+}
+
+inline bool headerIs(const char* line, size_t n, const char* name)
+{
+    const size_t len = std::strlen(name);
+    return n > len && line[len] == ':' && ::strncasecmp(line, name, len) == 0;
+}
+
+struct TransferState {
+    FetchResult* result = nullptr;
+    const FetchSink* sink = nullptr;
+    bool sinkFailed = false;
+};
+
+inline size_t onHeader(char* buf, size_t size, size_t nitems, void* user)
+{
+    TransferState* st = static_cast<TransferState*>(user);
+    const size_t n = size * nitems;
+
+    // A new status line (redirect hop) resets the validators
+    if (n >= 5 && std::strncmp(buf, "HTTP/", 5) == 0) {
+        st->result->etag.clear();
+        st->result->lastModified.clear();
+    } else if (headerIs(buf, n, "ETag")) {
+        st->result->etag = trimHeaderValue(buf + 5, n - 5);
+    } else if (headerIs(buf, n, "Last-Modified")) {
+        st->result->lastModified = trimHeaderValue(buf + 14, n - 14);
+    }
+    return n;
+}
+
+inline size_t onBody(char* buf, size_t size, size_t nmemb, void* user)
+{
+    TransferState* st = static_cast<TransferState*>(user);
+    const size_t n = size * nmemb;
+
+    if (!(*st->sink)(buf, n)) {
+        st->sinkFailed = true;
+        return 0;
+    }
+    return n;
+}
+
+} // namespace fetch
+
+/* ===============================================================
+ * Cache metadata
+ * =============================================================== */
+
+inline bool readIcsCacheMeta(const std::string& path, IcsCacheMeta& out)
+{
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+
+    Json::Value v;
+    Json::CharReaderBuilder rb;
+    std::string errs;
+    if (!Json::parseFromStream(rb, in, &v, &errs) || !v.isObject()) {
+        return false;
+    }
+
+    out.url = v.get("url", "").asString();
+    out.etag = v.get("etag", "").asString();
+    out.lastModified = v.get("lastModified", "").asString();
+    out.bytes = v.get("bytes", 0).asInt64();
+    out.digest = v.get("digest", "").asString();
+    return true;
+}
+
+inline bool writeIcsCacheMeta(const std::string& path, const IcsCacheMeta& meta)
+{
+    Json::Value v(Json::objectValue);
+    v["url"] = meta.url;
+    v["etag"] = meta.etag;
+    v["lastModified"] = meta.lastModified;
+    v["bytes"] = Json::Int64(meta.bytes);
+    v["digest"] = meta.digest;
+
+    Json::StreamWriterBuilder wb;
+    wb["indentation"] = "";
+    return writeFileAtomic(path, Json::writeString(wb, v) + "\n");
+}
+
+/* ===============================================================
+ * HTTP client
+ * =============================================================== */
+
+class IcsHttpClient {
+public:
+    explicit IcsHttpClient(long timeoutSeconds)
+        : timeout_(timeoutSeconds)
+    {
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+        handle_ = curl_easy_init();
+    }
+
+    ~IcsHttpClient()
+    {
+        if (handle_) {
+            curl_easy_cleanup(handle_);
+        }
+        curl_global_cleanup();
+    }
+
+    IcsHttpClient(const IcsHttpClient&) = delete;
+    IcsHttpClient& operator=(const IcsHttpClient&) = delete;
+
+    /**
+     * GET url. When cond is given, the request is conditional on its
+     * validators. The sink only sees the body of a 200 response.
+     */
+    FetchResult get(const std::string& url, const IcsCacheMeta* cond, const FetchSink& sink)
+    {
+        FetchResult r;
+        if (!handle_) {
+            r.error = "curl_easy_init failed";
+            return r;
+        }
+
+        // Only a 200 body is delivered (redirect / error bodies are dropped)
+        bool is200 = false;
+        FetchSink gate = [&](const char* p, size_t n) -> bool {
+            if (!is200) {
+                long code = 0;
+                curl_easy_getinfo(handle_, CURLINFO_RESPONSE_CODE, &code);
+                if (code != 200) {
+                    return true;
+                }
+                is200 = true;
+            }
+            r.bytes += static_cast<long long>(n);
+            return sink(p, n);
+        };
+
+        fetch::TransferState st;
+        st.result = &r;
+        st.sink = &gate;
+
+        curl_slist* headers = nullptr;
+        if (cond) {
+            if (!cond->etag.empty()) {
+                headers = curl_slist_append(headers, ("If-None-Match: " + cond->etag).c_str());
+            }
+            if (!cond->lastModified.empty()) {
+                headers = curl_slist_append(headers, ("If-Modified-Since: " + cond->lastModified).c_str());
+            }
+        }
+
+        CURL* h = handle_;
+        curl_easy_reset(h);
+        curl_easy_setopt(h, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(h, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(h, CURLOPT_MAXREDIRS, 5L);
+        curl_easy_setopt(h, CURLOPT_TIMEOUT, timeout_);
+        curl_easy_setopt(h, CURLOPT_CONNECTTIMEOUT, timeout_);
+        curl_easy_setopt(h, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(h, CURLOPT_ACCEPT_ENCODING, "");
+        curl_easy_setopt(h, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(h, CURLOPT_SSL_VERIFYPEER, 0L);
+        curl_easy_setopt(h, CURLOPT_SSL_VERIFYHOST, 0L);
+        curl_easy_setopt(h, CURLOPT_USERAGENT, "GoogleCalendarScheduler/gcs-export");
+        curl_easy_setopt(h, CURLOPT_HTTPHEADER, headers);
+        curl_easy_setopt(h, CURLOPT_HEADERFUNCTION, fetch::onHeader);
+        curl_easy_setopt(h, CURLOPT_HEADERDATA, &st);
+        curl_easy_setopt(h, CURLOPT_WRITEFUNCTION, fetch::onBody);
+        curl_easy_setopt(h, CURLOPT_WRITEDATA, &st);
+
+        const CURLcode rc = curl_easy_perform(h);
+        curl_slist_free_all(headers);
+
+        curl_easy_getinfo(h, CURLINFO_RESPONSE_CODE, &r.httpCode);
+
+        curl_off_t wire = 0;
+        if (curl_easy_getinfo(h, CURLINFO_SIZE_DOWNLOAD_T, &wire) == CURLE_OK) {
+            r.wireBytes = static_cast<long long>(wire);
+        }
+
+        if (rc != CURLE_OK) {
+            r.error = st.sinkFailed ? "body write failed" : curl_easy_strerror(rc);
+            return r;
+        }
+
+        if (r.httpCode == 304 && cond) {
+            r.status = FetchStatus::NotModified;
+        } else if (r.httpCode == 200) {
+            r.status = FetchStatus::Fetched;
+        } else {
+            r.error = "HTTP " + std::to_string(r.httpCode);
+        }
+        return r;
+    }
+
+private:
+    CURL* handle_ = nullptr;
+    long timeout_;
+};
+
+/* ===============================================================
+ * Cached fetch
+ * =============================================================== */
+
+/**
+ * Refresh the ICS cache in cacheDir from url. sink (optional) also sees
+ * the body when it is downloaded.
+ */
+inline FetchResult fetchIcsCached(
+    IcsHttpClient& client,
+    const std::string& url,
+    const std::string& cacheDir,
+    const FetchSink& sink = FetchSink())
+{
+    const std::string bodyPath = icsCacheBase(cacheDir, url) + ".ics";
+    const std::string metaPath = icsCacheBase(cacheDir, url) + ".json";
+
+    IcsCacheMeta meta;
+    const bool haveCache = readIcsCacheMeta(metaPath, meta) &&
+        meta.url == url &&
+        (!meta.etag.empty() || !meta.lastModified.empty()) &&
+        ::access(bodyPath.c_str(), R_OK) == 0;
+
+    AtomicFileWriter body(bodyPath);
+    if (!body.isOpen()) {
+        FetchResult r;
+        r.error = "cannot write " + bodyPath;
+        return r;
+    }
+
+    Fnv1a64 digest;
+    FetchResult r = client.get(url, haveCache ? &meta : nullptr, [&](const char* p, size_t n) {
+        digest.update(p, n);
+        return body.write(p, n) && (!sink || sink(p, n));
+    });
+
+    if (r.status == FetchStatus::NotModified) {
+        r.etag = meta.etag;
+        r.lastModified = meta.lastModified;
+        r.bytes = meta.bytes;
+        r.digest = meta.digest;
+
+        // Metadata written before digests were recorded
+        MappedFile cached;
+        if (r.digest.empty() && cached.open(bodyPath)) {
+            r.digest = Fnv1a64().update(cached.data(), cached.size()).hex();
+            meta.digest = r.digest;
+            writeIcsCacheMeta(metaPath, meta);
+        }
+        return r;
+    }
+
+    if (r.status != FetchStatus::Fetched) {
+        return r;
+    }
+
+    if (!body.commit()) {
+        r.status = FetchStatus::Failed;
+        r.error = "cannot replace " + bodyPath;
+        return r;
+    }
+
+    r.digest = digest.hex();
+
+    IcsCacheMeta next;
+    next.url = url;
+    next.etag = r.etag;
+    next.lastModified = r.lastModified;
+    next.bytes = r.bytes;
+    next.digest = r.digest;
+
+    // A missing meta file only costs a full download next time
+    writeIcsCacheMeta(metaPath, next);
+    return r;
+}
+
+} // namespace gcs
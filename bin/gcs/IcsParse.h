@@ -0,0 +1,715 @@
+#pragma once
+
+// -----------------------------------------------------------------
+// IcsParse (gcs-export parse-ics)
+//
+// Native port of src/Core/IcsParser.php. Output is the same event
+// array shape IcsParser::parse() returns, so PHP can consume it as-is.
+//
+// Single pass, push style: feed() accepts arbitrary chunks (a whole
+// mmap'd file or network buffers), splits physical lines in place and
+// unfolds RFC5545 continuations into one reused buffer. Each VEVENT is
+// converted as soon as its END:VEVENT arrives.
+//
+// Compatibility notes (intentional, matches the PHP regexes):
+// - Properties are located by substring search over the raw VEVENT
+//   text, first match wins (e.g. "UID:" also matches "X-FOO-UID:")
+// - DESCRIPTION captures everything after "DESCRIPTION:" to the end
+//   of the VEVENT, trimmed, with literal "\n" turned into newlines
+// - A date-only value without VALUE=DATE takes the current
+//   time-of-day (PHP createFromFormat('Ymd') behavior)
+// - The first X-WR-TIMEZONE line anywhere applies to every event;
+//   events seen before it are held until it (or EOF) arrives
+//
+// Each event also carries its DESCRIPTION metadata, parsed as
+// YamlMetadata::parse() would (see YamlMeta.h), under "yaml"; PHP
+// skips its own YAML pass for such events. IcsParser.php does not
+// emit the field.
+//
+// Memory: with an event sink and a horizon set, nothing is kept per
+// calendar; only the VEVENT being assembled is buffered.
+//
+// Pruning runs on DTSTART / RECURRENCE-ID / DTEND / RRULE only, before
+// UID, SUMMARY, DESCRIPTION, EXDATE or the YAML metadata is decoded:
+// - Beyond the horizon: DTSTART after it; an override is kept while
+//   its RECURRENCE-ID is inside the horizon, since it still replaces
+//   an in-horizon instance
+// - Expired (needs now): a non-recurring event that ended before now,
+//   or a series whose UNTIL / COUNT bound ended a day before now (see
+//   seriesFinished(); IcsParser::isFinishedSeries() is the PHP twin)
+// -----------------------------------------------------------------
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <jsoncpp/json/json.h>
+
+#include "YamlMeta.h"
+#include "ZoneClock.h"
+
+namespace gcs {
+
+struct IcsEvent {
+    std::string uid;
+    std::string summary;
+    bool hasDescription = false;
+    std::string description;
+    YamlInterner::Ptr yaml;     // null = no metadata
+    std::string start;
+    std::string end;
+    time_t startEpoch = 0;
+    time_t endEpoch = 0;
+    bool isAllDay = false;
+    bool hasRrule = false;
+    std::vector<std::pair<std::string, std::string>> rrule;
+    std::vector<std::string> exDates;
+    bool hasRecurrenceId = false;
+    std::string recurrenceId;
+};
+
+namespace ics {
+
+inline bool isPhpTrimChar(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\0' || c == '\x0B';
+}
+
+inline std::string phpTrim(const char* p, size_t n)
+{
+    size_t b = 0;
+    while (b < n && isPhpTrimChar(p[b])) b++;
+    while (n > b && isPhpTrimChar(p[n - 1])) n--;
+    return std::string(p + b, n - b);
+}
+
+inline std::string phpTrim(const std::string& s)
+{
+    return phpTrim(s.data(), s.size());
+}
+
+inline bool allDigits(const std::string& s, size_t from, size_t n)
+{
+    if (from + n > s.size()) return false;
+    for (size_t i = from; i < from + n; i++) {
+        if (s[i] < '0' || s[i] > '9') return false;
+    }
+    return true;
+}
+
+inline int digitsAt(const std::string& s, size_t from, size_t n)
+{
+    int v = 0;
+    for (size_t i = from; i < from + n; i++) {
+        v = v * 10 + (s[i] - '0');
+    }
+    return v;
+}
+
+/**
+ * /KEY(.+)/ : rest of the line after the first occurrence of key
+ * that is followed by at least one character.
+ */
+inline bool findLineValue(const std::string& raw, const char* key, std::string& out)
+{
+    const size_t klen = std::strlen(key);
+    for (size_t p = raw.find(key); p != std::string::npos; p = raw.find(key, p + 1)) {
+        const size_t v = p + klen;
+        const size_t eol = raw.find('\n', v);
+        const size_t end = (eol == std::string::npos) ? raw.size() : eol;
+        if (end > v) {
+            out.assign(raw, v, end - v);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * /KEY([^:]*):(.+)/ : params between key and the next ':' and the
+ * rest of that line.
+ */
+inline bool findParamValue(const std::string& raw, const char* key, std::string& params, std::string& value)
+{
+    const size_t klen = std::strlen(key);
+    for (size_t p = raw.find(key); p != std::string::npos; p = raw.find(key, p + 1)) {
+        const size_t colon = raw.find(':', p + klen);
+        if (colon == std::string::npos) {
+            return false;
+        }
+        const size_t eol = raw.find('\n', colon + 1);
+        const size_t end = (eol == std::string::npos) ? raw.size() : eol;
+        if (end > colon + 1) {
+            params.assign(raw, p + klen, colon - p - klen);
+            value.assign(raw, colon + 1, end - colon - 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace ics
+
+/**
+ * Receives each accepted event as soon as its END:VEVENT is seen.
+ */
+typedef std::function<void(const IcsEvent&)> IcsEventSink;
+
+class IcsPushParser {
+public:
+    /**
+     * @param clock  Zone conversions; its FPP zone is the output zone
+     * @param now    Prune non-recurring events that ended before now
+     *               (hasNow=false disables, like IcsParser $now=null)
+     */
+    IcsPushParser(ZoneClock& clock, time_t now, bool hasNow)
+        : clock_(clock), now_(now), hasNow_(hasNow)
+    {
+    }
+
+    /** Deliver events to sink instead of collecting them in events() */
+    void setEventSink(IcsEventSink sink) { sink_ = std::move(sink); }
+
+    /** Drop events that start after horizonEnd (see header) */
+    void setHorizonEnd(time_t horizonEnd)
+    {
+        horizonEnd_ = horizonEnd;
+        hasHorizon_ = true;
+    }
+
+    /** Events dropped by setHorizonEnd() so far */
+    size_t droppedBeyondHorizon() const { return dropped_; }
+
+    /** Events and series dropped as ended before now so far */
+    size_t droppedExpired() const { return expired_; }
+
+    void feed(const char* data, size_t n)
+    {
+        size_t start = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (data[i] != '\n') {
+                continue;
+            }
+            if (!partial_.empty()) {
+                partial_.append(data + start, i - start);
+                physicalLine(partial_.data(), partial_.size());
+                partial_.clear();
+            } else {
+                physicalLine(data + start, i - start);
+            }
+            start = i + 1;
+        }
+        partial_.append(data + start, n - start);
+    }
+
+    void finish()
+    {
+        if (!partial_.empty()) {
+            physicalLine(partial_.data(), partial_.size());
+            partial_.clear();
+        }
+        if (hasCur_) {
+            logicalLine(cur_);
+            hasCur_ = false;
+        }
+
+        if (!tzKnown_) {
+            // No X-WR-TIMEZONE: fall back to the FPP zone
+            tzKnown_ = true;
+            tzDefaulted_ = true;
+            calendarTz_ = clock_.fppZone();
+            flushDeferred();
+        }
+    }
+
+    const std::vector<IcsEvent>& events() const { return events_; }
+
+    const std::string& calendarTz() const { return calendarTz_; }
+
+    bool calendarTzDefaulted() const { return tzDefaulted_; }
+
+private:
+    void physicalLine(const char* p, size_t n)
+    {
+        while (n > 0 && p[n - 1] == '\r') {
+            n--;
+        }
+        if (n == 0) {
+            return;
+        }
+
+        if (hasCur_ && (p[0] == ' ' || p[0] == '\t')) {
+            cur_.append(p + 1, n - 1);
+            return;
+        }
+
+        if (hasCur_) {
+            logicalLine(cur_);
+        }
+        cur_.assign(p, n);
+        hasCur_ = true;
+    }
+
+    void logicalLine(const std::string& line)
+    {
+        static const char TZ_KEY[] = "X-WR-TIMEZONE:";
+        static const size_t TZ_LEN = sizeof(TZ_KEY) - 1;
+
+        if (!tzKnown_ && line.size() > TZ_LEN && line.compare(0, TZ_LEN, TZ_KEY) == 0) {
+            const std::string tz = ics::phpTrim(line.data() + TZ_LEN, line.size() - TZ_LEN);
+            tzKnown_ = true;
+            tzDefaulted_ = !ZoneClock::isValidZone(tz);
+            calendarTz_ = tzDefaulted_ ? clock_.fppZone() : tz;
+            flushDeferred();
+        }
+
+        if (line == "BEGIN:VEVENT") {
+            inEvent_ = true;
+            raw_.clear();
+            return;
+        }
+
+        if (line == "END:VEVENT") {
+            inEvent_ = false;
+            if (tzKnown_) {
+                buildEvent(raw_);
+            } else {
+                deferred_.push_back(raw_);
+            }
+            return;
+        }
+
+        if (inEvent_) {
+            raw_ += line;
+            raw_ += '\n';
+        }
+    }
+
+    void flushDeferred()
+    {
+        for (const std::string& raw : deferred_) {
+            buildEvent(raw);
+        }
+        deferred_.clear();
+    }
+
+    void buildEvent(const std::string& raw)
+    {
+        IcsEvent ev;
+        std::string params, value;
+
+        bool hasStart = false, hasEnd = false;
+
+        if (ics::findParamValue(raw, "DTSTART", params, value)) {
+            hasStart = parseDate(value, params, ev.start, ev.startEpoch, ev.isAllDay);
+        }
+
+        time_t recurrenceEpoch = 0;
+        if (ics::findParamValue(raw, "RECURRENCE-ID", params, value)) {
+            bool allDay = false;
+            ev.hasRecurrenceId = parseDate(value, params, ev.recurrenceId, recurrenceEpoch, allDay);
+        }
+
+        if (hasHorizon_ && hasStart && ev.startEpoch > horizonEnd_ &&
+            (!ev.hasRecurrenceId || recurrenceEpoch > horizonEnd_)) {
+            dropped_++;
+            return;
+        }
+
+        if (ics::findParamValue(raw, "DTEND", params, value)) {
+            bool endAllDay = false;
+            hasEnd = parseDate(value, params, ev.end, ev.endEpoch, endAllDay);
+            ev.isAllDay = ev.isAllDay || endAllDay;
+        }
+
+        if (ics::findLineValue(raw, "RRULE:", value)) {
+            ev.hasRrule = true;
+            parseRrule(value, ev.rrule);
+        }
+
+        // Skip fully-expired events and finished series
+        if (hasNow_ && hasStart && hasEnd &&
+            (ev.rrule.empty() ? ev.endEpoch < now_ : seriesFinished(ev))) {
+            expired_++;
+            return;
+        }
+
+        if (ics::findLineValue(raw, "UID:", value)) {
+            ev.uid = ics::phpTrim(value);
+        }
+
+        // Minimal validity check (PHP truthiness: "0" is not a UID)
+        if (ev.uid.empty() || ev.uid == "0" || !hasStart || !hasEnd) {
+            return;
+        }
+
+        if (ics::findLineValue(raw, "SUMMARY:", value)) {
+            ev.summary = ics::phpTrim(value);
+        }
+
+        const size_t d = raw.find("DESCRIPTION:");
+        if (d != std::string::npos && d + 12 < raw.size()) {
+            ev.hasDescription = true;
+            ev.description = unescapeNewlines(ics::phpTrim(raw.data() + d + 12, raw.size() - d - 12));
+        }
+
+        parseExDates(raw, ev.exDates);
+
+        if (ev.hasDescription) {
+            ev.yaml = yaml_.lookup(ev.description);
+        }
+
+        if (sink_) {
+            sink_(ev);
+        } else {
+            events_.push_back(std::move(ev));
+        }
+    }
+
+    /**
+     * True when the series provably has no instance ending at or after
+     * now (IcsParser::isFinishedSeries()): the last start is bounded by
+     * UNTIL, or for a plain COUNT rule by COUNT periods of the longest
+     * gap FREQ allows. A day of slack covers zone interpretation; any
+     * rule that cannot be bounded is kept.
+     */
+    bool seriesFinished(const IcsEvent& ev) const
+    {
+        static const time_t DAY = 86400;
+
+        const time_t duration = std::max<time_t>(0, ev.endEpoch - ev.startEpoch);
+
+        if (const std::string* until = rrulePart(ev.rrule, "UNTIL")) {
+            time_t untilEpoch = 0;
+            if (parseUntil(*until, untilEpoch)) {
+                return untilEpoch + duration + DAY < now_;
+            }
+            return false;
+        }
+
+        const std::string* count = rrulePart(ev.rrule, "COUNT");
+        const std::string* freq = rrulePart(ev.rrule, "FREQ");
+        if (!count || !freq || count->empty() || count->size() > 6 ||
+            !ics::allDigits(*count, 0, count->size())) {
+            return false;
+        }
+
+        long interval = 1;
+        if (const std::string* iv = rrulePart(ev.rrule, "INTERVAL")) {
+            if (iv->empty() || iv->size() > 4 || !ics::allDigits(*iv, 0, iv->size())) {
+                return false;
+            }
+            interval = std::atol(iv->c_str());
+            if (interval < 1) {
+                return false;
+            }
+        }
+
+        bool byDay = false;
+        for (const auto& kv : ev.rrule) {
+            if (kv.first.compare(0, 2, "BY") != 0) {
+                continue;
+            }
+            if (kv.first != "BYDAY") {
+                return false;
+            }
+            byDay = true;
+        }
+
+        std::string f = *freq;
+        for (char& c : f) {
+            if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+        }
+
+        // Longest gap between two instances. BYDAY: at least one per
+        // week (DAILY / WEEKLY only). MONTHLY / YEARLY: exact only while
+        // every month has the DTSTART day.
+        time_t gap = 0;
+        if (byDay) {
+            if (f == "DAILY" || f == "WEEKLY") gap = 7 * DAY;
+        } else if (f == "DAILY") {
+            gap = DAY;
+        } else if (f == "WEEKLY") {
+            gap = 7 * DAY;
+        } else if (ics::digitsAt(ev.start, 8, 2) <= 28) {
+            if (f == "MONTHLY") gap = 31 * DAY;
+            else if (f == "YEARLY") gap = 366 * DAY;
+        }
+        if (gap == 0) {
+            return false;
+        }
+
+        // With BYDAY the first week may hold none of the instances
+        const time_t periods = std::atol(count->c_str()) + (byDay ? 1 : 0);
+        return ev.startEpoch + periods * interval * gap + duration + DAY < now_;
+    }
+
+    static const std::string* rrulePart(const std::vector<std::pair<std::string, std::string>>& rrule,
+                                        const char* key)
+    {
+        for (const auto& kv : rrule) {
+            if (kv.first == key) {
+                return &kv.second;
+            }
+        }
+        return nullptr;
+    }
+
+    /** UNTIL as SchedulerPlanner reads it: date = 23:59:59, floating = FPP zone */
+    bool parseUntil(const std::string& v, time_t& epoch) const
+    {
+        if (!ics::allDigits(v, 0, 8)) {
+            return false;
+        }
+
+        WallTime w;
+        w.year  = ics::digitsAt(v, 0, 4);
+        w.month = ics::digitsAt(v, 4, 2);
+        w.day   = ics::digitsAt(v, 6, 2);
+
+        if (v.size() == 8) {
+            w.hour = 23;
+            w.minute = 59;
+            w.second = 59;
+            epoch = clock_.toEpoch(w, clock_.fppZone());
+            return true;
+        }
+
+        if ((v.size() != 15 && !(v.size() == 16 && v[15] == 'Z')) ||
+            v[8] != 'T' || !ics::allDigits(v, 9, 6)) {
+            return false;
+        }
+
+        w.hour = ics::digitsAt(v, 9, 2);
+        w.minute = ics::digitsAt(v, 11, 2);
+        w.second = ics::digitsAt(v, 13, 2);
+        epoch = clock_.toEpoch(w, v.size() == 16 ? std::string("UTC") : clock_.fppZone());
+        return true;
+    }
+
+    static std::string unescapeNewlines(const std::string& s)
+    {
+        std::string out;
+        out.reserve(s.size());
+        for (size_t i = 0; i < s.size(); i++) {
+            if (s[i] == '\\' && i + 1 < s.size() && s[i + 1] == 'n') {
+                out += '\n';
+                i++;
+            } else {
+                out += s[i];
+            }
+        }
+        return out;
+    }
+
+    static void parseRrule(const std::string& raw, std::vector<std::pair<std::string, std::string>>& out)
+    {
+        const std::string s = ics::phpTrim(raw);
+        size_t start = 0;
+        while (start <= s.size()) {
+            size_t semi = s.find(';', start);
+            if (semi == std::string::npos) semi = s.size();
+
+            const std::string part = s.substr(start, semi - start);
+            const size_t eq = part.find('=');
+            if (eq != std::string::npos) {
+                std::string k = part.substr(0, eq);
+                for (char& c : k) {
+                    if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+                }
+                const std::string v = part.substr(eq + 1);
+
+                bool replaced = false;
+                for (auto& kv : out) {
+                    if (kv.first == k) {
+                        kv.second = v;
+                        replaced = true;
+                        break;
+                    }
+                }
+                if (!replaced) {
+                    out.emplace_back(k, v);
+                }
+            }
+            start = semi + 1;
+        }
+    }
+
+    /** preg_match_all('/EXDATE([^:]*):([^\r\n]+)/') */
+    void parseExDates(const std::string& raw, std::vector<std::string>& out)
+    {
+        size_t p = raw.find("EXDATE");
+        while (p != std::string::npos) {
+            const size_t colon = raw.find(':', p + 6);
+            if (colon == std::string::npos) {
+                return;
+            }
+            const size_t end = raw.find_first_of("\r\n", colon + 1);
+            const size_t stop = (end == std::string::npos) ? raw.size() : end;
+            if (stop == colon + 1) {
+                p = raw.find("EXDATE", p + 1);
+                continue;
+            }
+
+            const std::string params = raw.substr(p + 6, colon - p - 6);
+            const std::string list = ics::phpTrim(raw.data() + colon + 1, stop - colon - 1);
+
+            size_t s = 0;
+            while (s <= list.size()) {
+                size_t comma = list.find(',', s);
+                if (comma == std::string::npos) comma = list.size();
+
+                std::string formatted;
+                time_t epoch = 0;
+                bool allDay = false;
+                if (parseDate(list.substr(s, comma - s), params, formatted, epoch, allDay)) {
+                    out.push_back(formatted);
+                }
+                s = comma + 1;
+            }
+
+            p = raw.find("EXDATE", stop);
+        }
+    }
+
+    std::string extractTimezone(const std::string& params, const std::string& value) const
+    {
+        for (size_t p = params.find("TZID="); p != std::string::npos; p = params.find("TZID=", p + 1)) {
+            const size_t v = p + 5;
+            const size_t end = params.find_first_of(";:", v);
+            const size_t stop = (end == std::string::npos) ? params.size() : end;
+            if (stop > v) {
+                const std::string tz = params.substr(v, stop - v);
+                if (ZoneClock::isValidZone(tz)) {
+                    return tz;
+                }
+                break;
+            }
+        }
+
+        if (!value.empty() && value.back() == 'Z') {
+            return "UTC";
+        }
+
+        return calendarTz_;
+    }
+
+    /**
+     * IcsParser::parseDateWithTimezone(): FPP-zone "Y-m-d H:i:s".
+     */
+    bool parseDate(const std::string& value, const std::string& params,
+                   std::string& out, time_t& epoch, bool& isAllDay)
+    {
+        isAllDay = false;
+        const bool allDay = params.find("VALUE=DATE") != std::string::npos;
+        const std::string zone = extractTimezone(params, value);
+
+        if (!ics::allDigits(value, 0, 8)) {
+            return false;
+        }
+
+        WallTime w;
+        w.year  = ics::digitsAt(value, 0, 4);
+        w.month = ics::digitsAt(value, 4, 2);
+        w.day   = ics::digitsAt(value, 6, 2);
+
+        const bool hasTime = value.size() >= 15 && value[8] == 'T' && ics::allDigits(value, 9, 6);
+
+        if (hasTime && value.size() == 16 && value[15] == 'Z') {
+            w.hour = ics::digitsAt(value, 9, 2);
+            w.minute = ics::digitsAt(value, 11, 2);
+            w.second = ics::digitsAt(value, 13, 2);
+            epoch = clock_.toEpoch(w, "UTC");
+        } else if (hasTime && value.size() == 15) {
+            w.hour = ics::digitsAt(value, 9, 2);
+            w.minute = ics::digitsAt(value, 11, 2);
+            w.second = ics::digitsAt(value, 13, 2);
+            epoch = clock_.toEpoch(w, zone);
+        } else if (value.size() == 8) {
+            const WallTime nowWall = clock_.fromEpoch(std::time(nullptr), zone);
+            w.hour = nowWall.hour;
+            w.minute = nowWall.minute;
+            w.second = nowWall.second;
+            epoch = clock_.toEpoch(w, zone);
+        } else {
+            return false;
+        }
+
+        WallTime local = clock_.local(epoch);
+        if (allDay) {
+            local.hour = local.minute = local.second = 0;
+            epoch = clock_.toEpoch(local, clock_.fppZone());
+        }
+
+        out = ZoneClock::format(local);
+        isAllDay = allDay;
+        return true;
+    }
+
+    ZoneClock& clock_;
+    time_t now_;
+    bool hasNow_;
+
+    std::string partial_;
+    std::string cur_;
+    bool hasCur_ = false;
+
+    std::string raw_;
+    bool inEvent_ = false;
+
+    bool tzKnown_ = false;
+    bool tzDefaulted_ = false;
+    std::string calendarTz_;
+    std::vector<std::string> deferred_;
+
+    IcsEventSink sink_;
+    YamlInterner yaml_;
+    bool hasHorizon_ = false;
+    time_t horizonEnd_ = 0;
+    size_t dropped_ = 0;
+    size_t expired_ = 0;
+
+    std::vector<IcsEvent> events_;
+};
+
+/**
+ * One event in the IcsParser::parse() array shape.
+ */
+inline Json::Value icsEventToJson(const IcsEvent& ev)
+{
+    Json::Value o(Json::objectValue);
+    o["uid"] = ev.uid;
+    o["summary"] = ev.summary;
+    o["description"] = ev.hasDescription ? Json::Value(ev.description) : Json::Value();
+    o["yaml"] = ev.yaml ? *ev.yaml : Json::Value(Json::objectValue);
+    o["start"] = ev.start;
+    o["end"] = ev.end;
+    o["isAllDay"] = ev.isAllDay;
+
+    if (ev.hasRrule) {
+        Json::Value r(Json::objectValue);
+        for (const auto& kv : ev.rrule) {
+            r[kv.first] = kv.second;
+        }
+        o["rrule"] = r;
+    } else {
+        o["rrule"] = Json::nullValue;
+    }
+
+    Json::Value ex(Json::arrayValue);
+    for (const std::string& d : ev.exDates) {
+        ex.append(d);
+    }
+    o["exDates"] = ex;
+
+    o["recurrenceId"] = ev.hasRecurrenceId ? Json::Value(ev.recurrenceId) : Json::Value();
+    o["isOverride"] = ev.hasRecurrenceId;
+    return o;
+}
+
+} // namespace gcs
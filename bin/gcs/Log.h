@@ -0,0 +1,273 @@
+#pragma once
+
+// -----------------------------------------------------------------
+// Log
+//
+// Shared log stream with GcsLog.php: both sides append to the same
+// file, in the same line format, with the same rotation.
+//
+// Formats (GCS_LOG_FORMAT):
+//   text    [2026-01-31 18:00:00] WARN message {"ctx":...}
+//   ndjson  {"ts":"2026-01-31T18:00:00+00:00","level":"WARN",
+//            "src":"gcs-export","msg":"message","ctx":{...}}
+//
+// Settings come from the environment, which NativeEngine sets from the
+// plugin config (GCS_LOG_PATH, GCS_LOG_FORMAT, GCS_LOG_MAX_BYTES,
+// GCS_LOG_KEEP). Without GCS_LOG_PATH (watcher daemon, manual runs)
+// the plugin log with text format is used and every line is echoed to
+// stderr as "LEVEL: message".
+//
+// Lines are buffered and written with one append per flush (size
+// threshold, explicit flush(), or process exit). Before a write that
+// would take the file past maxBytes, it is rotated under flock:
+// log -> log.1 -> ... -> log.<keep>. A writer that was waiting for the
+// lock re-checks the path once it holds it and reopens if the file it
+// has open was rotated away meanwhile.
+//
+// fork(): flush first (WorkerPool / ExportWatcher do), or the child
+// inherits and repeats the parent's pending lines.
+// -----------------------------------------------------------------
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <jsoncpp/json/json.h>
+
+namespace gcs {
+
+static const char* DEFAULT_LOG_PATH = "/home/fpp/media/logs/google-calendar-scheduler.log";
+
+// Defaults match Config.php runtime.log
+static const long long DEFAULT_LOG_MAX_BYTES = 1048576;
+static const int DEFAULT_LOG_KEEP = 3;
+
+static const size_t LOG_FLUSH_BYTES = 16384;
+
+enum class LogLevel { Info, Warn, Error };
+
+inline const char* logLevelName(LogLevel level)
+{
+    switch (level) {
+        case LogLevel::Info: return "INFO";
+        case LogLevel::Warn: return "WARN";
+        default:             return "ERROR";
+    }
+}
+
+class LogWriter {
+public:
+    static LogWriter& instance()
+    {
+        static LogWriter writer;
+        return writer;
+    }
+
+    ~LogWriter() { flush(); }
+
+    LogWriter(const LogWriter&) = delete;
+    LogWriter& operator=(const LogWriter&) = delete;
+
+    void write(LogLevel level, const std::string& msg, const Json::Value& ctx = Json::Value())
+    {
+        if (echo_) {
+            std::cerr << logLevelName(level) << ": " << msg;
+            if (ctx.isObject() && !ctx.empty()) {
+                std::cerr << " " << compact(ctx);
+            }
+            std::cerr << "\n";
+        }
+
+        pending_ += formatLine(level, msg, ctx);
+        if (pending_.size() >= LOG_FLUSH_BYTES) {
+            flush();
+        }
+    }
+
+    /** Append pending lines (never fails loudly; a lost line is not fatal) */
+    void flush()
+    {
+        if (pending_.empty()) {
+            return;
+        }
+
+        int fd = openLocked();
+        if (fd < 0) {
+            pending_.clear();
+            return;
+        }
+
+        struct stat st {};
+        if (maxBytes_ > 0 && ::fstat(fd, &st) == 0 && st.st_size > 0 &&
+            st.st_size + static_cast<long long>(pending_.size()) > maxBytes_) {
+            rotate();
+            ::close(fd);    // releases the lock on the rotated file
+            fd = openLocked();
+            if (fd < 0) {
+                pending_.clear();
+                return;
+            }
+        }
+
+        const char* p = pending_.data();
+        size_t left = pending_.size();
+        while (left > 0) {
+            const ssize_t n = ::write(fd, p, left);
+            if (n <= 0) {
+                break;
+            }
+            p += n;
+            left -= static_cast<size_t>(n);
+        }
+
+        ::close(fd);
+        pending_.clear();
+    }
+
+private:
+    LogWriter()
+    {
+        const char* path = std::getenv("GCS_LOG_PATH");
+        echo_ = (path == nullptr || *path == '\0');
+        path_ = echo_ ? DEFAULT_LOG_PATH : path;
+
+        const char* format = std::getenv("GCS_LOG_FORMAT");
+        ndjson_ = (format != nullptr && std::string(format) == "ndjson");
+
+        const char* maxBytes = std::getenv("GCS_LOG_MAX_BYTES");
+        maxBytes_ = maxBytes ? std::atoll(maxBytes) : DEFAULT_LOG_MAX_BYTES;
+
+        const char* keep = std::getenv("GCS_LOG_KEEP");
+        keep_ = keep ? std::max(1, std::atoi(keep)) : DEFAULT_LOG_KEEP;
+    }
+
+    static std::string compact(const Json::Value& v)
+    {
+        Json::StreamWriterBuilder wb;
+        wb["indentation"] = "";
+        return Json::writeString(wb, v);
+    }
+
+    std::string formatLine(LogLevel level, const std::string& msg, const Json::Value& ctx) const
+    {
+        const std::time_t now = std::time(nullptr);
+        std::tm tm {};
+        ::localtime_r(&now, &tm);
+        char buf[32];
+
+        if (ndjson_) {
+            // date('c'): +hh:mm offset
+            std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S%z", &tm);
+            std::string ts = buf;
+            if (ts.size() >= 5) {
+                ts.insert(ts.size() - 2, ":");
+            }
+
+            // Assembled by hand: jsoncpp sorts keys, GcsLog.php keeps this order
+            std::string line = "{\"ts\":" + compact(ts) +
+                ",\"level\":\"" + logLevelName(level) + "\"" +
+                ",\"src\":\"gcs-export\"" +
+                ",\"msg\":" + compact(msg);
+            if (ctx.isObject() && !ctx.empty()) {
+                line += ",\"ctx\":" + compact(ctx);
+            }
+            return line + "}\n";
+        }
+
+        std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+        std::string line = std::string("[") + buf + "] " + logLevelName(level) + " " + msg;
+        if (ctx.isObject() && !ctx.empty()) {
+            line += " " + compact(ctx);
+        }
+        return line + "\n";
+    }
+
+    int openLog() const
+    {
+        return ::open(path_.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    }
+
+    /**
+     * Open and flock the current log file. Another writer may rotate it
+     * while we wait for the lock; the fd then points at log.1, so
+     * reopen until the locked inode is the one at path_.
+     */
+    int openLocked() const
+    {
+        for (int attempt = 0; attempt < 8; attempt++) {
+            const int fd = openLog();
+            if (fd < 0) {
+                return -1;
+            }
+            ::flock(fd, LOCK_EX);
+
+            struct stat held {};
+            struct stat cur {};
+            if (::fstat(fd, &held) != 0 || ::stat(path_.c_str(), &cur) != 0 ||
+                (held.st_dev == cur.st_dev && held.st_ino == cur.st_ino)) {
+                return fd;
+            }
+            ::close(fd);
+        }
+        return openLog();
+    }
+
+    void rotate() const
+    {
+        for (int i = keep_ - 1; i >= 1; i--) {
+            ::rename((path_ + "." + std::to_string(i)).c_str(),
+                     (path_ + "." + std::to_string(i + 1)).c_str());
+        }
+        ::rename(path_.c_str(), (path_ + ".1").c_str());
+    }
+
+    std::string path_;
+    bool ndjson_ = false;
+    bool echo_ = true;
+    long long maxBytes_ = DEFAULT_LOG_MAX_BYTES;
+    int keep_ = DEFAULT_LOG_KEEP;
+    std::string pending_;
+};
+
+/**
+ * One log line, built with <<:
+ *   gcs::LogLine(gcs::LogLevel::Warn) << "Unable to watch " << dir;
+ */
+class LogLine {
+public:
+    explicit LogLine(LogLevel level, Json::Value ctx = Json::Value())
+        : level_(level), ctx_(std::move(ctx))
+    {
+    }
+
+    ~LogLine() { LogWriter::instance().write(level_, os_.str(), ctx_); }
+
+    template <typename T>
+    LogLine& operator<<(const T& v)
+    {
+        os_ << v;
+        return *this;
+    }
+
+private:
+    LogLevel level_;
+    Json::Value ctx_;
+    std::ostringstream os_;
+};
+
+inline void flushLog()
+{
+    LogWriter::instance().flush();
+}
+
+} // namespace gcs
@@ -0,0 +1,155 @@
+#pragma once
+
+// -----------------------------------------------------------------
+// Metrics
+//
+// Stage timings for one gcs-export run, appended as a single line to
+// runtime/metrics.jsonl, the file GcsMetrics.php writes plan / apply
+// records into:
+//   {"ts","src":"gcs-export","scope","totalMs","peakKb",
+//    "stages":{"<stage>":{"calls","ms","peakKb"}},"counters":{...}}
+//
+// peakKb is the process's peak RSS (getrusage) here, and PHP's peak
+// heap on the PHP side.
+//
+// The file is rotated to metrics.jsonl.1 once it reaches
+// METRICS_ROTATE_BYTES, as on the PHP side.
+// -----------------------------------------------------------------
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <map>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <jsoncpp/json/json.h>
+
+namespace gcs {
+
+static const char* METRICS_FILE = "metrics.jsonl";
+
+static const long long METRICS_ROTATE_BYTES = 262144;
+
+class StageMetrics {
+public:
+    StageMetrics()
+        : runStart_(Clock::now())
+    {
+    }
+
+    void start(const std::string& stage)
+    {
+        open_[stage] = Clock::now();
+    }
+
+    void stop(const std::string& stage)
+    {
+        auto it = open_.find(stage);
+        if (it == open_.end()) {
+            return;
+        }
+
+        Stage& s = stages_[stage];
+        s.ms += msSince(it->second);
+        s.calls++;
+        s.peakKb = peakKb();
+        open_.erase(it);
+    }
+
+    void set(const std::string& name, const Json::Value& value)
+    {
+        counters_[name] = value;
+    }
+
+    /** Append this run to <dir>/metrics.jsonl (best-effort) */
+    void append(const std::string& dir, const std::string& scope) const
+    {
+        Json::Value stages(Json::objectValue);
+        for (const auto& kv : stages_) {
+            Json::Value s(Json::objectValue);
+            s["ms"] = round2(kv.second.ms);
+            s["calls"] = kv.second.calls;
+            s["peakKb"] = Json::Int64(kv.second.peakKb);
+            stages[kv.first] = s;
+        }
+
+        const std::time_t now = std::time(nullptr);
+        std::tm tm {};
+        ::localtime_r(&now, &tm);
+        char buf[32];
+        std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S%z", &tm);
+        std::string ts = buf;
+        if (ts.size() >= 5) {
+            ts.insert(ts.size() - 2, ":");
+        }
+
+        // Top-level order as in GcsMetrics.php (jsoncpp sorts keys)
+        const std::string line = "{\"ts\":" + compact(ts) +
+            ",\"src\":\"gcs-export\"" +
+            ",\"scope\":" + compact(scope) +
+            ",\"totalMs\":" + compact(round2(msSince(runStart_))) +
+            ",\"peakKb\":" + std::to_string(peakKb()) +
+            ",\"stages\":" + compact(stages) +
+            ",\"counters\":" + compact(counters_) + "}\n";
+
+        const std::string path = dir + "/" + METRICS_FILE;
+
+        struct stat st {};
+        if (::stat(path.c_str(), &st) == 0 && st.st_size >= METRICS_ROTATE_BYTES) {
+            ::rename(path.c_str(), (path + ".1").c_str());
+        }
+
+        const int fd = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return;
+        }
+        const ssize_t n = ::write(fd, line.data(), line.size());
+        (void)n;
+        ::close(fd);
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Stage {
+        double ms = 0.0;
+        int calls = 0;
+        long long peakKb = 0;
+    };
+
+    static double msSince(Clock::time_point t)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - t).count();
+    }
+
+    static double round2(double v)
+    {
+        return static_cast<double>(static_cast<long long>(v * 100.0 + 0.5)) / 100.0;
+    }
+
+    static long long peakKb()
+    {
+        struct rusage ru {};
+        return ::getrusage(RUSAGE_SELF, &ru) == 0 ? static_cast<long long>(ru.ru_maxrss) : 0;
+    }
+
+    static std::string compact(const Json::Value& v)
+    {
+        Json::StreamWriterBuilder wb;
+        wb["indentation"] = "";
+        wb["precision"] = 15;   // 11.11, not 11.109999999999999
+        return Json::writeString(wb, v);
+    }
+
+    Clock::time_point runStart_;
+    std::map<std::string, Clock::time_point> open_;
+    std::map<std::string, Stage> stages_;
+    Json::Value counters_ = Json::Value(Json::objectValue);
+};
+
+} // namespace gcs
@@ -0,0 +1,245 @@
+#pragma once
+
+// -----------------------------------------------------------------
+// RecordStream
+//
+// Compact, versioned binary output of the bulk native subcommands
+// (parse-ics, fetch-ics --parse, expand with --format=bin), decoded
+// record by record by src/Core/NativeRecords.php. Compact JSON stays
+// the default output and the debug format.
+//
+// Stream (all integers little-endian):
+//
+//   char[4] magic "GCSR", u16 version (RECORD_STREAM_VERSION),
+//   u16 kind (RECORD_KIND_*), then records of
+//   u8 type, u32 payload length, payload
+//
+// Strings are interned: each STRING record defines the next id
+// (0, 1, ...) and fields refer to it as u32 (STR_NONE = absent). The
+// table is scoped to one calendar and restarts after its META record,
+// so calendars written by separate processes concatenate.
+//
+// Records:
+//   STRING  raw bytes
+//   EVENT   one IcsParser::parse() event (icsEventToJson()):
+//           u32 uid, u32 summary, u32 description (STR_NONE = null),
+//           u32 yaml (compact JSON of the parsed metadata, interned
+//           per distinct block; STR_NONE = {}), u8 flags
+//           (EVENT_*), u32 rrule part count, u32 exDate count,
+//           rrule parts x (u32 key, u32 value) in key order,
+//           then the times: start, end, recurrenceId (EVENT_RECURRENCE
+//           only), exDates. A time is i64 wall seconds ("Y-m-d H:i:s"
+//           as seconds since 1970-01-01 00:00:00), or a u32 string id
+//           when EVENT_TEXT_TIMES is set (a value that does not
+//           round-trip through wall seconds)
+//   META    compact JSON object with the calendar's scalar fields
+//           (status, path, digest, calendarTz, ...); closes the
+//           calendar
+//   SERIES  expand result for one series: u32 n (SERIES_NULL = expand
+//           in PHP), n x i64 start, n x i64 end, n x u8 (OCC_OVERRIDE)
+//
+// Readers skip record types they do not know; a new field or layout
+// change bumps RECORD_STREAM_VERSION.
+// -----------------------------------------------------------------
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <jsoncpp/json/json.h>
+
+#include "ByteWriter.h"
+#include "IcsParse.h"
+#include "RruleExpand.h"
+
+namespace gcs {
+
+static const uint16_t RECORD_STREAM_VERSION = 1;
+
+static const uint16_t RECORD_KIND_CALENDARS = 1;
+static const uint16_t RECORD_KIND_SERIES    = 2;
+
+static const uint8_t RECORD_STRING = 1;
+static const uint8_t RECORD_EVENT  = 2;
+static const uint8_t RECORD_META   = 3;
+static const uint8_t RECORD_SERIES = 4;
+
+static const uint32_t STR_NONE    = 0xffffffffu;
+static const uint32_t SERIES_NULL = 0xffffffffu;
+
+static const uint8_t EVENT_ALL_DAY    = 1;
+static const uint8_t EVENT_RRULE      = 2;
+static const uint8_t EVENT_RECURRENCE = 4;
+static const uint8_t EVENT_TEXT_TIMES = 8;
+
+static const uint8_t OCC_OVERRIDE = 1;
+
+class RecordWriter {
+public:
+    explicit RecordWriter(std::ostream& out) : out_(out)
+    {
+        json_["indentation"] = "";
+        json_["emitUTF8"] = true;
+    }
+
+    /** Stream header; omitted by per-calendar workers (fetch-ics --jobs) */
+    void header(uint16_t kind)
+    {
+        ByteWriter w;
+        w.bytes("GCSR");
+        w.u16(RECORD_STREAM_VERSION);
+        w.u16(kind);
+        out_ << w.data();
+    }
+
+    void event(const IcsEvent& ev)
+    {
+        // jsoncpp objects are key-ordered; the last duplicate part wins
+        std::map<std::string, std::string> rrule;
+        if (ev.hasRrule) {
+            for (const auto& kv : ev.rrule) {
+                rrule[kv.first] = kv.second;
+            }
+        }
+
+        std::vector<const std::string*> times = { &ev.start, &ev.end };
+        if (ev.hasRecurrenceId) {
+            times.push_back(&ev.recurrenceId);
+        }
+        for (const std::string& d : ev.exDates) {
+            times.push_back(&d);
+        }
+
+        std::vector<WallSeconds> walls(times.size());
+        bool textTimes = false;
+        for (size_t i = 0; i < times.size() && !textTimes; i++) {
+            textTimes = !parseWall(*times[i], walls[i]) || formatWall(walls[i]) != *times[i];
+        }
+
+        uint8_t flags = 0;
+        if (ev.isAllDay) flags |= EVENT_ALL_DAY;
+        if (ev.hasRrule) flags |= EVENT_RRULE;
+        if (ev.hasRecurrenceId) flags |= EVENT_RECURRENCE;
+        if (textTimes) flags |= EVENT_TEXT_TIMES;
+
+        // Strings first: every id must be defined before its use
+        const uint32_t uid = intern(ev.uid);
+        const uint32_t summary = intern(ev.summary);
+        const uint32_t description = ev.hasDescription ? intern(ev.description) : STR_NONE;
+        const uint32_t yaml = yamlId(ev.yaml);
+
+        std::vector<uint32_t> parts;
+        for (const auto& kv : rrule) {
+            parts.push_back(intern(kv.first));
+            parts.push_back(intern(kv.second));
+        }
+
+        std::vector<uint32_t> textIds;
+        if (textTimes) {
+            for (const std::string* t : times) {
+                textIds.push_back(intern(*t));
+            }
+        }
+
+        body_.clear();
+        body_.u32(uid);
+        body_.u32(summary);
+        body_.u32(description);
+        body_.u32(yaml);
+        body_.u8(flags);
+        body_.u32(static_cast<uint32_t>(rrule.size()));
+        body_.u32(static_cast<uint32_t>(ev.exDates.size()));
+        for (uint32_t id : parts) {
+            body_.u32(id);
+        }
+        for (size_t i = 0; i < times.size(); i++) {
+            if (textTimes) {
+                body_.u32(textIds[i]);
+            } else {
+                body_.i64(walls[i]);
+            }
+        }
+        record(RECORD_EVENT, body_);
+    }
+
+    /** Close the current calendar */
+    void meta(const Json::Value& fields)
+    {
+        body_.clear();
+        body_.bytes(Json::writeString(json_, fields));
+        record(RECORD_META, body_);
+
+        strings_.clear();
+        yamls_.clear();
+    }
+
+    /** One expand series; null = the caller expands it */
+    void series(const std::vector<Occurrence>* occs)
+    {
+        body_.clear();
+        if (occs == nullptr) {
+            body_.u32(SERIES_NULL);
+        } else {
+            body_.u32(static_cast<uint32_t>(occs->size()));
+            for (const Occurrence& o : *occs) body_.i64(o.start);
+            for (const Occurrence& o : *occs) body_.i64(o.end);
+            for (const Occurrence& o : *occs) body_.u8(o.isOverride ? OCC_OVERRIDE : 0);
+        }
+        record(RECORD_SERIES, body_);
+    }
+
+    void flush() { out_.flush(); }
+
+private:
+    uint32_t intern(const std::string& s)
+    {
+        auto it = strings_.find(s);
+        if (it != strings_.end()) {
+            return it->second;
+        }
+
+        const uint32_t id = static_cast<uint32_t>(strings_.size());
+        strings_.emplace(s, id);
+
+        ByteWriter w;
+        w.bytes(s);
+        record(RECORD_STRING, w);
+        return id;
+    }
+
+    /** Parsed metadata is shared per YAML block, so is its string */
+    uint32_t yamlId(const YamlInterner::Ptr& yaml)
+    {
+        if (!yaml) {
+            return STR_NONE;
+        }
+
+        auto it = yamls_.find(yaml.get());
+        if (it != yamls_.end()) {
+            return it->second;
+        }
+
+        const uint32_t id = intern(Json::writeString(json_, *yaml));
+        yamls_.emplace(yaml.get(), id);
+        return id;
+    }
+
+    void record(uint8_t type, const ByteWriter& body)
+    {
+        ByteWriter h;
+        h.u8(type);
+        h.u32(static_cast<uint32_t>(body.size()));
+        out_ << h.data() << body.data();
+    }
+
+    std::ostream& out_;
+    Json::StreamWriterBuilder json_;
+    ByteWriter body_;
+    std::unordered_map<std::string, uint32_t> strings_;
+    std::unordered_map<const Json::Value*, uint32_t> yamls_;
+};
+
+} // namespace gcs
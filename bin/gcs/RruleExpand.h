@@ -0,0 +1,616 @@
+#pragma once
+
+// -----------------------------------------------------------------
+// RruleExpand (gcs-export expand)
+//
+// Native occurrence expansion for SchedulerRunner. Works entirely on
+// integer "wall seconds" (epochDay * 86400 + seconds-of-day, FPP local
+// time), so no per-candidate date objects are created.
+//
+// Supported RRULE parts: FREQ (DAILY, WEEKLY, MONTHLY, YEARLY),
+// INTERVAL, BYDAY (with ordinals for MONTHLY/YEARLY), BYMONTHDAY,
+// BYMONTH, WKST, UNTIL, COUNT. Anything else (BYSETPOS, BYWEEKNO,
+// BYYEARDAY, sub-daily BY* parts, other FREQs) marks the series as
+// unsupported and the caller falls back to the PHP expander.
+//
+// Semantics follow RFC 5545: COUNT numbers instances from DTSTART
+// (EXDATE'd and overridden instances still count), and an override
+// replaces its RECURRENCE-ID instance even when it moved outside the
+// horizon.
+// -----------------------------------------------------------------
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <jsoncpp/json/json.h>
+
+#include "CivilDate.h"
+#include "DayMask.h"
+#include "ZoneClock.h"
+
+namespace gcs {
+
+typedef int64_t WallSeconds;
+
+enum class RruleFreq { None, Daily, Weekly, Monthly, Yearly };
+
+struct RruleByDay {
+    int ordinal = 0;    // 0 = every matching weekday in the period
+    int dow = 0;        // 0 = Sunday .. 6 = Saturday
+};
+
+struct RruleSpec {
+    bool supported = true;
+    RruleFreq freq = RruleFreq::None;
+    int interval = 1;
+    int wkst = 1;       // RFC default: Monday
+    bool hasUntil = false;
+    WallSeconds until = 0;
+    bool hasCount = false;
+    int count = 0;
+    std::vector<RruleByDay> byDay;
+    DayMask byDayMask = DAYMASK_NONE;   // weekdays named in BYDAY, ordinals ignored
+    std::vector<int> byMonthDay;
+    std::vector<int> byMonth;
+};
+
+struct Occurrence {
+    WallSeconds start;
+    WallSeconds end;
+    bool isOverride;
+};
+
+/* ============================================================
+ * Wall time helpers
+ * ============================================================ */
+
+inline WallSeconds wallFromParts(int y, int m, int d, int hh, int mi, int ss)
+{
+    return static_cast<WallSeconds>(daysFromCivil(y, m, d)) * 86400 + hh * 3600 + mi * 60 + ss;
+}
+
+/** "Y-m-d H:i:s" (or "Y-m-d") */
+inline bool parseWall(const std::string& s, WallSeconds& out)
+{
+    int y = 0, m = 0, d = 0, hh = 0, mi = 0, ss = 0;
+    const int n = std::sscanf(s.c_str(), "%d-%d-%d %d:%d:%d", &y, &m, &d, &hh, &mi, &ss);
+    if (n != 3 && n != 6) {
+        return false;
+    }
+    out = wallFromParts(y, m, d, hh, mi, ss);
+    return true;
+}
+
+inline int wallDay(WallSeconds w)
+{
+    return static_cast<int>((w >= 0 ? w : w - 86399) / 86400);
+}
+
+inline std::string formatWall(WallSeconds w)
+{
+    const int day = wallDay(w);
+    const int sod = static_cast<int>(w - static_cast<WallSeconds>(day) * 86400);
+    const CivilDate c = civilFromDays(day);
+
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%04d-%02d-%02d %02d:%02d:%02d",
+        c.year, c.month, c.day, sod / 3600, (sod / 60) % 60, sod % 60);
+    return std::string(buf);
+}
+
+inline WallSeconds wallFromTime(const WallTime& t)
+{
+    return wallFromParts(t.year, t.month, t.day, t.hour, t.minute, t.second);
+}
+
+/* ============================================================
+ * RRULE parsing
+ * ============================================================ */
+
+namespace rrule {
+
+inline std::vector<std::string> splitList(const std::string& s)
+{
+    std::vector<std::string> out;
+    size_t start = 0;
+    while (start <= s.size()) {
+        size_t comma = s.find(',', start);
+        if (comma == std::string::npos) comma = s.size();
+        if (comma > start) out.push_back(s.substr(start, comma - start));
+        start = comma + 1;
+    }
+    return out;
+}
+
+inline int dowFromCode(const std::string& code)
+{
+    static const char* CODES[] = { "SU", "MO", "TU", "WE", "TH", "FR", "SA" };
+    for (int i = 0; i < 7; i++) {
+        if (code == CODES[i]) return i;
+    }
+    return -1;
+}
+
+inline std::string upper(std::string s)
+{
+    for (char& c : s) {
+        if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+    }
+    return s;
+}
+
+/** SchedulerRunner::parseRruleUntil() equivalent, as FPP wall time */
+inline bool parseUntil(const std::string& raw, ZoneClock& clock, WallSeconds& out)
+{
+    int y = 0, m = 0, d = 0, hh = 0, mi = 0, ss = 0;
+    char z = 0;
+
+    if (raw.size() == 8 && std::sscanf(raw.c_str(), "%4d%2d%2d", &y, &m, &d) == 3) {
+        out = wallFromParts(y, m, d, 23, 59, 59);
+        return true;
+    }
+
+    if (raw.size() == 16 &&
+        std::sscanf(raw.c_str(), "%4d%2d%2dT%2d%2d%2d%c", &y, &m, &d, &hh, &mi, &ss, &z) == 7 &&
+        z == 'Z') {
+        WallTime w;
+        w.year = y; w.month = m; w.day = d;
+        w.hour = hh; w.minute = mi; w.second = ss;
+        out = wallFromTime(clock.local(clock.toEpoch(w, "UTC")));
+        return true;
+    }
+
+    if (raw.size() == 15 &&
+        std::sscanf(raw.c_str(), "%4d%2d%2dT%2d%2d%2d", &y, &m, &d, &hh, &mi, &ss) == 6) {
+        out = wallFromParts(y, m, d, hh, mi, ss);
+        return true;
+    }
+
+    return false;
+}
+
+} // namespace rrule
+
+inline RruleSpec parseRrule(const Json::Value& r, ZoneClock& clock)
+{
+    RruleSpec spec;
+
+    for (const std::string& rawKey : r.getMemberNames()) {
+        const std::string key = rrule::upper(rawKey);
+        const std::string val = rrule::upper(r[rawKey].asString());
+
+        if (key == "FREQ") {
+            if (val == "DAILY")        spec.freq = RruleFreq::Daily;
+            else if (val == "WEEKLY")  spec.freq = RruleFreq::Weekly;
+            else if (val == "MONTHLY") spec.freq = RruleFreq::Monthly;
+            else if (val == "YEARLY")  spec.freq = RruleFreq::Yearly;
+            else spec.supported = false;
+        } else if (key == "INTERVAL") {
+            spec.interval = std::max(1, std::atoi(val.c_str()));
+        } else if (key == "WKST") {
+            const int d = rrule::dowFromCode(val);
+            if (d >= 0) spec.wkst = d;
+        } else if (key == "UNTIL") {
+            spec.hasUntil = rrule::parseUntil(val, clock, spec.until);
+        } else if (key == "COUNT") {
+            spec.hasCount = true;
+            spec.count = std::max(1, std::atoi(val.c_str()));
+        } else if (key == "BYDAY") {
+            for (const std::string& tok : rrule::splitList(val)) {
+                if (tok.size() < 2) {
+                    spec.supported = false;
+                    continue;
+                }
+                RruleByDay bd;
+                bd.dow = rrule::dowFromCode(tok.substr(tok.size() - 2));
+                bd.ordinal = (tok.size() > 2) ? std::atoi(tok.substr(0, tok.size() - 2).c_str()) : 0;
+                if (bd.dow < 0) {
+                    spec.supported = false;
+                    continue;
+                }
+                spec.byDay.push_back(bd);
+                spec.byDayMask |= dayMaskOf(bd.dow);
+            }
+        } else if (key == "BYMONTHDAY") {
+            for (const std::string& tok : rrule::splitList(val)) {
+                const int v = std::atoi(tok.c_str());
+                if (v == 0 || v < -31 || v > 31) spec.supported = false;
+                else spec.byMonthDay.push_back(v);
+            }
+        } else if (key == "BYMONTH") {
+            for (const std::string& tok : rrule::splitList(val)) {
+                const int v = std::atoi(tok.c_str());
+                if (v < 1 || v > 12) spec.supported = false;
+                else spec.byMonth.push_back(v);
+            }
+        } else {
+            // BYSETPOS, BYWEEKNO, BYYEARDAY, BYHOUR, ... not supported natively
+            spec.supported = false;
+        }
+    }
+
+    if (spec.freq == RruleFreq::None) {
+        spec.supported = false;
+    }
+
+    return spec;
+}
+
+/* ============================================================
+ * Candidate day generation
+ * ============================================================ */
+
+namespace rrule {
+
+inline bool inList(const std::vector<int>& list, int v)
+{
+    return std::find(list.begin(), list.end(), v) != list.end();
+}
+
+inline bool matchesMonthDay(const std::vector<int>& mdays, int y, int m, int d)
+{
+    const int dim = daysInMonth(y, m);
+    for (int md : mdays) {
+        if ((md > 0 && md == d) || (md < 0 && dim + 1 + md == d)) return true;
+    }
+    return false;
+}
+
+/** Weekday-rule days within [first, last] (a month or a year) */
+inline void byDayInRange(const std::vector<RruleByDay>& byDay, int first, int last, std::vector<int>& out)
+{
+    for (const RruleByDay& bd : byDay) {
+        const int firstMatch = first + ((bd.dow - weekdayFromDays(first)) % 7 + 7) % 7;
+        const int lastMatch  = last - ((weekdayFromDays(last) - bd.dow) % 7 + 7) % 7;
+
+        if (bd.ordinal == 0) {
+            for (int d = firstMatch; d <= last; d += 7) out.push_back(d);
+        } else if (bd.ordinal > 0) {
+            const int d = firstMatch + (bd.ordinal - 1) * 7;
+            if (d <= last) out.push_back(d);
+        } else {
+            const int d = lastMatch + (bd.ordinal + 1) * 7;
+            if (d >= first) out.push_back(d);
+        }
+    }
+}
+
+/** Days of one month selected by BYMONTHDAY/BYDAY (default: dtstart day) */
+inline void monthDays(const RruleSpec& spec, int y, int m, int dtstartMday, std::vector<int>& out)
+{
+    const int first = daysFromCivil(y, m, 1);
+    const int dim = daysInMonth(y, m);
+
+    if (!spec.byDay.empty()) {
+        std::vector<int> days;
+        byDayInRange(spec.byDay, first, first + dim - 1, days);
+        for (int d : days) {
+            if (spec.byMonthDay.empty() || matchesMonthDay(spec.byMonthDay, y, m, d - first + 1)) {
+                out.push_back(d);
+            }
+        }
+        return;
+    }
+
+    if (!spec.byMonthDay.empty()) {
+        for (int md : spec.byMonthDay) {
+            const int dom = (md > 0) ? md : dim + 1 + md;
+            if (dom >= 1 && dom <= dim) out.push_back(first + dom - 1);
+        }
+        return;
+    }
+
+    if (dtstartMday <= dim) {
+        out.push_back(first + dtstartMday - 1);
+    }
+}
+
+} // namespace rrule
+
+/**
+ * Candidate days of period k (sorted, unique).
+ */
+inline void periodDays(const RruleSpec& spec, const CivilDate& dt0, int day0, long long k, std::vector<int>& out)
+{
+    out.clear();
+
+    switch (spec.freq) {
+    case RruleFreq::Daily: {
+        const int d = day0 + static_cast<int>(k * spec.interval);
+        const CivilDate c = civilFromDays(d);
+        if (!spec.byMonth.empty() && !rrule::inList(spec.byMonth, c.month)) break;
+        if (!spec.byMonthDay.empty() && !rrule::matchesMonthDay(spec.byMonthDay, c.year, c.month, c.day)) break;
+        if (!spec.byDay.empty() && !dayMaskHas(spec.byDayMask, weekdayFromDays(d))) break;
+        out.push_back(d);
+        break;
+    }
+
+    case RruleFreq::Weekly: {
+        const int weekStart0 = day0 - ((weekdayFromDays(day0) - spec.wkst) % 7 + 7) % 7;
+        const int weekStart = weekStart0 + static_cast<int>(k * 7 * spec.interval);
+
+        if (spec.byDay.empty()) {
+            out.push_back(weekStart + ((weekdayFromDays(day0) - spec.wkst) % 7 + 7) % 7);
+        } else {
+            for (const RruleByDay& bd : spec.byDay) {
+                out.push_back(weekStart + ((bd.dow - spec.wkst) % 7 + 7) % 7);
+            }
+        }
+
+        if (!spec.byMonth.empty()) {
+            out.erase(std::remove_if(out.begin(), out.end(), [&](int d) {
+                return !rrule::inList(spec.byMonth, civilFromDays(d).month);
+            }), out.end());
+        }
+        break;
+    }
+
+    case RruleFreq::Monthly: {
+        const long long mi = (static_cast<long long>(dt0.year) * 12 + (dt0.month - 1)) + k * spec.interval;
+        const int y = static_cast<int>(mi / 12);
+        const int m = static_cast<int>(mi % 12) + 1;
+        if (!spec.byMonth.empty() && !rrule::inList(spec.byMonth, m)) break;
+        rrule::monthDays(spec, y, m, dt0.day, out);
+        break;
+    }
+
+    case RruleFreq::Yearly: {
+        const int y = dt0.year + static_cast<int>(k * spec.interval);
+
+        if (spec.byMonth.empty() && !spec.byDay.empty() && spec.byMonthDay.empty()) {
+            // Weekday ordinals within the whole year
+            rrule::byDayInRange(spec.byDay, daysFromCivil(y, 1, 1), daysFromCivil(y, 12, 31), out);
+            break;
+        }
+
+        std::vector<int> months = spec.byMonth;
+        if (months.empty()) {
+            if (!spec.byMonthDay.empty()) {
+                for (int m = 1; m <= 12; m++) months.push_back(m);
+            } else {
+                months.push_back(dt0.month);
+            }
+        }
+
+        for (int m : months) {
+            rrule::monthDays(spec, y, m, dt0.day, out);
+        }
+        break;
+    }
+
+    case RruleFreq::None:
+        break;
+    }
+
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+/**
+ * First period index worth generating when COUNT does not force
+ * counting from DTSTART.
+ */
+inline long long firstUsefulPeriod(const RruleSpec& spec, const CivilDate& dt0, int day0, int horizonDay)
+{
+    if (spec.hasCount || horizonDay <= day0) {
+        return 0;
+    }
+
+    long long k = 0;
+    switch (spec.freq) {
+    case RruleFreq::Daily:
+        k = (horizonDay - day0) / spec.interval;
+        break;
+    case RruleFreq::Weekly:
+        k = (horizonDay - day0) / (7LL * spec.interval);
+        break;
+    case RruleFreq::Monthly: {
+        const CivilDate h = civilFromDays(horizonDay);
+        k = ((h.year - dt0.year) * 12LL + (h.month - dt0.month)) / spec.interval;
+        break;
+    }
+    case RruleFreq::Yearly: {
+        const CivilDate h = civilFromDays(horizonDay);
+        k = (h.year - dt0.year) / spec.interval;
+        break;
+    }
+    case RruleFreq::None:
+        break;
+    }
+
+    return std::max(0LL, k - 1);
+}
+
+/* ============================================================
+ * Series expansion
+ * ============================================================ */
+
+inline bool periodStartsAfter(const RruleSpec& spec, const CivilDate& dt0, int day0, long long k, int limitDay)
+{
+    const CivilDate lim = civilFromDays(limitDay);
+
+    switch (spec.freq) {
+    case RruleFreq::Daily:
+        return day0 + k * spec.interval > limitDay;
+    case RruleFreq::Weekly:
+        return day0 + k * 7LL * spec.interval - 6 > limitDay;
+    case RruleFreq::Monthly:
+        return dt0.year * 12LL + (dt0.month - 1) + k * spec.interval >
+               lim.year * 12LL + (lim.month - 1);
+    case RruleFreq::Yearly:
+        return dt0.year + k * spec.interval > lim.year;
+    case RruleFreq::None:
+        break;
+    }
+    return true;
+}
+
+struct SeriesInput {
+    bool hasBase = false;
+    WallSeconds start = 0;
+    WallSeconds end = 0;
+    bool hasRrule = false;
+    Json::Value rrule;
+    std::vector<WallSeconds> exDates;        // sorted
+    std::unordered_set<WallSeconds> overrideKeys;
+    std::vector<Occurrence> overrides;       // override start/end (own times)
+};
+
+static const long long RRULE_MAX_PERIODS = 200000;
+
+/**
+ * Expand one series. Returns false when the RRULE needs the PHP
+ * fallback (unsupported parts).
+ */
+inline bool expandSeries(
+    const SeriesInput& in,
+    WallSeconds horizonStart,
+    WallSeconds horizonEnd,
+    ZoneClock& clock,
+    std::vector<Occurrence>& out)
+{
+    out.clear();
+
+    // Overrides first (their own start inside the horizon)
+    for (const Occurrence& ov : in.overrides) {
+        if (ov.start >= horizonStart && ov.start <= horizonEnd) {
+            out.push_back(ov);
+        }
+    }
+
+    if (!in.hasBase) {
+        return true;
+    }
+
+    // Duration is an instant difference (DST-aware), like PHP
+    auto toEpoch = [&clock](WallSeconds w) {
+        const int day = wallDay(w);
+        const int sod = static_cast<int>(w - static_cast<WallSeconds>(day) * 86400);
+        const CivilDate c = civilFromDays(day);
+        WallTime t;
+        t.year = c.year; t.month = c.month; t.day = c.day;
+        t.hour = sod / 3600; t.minute = (sod / 60) % 60; t.second = sod % 60;
+        return clock.toEpoch(t, clock.fppZone());
+    };
+
+    const time_t startEpoch = toEpoch(in.start);
+    const long long duration = std::max<long long>(0, toEpoch(in.end) - startEpoch);
+
+    auto endOf = [&](WallSeconds s) {
+        return wallFromTime(clock.local(toEpoch(s) + duration));
+    };
+
+    auto excluded = [&](WallSeconds s) {
+        return in.overrideKeys.count(s) > 0 ||
+               std::binary_search(in.exDates.begin(), in.exDates.end(), s);
+    };
+
+    if (!in.hasRrule) {
+        if (in.start >= horizonStart && in.start <= horizonEnd && in.overrideKeys.count(in.start) == 0) {
+            out.push_back({ in.start, endOf(in.start), false });
+        }
+        return true;
+    }
+
+    const RruleSpec spec = parseRrule(in.rrule, clock);
+    if (!spec.supported) {
+        return false;
+    }
+
+    const int day0 = wallDay(in.start);
+    const int sod0 = static_cast<int>(in.start - static_cast<WallSeconds>(day0) * 86400);
+    const CivilDate dt0 = civilFromDays(day0);
+
+    WallSeconds limit = horizonEnd;
+    if (spec.hasUntil && spec.until < limit) {
+        limit = spec.until;
+    }
+    const int limitDay = wallDay(limit);
+
+    int emittedCount = 0;
+    std::vector<int> days;
+
+    for (long long k = firstUsefulPeriod(spec, dt0, day0, wallDay(horizonStart));
+         k < RRULE_MAX_PERIODS; k++) {
+        periodDays(spec, dt0, day0, k, days);
+
+        bool pastLimit = false;
+        for (int d : days) {
+            const WallSeconds s = static_cast<WallSeconds>(d) * 86400 + sod0;
+            if (s < in.start) {
+                continue;
+            }
+            if (s > limit) {
+                pastLimit = true;
+                break;
+            }
+
+            if (spec.hasCount && ++emittedCount > spec.count) {
+                return true;
+            }
+
+            if (s >= horizonStart && !excluded(s)) {
+                out.push_back({ s, endOf(s), false });
+            }
+        }
+
+        if (pastLimit) {
+            break;
+        }
+
+        // Empty periods (e.g. BYMONTHDAY=31 in short months) are
+        // bounded by the calendar position of the period itself
+        if (days.empty() && periodStartsAfter(spec, dt0, day0, k, limitDay)) {
+            break;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Decode one "expand" request series (see gcs-export runExpand()).
+ */
+inline SeriesInput seriesFromJson(const Json::Value& v)
+{
+    SeriesInput in;
+
+    in.hasBase = v["start"].isString() && v["end"].isString() &&
+                 parseWall(v["start"].asString(), in.start) &&
+                 parseWall(v["end"].asString(), in.end);
+
+    // PHP empty(): null and {} both mean "not recurring"
+    in.hasRrule = v["rrule"].isObject() && !v["rrule"].empty();
+    if (in.hasRrule) {
+        in.rrule = v["rrule"];
+    }
+
+    for (const Json::Value& ex : v["exDates"]) {
+        WallSeconds w = 0;
+        if (ex.isString() && parseWall(ex.asString(), w)) {
+            in.exDates.push_back(w);
+        }
+    }
+    std::sort(in.exDates.begin(), in.exDates.end());
+
+    for (const Json::Value& ov : v["overrides"]) {
+        WallSeconds rid = 0, s = 0, e = 0;
+        if (ov["rid"].isString() && parseWall(ov["rid"].asString(), rid)) {
+            in.overrideKeys.insert(rid);
+        }
+        if (ov["start"].isString() && ov["end"].isString() &&
+            parseWall(ov["start"].asString(), s) &&
+            parseWall(ov["end"].asString(), e)) {
+            in.overrides.push_back({ s, e, true });
+        }
+    }
+
+    return in;
+}
+
+} // namespace gcs
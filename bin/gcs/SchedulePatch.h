@@ -0,0 +1,387 @@
+#pragma once
+
+// -----------------------------------------------------------------
+// SchedulePatch (gcs-export apply-schedule / restore-schedule)
+//
+// Minimal-rewrite update of FPP's schedule.json.
+//
+// The current file is mapped, validated with jsoncpp, and scanned
+// once for the byte span of every top-level array element. The new
+// file is then assembled from a patch: each output entry either keeps
+// an existing entry (its bytes are copied verbatim, leading whitespace
+// included) or is new JSON text. Non-object elements are dropped, as
+// SchedulerSync::readScheduleJsonStatic() drops them.
+//
+// Layout matches PHP's json_encode(JSON_PRETTY_PRINT) of the whole
+// list, so a file last written by the plugin round-trips byte for
+// byte when nothing changed.
+//
+// Backups are deltas rather than copies: a recipe that rebuilds the
+// previous file from the new one, where kept entries are references
+// ([offset, length] into the new file) and only replaced or removed
+// entries are stored as text:
+//   {"format": 1, "base", "baseBytes", "prev", "prevBytes",
+//    "pieces": [[offset, length] | "literal", ...]}
+// "base" / "prev" are FNV-1a digests of the new / previous file. A
+// delta only applies to the exact file it was written with, so deltas
+// restore newest first; an edit made outside the plugin ends the chain.
+// So that the newest backup survives such an edit, every apply also
+// keeps the file it replaced as "<path>.prev" (scheduleFullBackupPath()),
+// a hard link to the old inode rather than a copy; restore falls back
+// to it when the newest delta no longer matches.
+// -----------------------------------------------------------------
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include <jsoncpp/json/json.h>
+
+#include "AtomicFile.h"
+#include "Digest.h"
+#include "MappedFile.h"
+
+namespace gcs {
+
+struct ArrayElementSpan {
+    size_t wsStart = 0;     // just after '[' or ','
+    size_t valStart = 0;
+    size_t valEnd = 0;      // one past the value
+    bool object = false;
+};
+
+/** One output entry: keep existing entry #keep, or write json */
+struct SchedulePatchOp {
+    int keep = -1;
+    std::string json;
+};
+
+namespace sched {
+
+inline bool isJsonWs(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/** PHP trim() character set */
+inline bool isTrimWs(char c)
+{
+    return isJsonWs(c) || c == '\0' || c == '\x0B';
+}
+
+/** End of the (already validated) JSON value starting at i */
+inline size_t skipValue(const char* p, size_t n, size_t i)
+{
+    if (p[i] == '"' || p[i] == '{' || p[i] == '[') {
+        int depth = 0;
+        bool inString = false;
+        for (; i < n; i++) {
+            const char c = p[i];
+            if (inString) {
+                if (c == '\\') {
+                    i++;
+                } else if (c == '"') {
+                    inString = false;
+                    if (depth == 0) {
+                        return i + 1;
+                    }
+                }
+            } else if (c == '"') {
+                inString = true;
+            } else if (c == '{' || c == '[') {
+                depth++;
+            } else if (c == '}' || c == ']') {
+                if (--depth == 0) {
+                    return i + 1;
+                }
+            }
+        }
+        return n;
+    }
+
+    while (i < n && p[i] != ',' && p[i] != ']' && !isJsonWs(p[i])) {
+        i++;
+    }
+    return i;
+}
+
+/** Continuation lines of a pretty-printed entry, nested one level */
+inline std::string indentEntry(const std::string& json)
+{
+    std::string out;
+    out.reserve(json.size() + json.size() / 8);
+    for (char c : json) {
+        out += c;
+        if (c == '\n') {
+            out += "    ";
+        }
+    }
+    return out;
+}
+
+inline bool parseStrict(const char* b, const char* e, Json::Value& out, std::string& err)
+{
+    Json::CharReaderBuilder rb;
+    Json::CharReaderBuilder::strictMode(&rb.settings_);
+    std::unique_ptr<Json::CharReader> reader(rb.newCharReader());
+    return reader->parse(b, e, &out, &err);
+}
+
+} // namespace sched
+
+class SchedulePatch {
+public:
+    /**
+     * Map and scan path. An empty (or whitespace-only) file is an empty
+     * schedule, as in readScheduleJsonStatic().
+     */
+    bool load(const std::string& path, std::string& err)
+    {
+        path_ = path;
+        if (!file_.open(path)) {
+            err = "cannot read " + path;
+            return false;
+        }
+
+        const char* p = file_.data();
+        const size_t n = file_.size();
+
+        size_t b = 0, e = n;
+        while (b < e && sched::isTrimWs(p[b])) b++;
+        while (e > b && sched::isTrimWs(p[e - 1])) e--;
+        if (b == e) {
+            return true;
+        }
+
+        Json::Value root;
+        if (!sched::parseStrict(p + b, p + e, root, err) || !root.isArray()) {
+            err = "schedule.json is not a JSON array" + (err.empty() ? "" : ": " + err);
+            return false;
+        }
+
+        size_t i = b + 1;
+        for (;;) {
+            ArrayElementSpan s;
+            s.wsStart = i;
+            while (i < e && sched::isJsonWs(p[i])) i++;
+            if (i < e && p[i] == ']' && spans_.empty()) {
+                break;
+            }
+
+            s.valStart = i;
+            s.valEnd = sched::skipValue(p, e, i);
+            s.object = (p[i] == '{' || p[i] == '[');
+            spans_.push_back(s);
+
+            i = s.valEnd;
+            while (i < e && sched::isJsonWs(p[i])) i++;
+            if (i < e && p[i] == ',') {
+                i++;
+                continue;
+            }
+            break;
+        }
+
+        if (spans_.size() != root.size()) {
+            err = "schedule.json scan mismatch";
+            return false;
+        }
+
+        for (size_t k = 0; k < spans_.size(); k++) {
+            if (spans_[k].object) {
+                entrySpan_.push_back(k);
+            }
+        }
+        return true;
+    }
+
+    /** Entries as PHP sees them (objects only) */
+    size_t entryCount() const { return entrySpan_.size(); }
+
+    const char* data() const { return file_.data(); }
+    size_t size() const { return file_.size(); }
+
+    /**
+     * Assemble the patched file into out.
+     */
+    bool build(const std::vector<SchedulePatchOp>& ops, std::string& out, std::string& err)
+    {
+        keptAt_.assign(spans_.size(), -1);
+        out.clear();
+        out.reserve(file_.size() + 1024);
+
+        if (ops.empty()) {
+            out = "[]\n";
+            return true;
+        }
+
+        out += '[';
+        for (size_t k = 0; k < ops.size(); k++) {
+            if (k > 0) {
+                out += ',';
+            }
+
+            const SchedulePatchOp& op = ops[k];
+            if (op.keep >= 0) {
+                if (static_cast<size_t>(op.keep) >= entrySpan_.size() ||
+                    keptAt_[entrySpan_[op.keep]] >= 0) {
+                    err = "invalid keep index " + std::to_string(op.keep);
+                    return false;
+                }
+                const ArrayElementSpan& s = spans_[entrySpan_[op.keep]];
+                keptAt_[entrySpan_[op.keep]] = static_cast<long long>(out.size());
+                out.append(file_.data() + s.wsStart, s.valEnd - s.wsStart);
+                continue;
+            }
+
+            Json::Value v;
+            if (!sched::parseStrict(op.json.data(), op.json.data() + op.json.size(), v, err) ||
+                !v.isObject()) {
+                err = "entry #" + std::to_string(k) + " is not a JSON object";
+                return false;
+            }
+            out += "\n    ";
+            out += sched::indentEntry(op.json);
+        }
+        out += "\n]\n";
+        return true;
+    }
+
+    /**
+     * Delta that rebuilds the loaded file from the last build() output.
+     */
+    Json::Value deltaFrom(const std::string& built) const
+    {
+        Json::Value pieces(Json::arrayValue);
+        std::string literal;
+
+        auto flush = [&]() {
+            if (!literal.empty()) {
+                pieces.append(literal);
+                literal.clear();
+            }
+        };
+
+        const char* p = file_.data();
+        size_t pos = 0;
+        for (size_t k = 0; k < spans_.size(); k++) {
+            const ArrayElementSpan& s = spans_[k];
+            literal.append(p + pos, s.wsStart - pos);
+
+            if (keptAt_[k] >= 0) {
+                flush();
+                Json::Value ref(Json::arrayValue);
+                ref.append(Json::Int64(keptAt_[k]));
+                ref.append(Json::Int64(s.valEnd - s.wsStart));
+                pieces.append(ref);
+            } else {
+                literal.append(p + s.wsStart, s.valEnd - s.wsStart);
+            }
+            pos = s.valEnd;
+        }
+        literal.append(p + pos, file_.size() - pos);
+        flush();
+
+        Json::Value d(Json::objectValue);
+        d["format"] = 1;
+        d["base"] = Fnv1a64().update(built.data(), built.size()).hex();
+        d["baseBytes"] = Json::Int64(built.size());
+        d["prev"] = Fnv1a64().update(p, file_.size()).hex();
+        d["prevBytes"] = Json::Int64(file_.size());
+        d["pieces"] = pieces;
+        return d;
+    }
+
+private:
+    std::string path_;
+    MappedFile file_;
+    std::vector<ArrayElementSpan> spans_;
+    std::vector<size_t> entrySpan_;     // entry index -> span index
+    std::vector<long long> keptAt_;     // span index -> offset in build() output
+};
+
+/**
+ * Rebuild the file a delta was written against from current; false if
+ * current is not the delta's base.
+ */
+inline bool restoreFromDelta(const char* cur, size_t n, const Json::Value& delta, std::string& out, std::string& err)
+{
+    if (delta.get("format", 0).asInt() != 1 || !delta["pieces"].isArray()) {
+        err = "unsupported delta";
+        return false;
+    }
+    if (delta.get("baseBytes", -1).asInt64() != static_cast<long long>(n) ||
+        delta.get("base", "").asString() != Fnv1a64().update(cur, n).hex()) {
+        err = "schedule.json is not the file this delta was written against";
+        return false;
+    }
+
+    out.clear();
+    for (const Json::Value& piece : delta["pieces"]) {
+        if (piece.isString()) {
+            out += piece.asString();
+            continue;
+        }
+        if (!piece.isArray() || piece.size() != 2) {
+            err = "corrupt delta";
+            return false;
+        }
+        const long long off = piece[0].asInt64();
+        const long long len = piece[1].asInt64();
+        if (off < 0 || len < 0 || off + len > static_cast<long long>(n)) {
+            err = "corrupt delta";
+            return false;
+        }
+        out.append(cur + off, static_cast<size_t>(len));
+    }
+
+    if (Fnv1a64().update(out.data(), out.size()).hex() != delta.get("prev", "").asString()) {
+        err = "delta does not reproduce the previous file";
+        return false;
+    }
+    return true;
+}
+
+/** The file the newest apply replaced (hard link to its old inode) */
+inline std::string scheduleFullBackupPath(const std::string& path)
+{
+    return path + ".prev";
+}
+
+/**
+ * Delta backups of path are "<path>.delta-<stamp>[-n]"; returns the
+ * existing ones, oldest first.
+ */
+inline std::vector<std::string> listScheduleDeltas(const std::string& path)
+{
+    const std::string dir = dirnameOf(path);
+    const std::string prefix = path.substr(path.find_last_of('/') + 1) + ".delta-";
+
+    std::vector<std::string> names;
+    if (DIR* d = ::opendir(dir.c_str())) {
+        while (dirent* ent = ::readdir(d)) {
+            const std::string name = ent->d_name;
+            if (name.compare(0, prefix.size(), prefix) == 0 && name.find(".tmp.") == std::string::npos) {
+                names.push_back(dir + "/" + name);
+            }
+        }
+        ::closedir(d);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+/** Drop all but the newest keep delta backups of path */
+inline void rotateScheduleDeltas(const std::string& path, size_t keep)
+{
+    std::vector<std::string> names = listScheduleDeltas(path);
+    for (size_t i = 0; i + keep < names.size(); i++) {
+        ::unlink(names[i].c_str());
+    }
+}
+
+} // namespace gcs
@@ -0,0 +1,177 @@
+#pragma once
+
+// -----------------------------------------------------------------
+// SunTable
+//
+// Dense per-day table of Dawn / SunRise / SunSet / Dusk times,
+// computed once at export time from FPP Latitude/Longitude.
+//
+// The math is a direct port of src/Core/SunTimeEstimator.php
+// (NOAA simplified, civil twilight for Dawn/Dusk). Values are
+// UNROUNDED seconds since local midnight; offset + rounding stay
+// on the PHP side so the table never depends on schedule data.
+//
+// The only intentional difference from the PHP estimator: the UTC
+// offset is taken for each table date (DST-correct), not "now".
+// -----------------------------------------------------------------
+
+#include <cmath>
+#include <ctime>
+#include <string>
+
+#include <jsoncpp/json/json.h>
+
+#include "CivilDate.h"
+
+namespace gcs {
+
+static const int SUN_TABLE_DEFAULT_YEARS = 6;
+
+struct SunTimes {
+    int dawn    = 0;
+    int sunrise = 0;
+    int sunset  = 0;
+    int dusk    = 0;
+};
+
+inline double sunDeg2Rad(double d) { return d * M_PI / 180.0; }
+inline double sunRad2Deg(double r) { return r * 180.0 / M_PI; }
+
+inline int calcSolarTime(
+    int dayOfYear,
+    double lat,
+    double lngHour,
+    bool isRise,
+    double zenith,
+    double tzOffsetHours
+) {
+    // Approximate time
+    double t = dayOfYear + ((isRise ? 6 : 18) - lngHour) / 24;
+
+    // Sun's mean anomaly
+    double M = (0.9856 * t) - 3.289;
+
+    // Sun's true longitude
+    double L = M
+        + (1.916 * std::sin(sunDeg2Rad(M)))
+        + (0.020 * std::sin(sunDeg2Rad(2 * M)))
+        + 282.634;
+    L = std::fmod(L + 360, 360);
+
+    // Right ascension
+    double RA = sunRad2Deg(std::atan(0.91764 * std::tan(sunDeg2Rad(L))));
+    RA = std::fmod(RA + 360, 360);
+
+    double Lquadrant  = std::floor(L / 90) * 90;
+    double RAquadrant = std::floor(RA / 90) * 90;
+    RA = (RA + (Lquadrant - RAquadrant)) / 15;
+
+    // Declination
+    double sinDec = 0.39782 * std::sin(sunDeg2Rad(L));
+    double cosDec = std::cos(std::asin(sinDec));
+
+    // Local hour angle
+    double cosH =
+        (std::cos(sunDeg2Rad(90 + zenith)) - (sinDec * std::sin(sunDeg2Rad(lat))))
+        / (cosDec * std::cos(sunDeg2Rad(lat)));
+
+    // Polar day/night guard
+    if (cosH > 1 || cosH < -1) {
+        return isRise ? 6 * 3600 : 18 * 3600;
+    }
+
+    double H = isRise
+        ? 360 - sunRad2Deg(std::acos(cosH))
+        : sunRad2Deg(std::acos(cosH));
+    H /= 15;
+
+    // Local mean time
+    double T = H + RA - (0.06571 * t) - 6.622;
+
+    // Universal Time (UTC) -> local wall-clock time
+    double UT = std::fmod(T - lngHour + 24, 24);
+    double localTime = std::fmod(UT + tzOffsetHours + 24, 24);
+
+    return static_cast<int>(std::lround(localTime * 3600));
+}
+
+/**
+ * Sun times for one civil date.
+ *
+ * Uses the process time zone (TZ) for the local offset at noon,
+ * mirroring the "noon avoids DST edge cases" rule of the PHP side.
+ */
+inline SunTimes sunTimesForDate(const CivilDate& c, double lat, double lon)
+{
+    struct tm noon {};
+    noon.tm_year  = c.year - 1900;
+    noon.tm_mon   = c.month - 1;
+    noon.tm_mday  = c.day;
+    noon.tm_hour  = 12;
+    noon.tm_isdst = -1;
+    std::mktime(&noon);
+
+    const int dayOfYear = noon.tm_yday + 1;
+    const double tzOffsetHours = static_cast<double>(noon.tm_gmtoff) / 3600.0;
+    const double lngHour = lon / 15.0;
+
+    SunTimes s;
+    s.sunrise = calcSolarTime(dayOfYear, lat, lngHour, true,  -0.833, tzOffsetHours);
+    s.sunset  = calcSolarTime(dayOfYear, lat, lngHour, false, -0.833, tzOffsetHours);
+    s.dawn    = calcSolarTime(dayOfYear, lat, lngHour, true,  -6.0,   tzOffsetHours);
+    s.dusk    = calcSolarTime(dayOfYear, lat, lngHour, false, -6.0,   tzOffsetHours);
+    return s;
+}
+
+/**
+ * Build the fpp-env.json "sunTable" block.
+ *
+ * Shape:
+ *   startDate : first table date (YYYY-MM-DD, Jan 1 of startYear)
+ *   days      : number of rows
+ *   latitude / longitude / timezone : inputs (used for invalidation)
+ *   fields    : column order of each row
+ *   times     : [[dawn, sunrise, sunset, dusk], ...] one row per day
+ */
+inline Json::Value buildSunTable(
+    double lat,
+    double lon,
+    const std::string& tz,
+    int startYear,
+    int years
+) {
+    Json::Value table(Json::objectValue);
+
+    const int first = daysFromCivil(startYear, 1, 1);
+    const int last  = daysFromCivil(startYear + years, 1, 1);
+
+    table["startDate"] = formatYmd(first);
+    table["days"]      = last - first;
+    table["latitude"]  = lat;
+    table["longitude"] = lon;
+    table["timezone"]  = tz;
+
+    Json::Value fields(Json::arrayValue);
+    fields.append("dawn");
+    fields.append("sunrise");
+    fields.append("sunset");
+    fields.append("dusk");
+    table["fields"] = fields;
+
+    Json::Value times(Json::arrayValue);
+    for (int day = first; day < last; day++) {
+        SunTimes s = sunTimesForDate(civilFromDays(day), lat, lon);
+
+        Json::Value row(Json::arrayValue);
+        row.append(s.dawn);
+        row.append(s.sunrise);
+        row.append(s.sunset);
+        row.append(s.dusk);
+        times.append(row);
+    }
+    table["times"] = times;
+
+    return table;
+}
+
+} // namespace gcs
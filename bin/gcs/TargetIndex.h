@@ -0,0 +1,110 @@
+#pragma once
+
+// -----------------------------------------------------------------
+// TargetIndex
+//
+// One walk of the FPP playlist and sequence directories, exported so
+// TargetResolver.php can resolve event titles from memory instead of
+// stat()ing per series:
+//   {"stamp": "<playlistsMtime>:<sequencesMtime>",
+//    "playlists": [name, ...], "sequences": ["<name>.fseq", ...]}
+//
+// stamp uses the same format as TargetResolver::inventoryStamp()
+// ("-" for a missing directory); PHP ignores the index when the two
+// differ, i.e. when media changed after the export.
+//
+// Playlists are <name>.json files and <name>/ directories holding a
+// playlist.json, as in TargetResolver::playlistExists().
+// -----------------------------------------------------------------
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <jsoncpp/json/json.h>
+
+namespace gcs {
+
+enum class TargetKind : uint8_t {
+    Playlist = 1,
+    Sequence = 2,
+};
+
+namespace detail {
+
+inline std::string dirStamp(const std::string& dir)
+{
+    struct stat st {};
+    if (::stat(dir.c_str(), &st) != 0) {
+        return "-";
+    }
+    return std::to_string(static_cast<long long>(st.st_mtime));
+}
+
+inline bool isRegularFile(const std::string& path)
+{
+    struct stat st {};
+    return ::stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+}
+
+inline bool endsWith(const std::string& s, const std::string& suffix)
+{
+    return s.size() > suffix.size() &&
+        s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/** Entry names of dir (without "." and ".."), sorted */
+inline std::vector<std::string> listDir(const std::string& dir)
+{
+    std::vector<std::string> names;
+
+    DIR* d = ::opendir(dir.c_str());
+    if (d == nullptr) {
+        return names;
+    }
+    while (const struct dirent* e = ::readdir(d)) {
+        const std::string name = e->d_name;
+        if (name != "." && name != "..") {
+            names.push_back(name);
+        }
+    }
+    ::closedir(d);
+
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+} // namespace detail
+
+inline Json::Value buildTargetIndex(const std::string& playlistDir, const std::string& sequenceDir)
+{
+    Json::Value index(Json::objectValue);
+    index["stamp"] = detail::dirStamp(playlistDir) + ":" + detail::dirStamp(sequenceDir);
+
+    Json::Value playlists(Json::arrayValue);
+    for (const std::string& name : detail::listDir(playlistDir)) {
+        const std::string path = playlistDir + "/" + name;
+        if (detail::endsWith(name, ".json") && detail::isRegularFile(path)) {
+            playlists.append(name.substr(0, name.size() - 5));
+        } else if (detail::isRegularFile(path + "/playlist.json")) {
+            playlists.append(name);
+        }
+    }
+
+    Json::Value sequences(Json::arrayValue);
+    for (const std::string& name : detail::listDir(sequenceDir)) {
+        if (detail::endsWith(name, ".fseq") && detail::isRegularFile(sequenceDir + "/" + name)) {
+            sequences.append(name);
+        }
+    }
+
+    index["playlists"] = playlists;
+    index["sequences"] = sequences;
+    return index;
+}
+
+} // namespace gcs
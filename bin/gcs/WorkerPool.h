@@ -0,0 +1,98 @@
+#pragma once
+
+// -----------------------------------------------------------------
+// WorkerPool
+//
+// Runs independent jobs in forked children, a bounded number at a
+// time. Each child's stdout is redirected to its own file, so a job
+// simply writes its result with std::cout as a one-shot subcommand
+// would.
+//
+// Processes rather than threads: ZoneClock switches the process-wide
+// TZ for foreign-zone conversions, and libcurl/jsoncpp state stays
+// private to each job.
+// -----------------------------------------------------------------
+
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Log.h"
+
+namespace gcs {
+
+/**
+ * Run job(i) for every i in [0, outPaths.size()), at most maxParallel
+ * at once; job i's stdout goes to outPaths[i]. Returns each job's exit
+ * status (-1 when it could not be started or did not exit normally).
+ */
+inline std::vector<int> runForkedJobs(
+    const std::vector<std::string>& outPaths,
+    size_t maxParallel,
+    const std::function<int(size_t)>& job)
+{
+    const size_t n = outPaths.size();
+    std::vector<int> status(n, -1);
+    std::map<pid_t, size_t> running;
+
+    if (maxParallel < 1) {
+        maxParallel = 1;
+    }
+
+    // Anything still buffered would otherwise be written by every child
+    std::cout.flush();
+    std::cerr.flush();
+    flushLog();
+
+    auto reapOne = [&]() {
+        int ws = 0;
+        const pid_t pid = ::waitpid(-1, &ws, 0);
+        if (pid <= 0) {
+            return false;
+        }
+        auto it = running.find(pid);
+        if (it != running.end()) {
+            status[it->second] = WIFEXITED(ws) ? WEXITSTATUS(ws) : -1;
+            running.erase(it);
+        }
+        return true;
+    };
+
+    for (size_t i = 0; i < n; i++) {
+        while (running.size() >= maxParallel && reapOne()) {
+        }
+
+        const pid_t pid = ::fork();
+        if (pid < 0) {
+            continue;
+        }
+
+        if (pid == 0) {
+            int fd = ::open(outPaths[i].c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+            if (fd < 0 || ::dup2(fd, STDOUT_FILENO) < 0) {
+                ::_exit(1);
+            }
+            ::close(fd);
+
+            const int rc = job(i);
+            std::cout.flush();
+            flushLog();
+            ::_exit(rc);
+        }
+
+        running[pid] = i;
+    }
+
+    while (!running.empty() && reapOne()) {
+    }
+
+    return status;
+}
+
+} // namespace gcs
@@ -0,0 +1,322 @@
+#pragma once
+
+// -----------------------------------------------------------------
+// YamlMeta
+//
+// Native port of src/Core/YamlMetadata.php, run by IcsPushParser on
+// each DESCRIPTION so events arrive with their metadata already
+// parsed and normalized ("yaml" in the event JSON; {} when there is
+// none).
+//
+// Same limited subset and the same quirks as the PHP side:
+// - A fenced ```yaml block wins; otherwise the leading "key:" lines
+// - Flat scalars plus one level of nested maps by indentation
+// - Digit-only values become ints, true/false (any case) bools
+// - Keys PHP would turn into integer array keys are dropped
+// Nested maps come back with sorted keys (jsoncpp objects are
+// ordered); the PHP runner only ksort()s the top level.
+//
+// Recurring overrides usually repeat the base event's block, so
+// YamlInterner parses each distinct block once per parser.
+// -----------------------------------------------------------------
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <jsoncpp/json/json.h>
+
+namespace gcs {
+namespace yaml {
+
+/** PHP trim() character set */
+inline bool isTrimChar(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\0' || c == '\x0B';
+}
+
+/** PCRE \s */
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\x0B';
+}
+
+inline std::string trim(const std::string& s)
+{
+    size_t b = 0;
+    size_t e = s.size();
+    while (b < e && isTrimChar(s[b])) b++;
+    while (e > b && isTrimChar(s[e - 1])) e--;
+    return s.substr(b, e - b);
+}
+
+inline std::string rtrim(const std::string& s)
+{
+    size_t e = s.size();
+    while (e > 0 && isTrimChar(s[e - 1])) e--;
+    return s.substr(0, e);
+}
+
+inline std::string ltrim(const std::string& s)
+{
+    size_t b = 0;
+    while (b < s.size() && isTrimChar(s[b])) b++;
+    return s.substr(b);
+}
+
+/** Leading / trailing \s, as the fence regex's \s* consumes them */
+inline std::string stripSpaces(const std::string& s)
+{
+    size_t b = 0;
+    size_t e = s.size();
+    while (b < e && isSpace(s[b])) b++;
+    while (e > b && isSpace(s[e - 1])) e--;
+    return s.substr(b, e - b);
+}
+
+/** preg_split('/\r?\n/') */
+inline std::vector<std::string> splitLines(const std::string& s)
+{
+    std::vector<std::string> lines;
+    size_t start = 0;
+    for (size_t i = 0; i <= s.size(); i++) {
+        if (i == s.size() || s[i] == '\n') {
+            size_t end = i;
+            if (end > start && s[end - 1] == '\r') {
+                end--;
+            }
+            lines.push_back(s.substr(start, end - start));
+            start = i + 1;
+        }
+    }
+    return lines;
+}
+
+/** /^[A-Za-z0-9_]+\s*:/ */
+inline bool looksLikeKey(const std::string& s)
+{
+    size_t i = 0;
+    while (i < s.size() &&
+           ((s[i] >= 'A' && s[i] <= 'Z') || (s[i] >= 'a' && s[i] <= 'z') ||
+            (s[i] >= '0' && s[i] <= '9') || s[i] == '_')) {
+        i++;
+    }
+    if (i == 0) {
+        return false;
+    }
+    while (i < s.size() && isSpace(s[i])) i++;
+    return i < s.size() && s[i] == ':';
+}
+
+/** PHP stores canonical decimal integer strings as int array keys */
+inline bool isPhpIntKey(const std::string& k)
+{
+    const size_t neg = (!k.empty() && k[0] == '-') ? 1 : 0;
+    const size_t digits = k.size() - neg;
+    if (digits == 0 || digits > 19) {
+        return false;
+    }
+    if (k[neg] == '0' && (digits > 1 || neg)) {
+        return false;
+    }
+    for (size_t i = neg; i < k.size(); i++) {
+        if (k[i] < '0' || k[i] > '9') return false;
+    }
+    if (digits == 19) {
+        return k.compare(neg, 19, neg ? "9223372036854775808" : "9223372036854775807") <= 0;
+    }
+    return true;
+}
+
+/**
+ * YamlMetadata::extractYamlBlock(); text is the trimmed description.
+ * False when there is no block.
+ */
+inline bool extractBlock(const std::string& text, std::string& out)
+{
+    // Case 1: fenced ```yaml block (/```yaml\s*(.*?)\s*```/is)
+    for (size_t p = text.find("```"); p != std::string::npos; p = text.find("```", p + 1)) {
+        if (p + 7 > text.size()) {
+            break;
+        }
+        bool tag = true;
+        for (size_t i = 0; i < 4; i++) {
+            if ((text[p + 3 + i] | 0x20) != "yaml"[i]) {
+                tag = false;
+                break;
+            }
+        }
+        if (!tag) {
+            continue;
+        }
+
+        const size_t close = text.find("```", p + 7);
+        if (close == std::string::npos) {
+            break;
+        }
+        out = trim(stripSpaces(text.substr(p + 7, close - p - 7)));
+        return !out.empty();
+    }
+
+    // Case 2: raw YAML-like lines at top
+    std::string joined;
+    bool any = false;
+    for (const std::string& raw : splitLines(text)) {
+        const std::string line = rtrim(raw);
+        if (line.empty()) {
+            if (any) {
+                break;
+            }
+            continue;
+        }
+        if (!looksLikeKey(ltrim(line))) {
+            break;
+        }
+        if (any) {
+            joined += '\n';
+        }
+        joined += line;
+        any = true;
+    }
+
+    out = joined;
+    return any;
+}
+
+/** YamlMetadata::normalizeScalar() (value already trimmed) */
+inline Json::Value scalar(const std::string& v)
+{
+    if (v.empty()) {
+        return Json::Value("");
+    }
+
+    bool digits = true;
+    for (char c : v) {
+        if (c < '0' || c > '9') {
+            digits = false;
+            break;
+        }
+    }
+    if (digits) {
+        // (int) saturates at PHP_INT_MAX
+        size_t i = 0;
+        while (i + 1 < v.size() && v[i] == '0') i++;
+        const std::string d = v.substr(i);
+        if (d.size() > 19 || (d.size() == 19 && d > "9223372036854775807")) {
+            return Json::Value(Json::Int64(INT64_MAX));
+        }
+        return Json::Value(Json::Int64(std::stoll(d)));
+    }
+
+    std::string lv = v;
+    for (char& c : lv) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c + 32);
+    }
+    if (lv == "true") {
+        return Json::Value(true);
+    }
+    if (lv == "false") {
+        return Json::Value(false);
+    }
+    return Json::Value(v);
+}
+
+/**
+ * YamlMetadata::parseYamlBlock() + normalize(); {} when nothing
+ * usable was found.
+ */
+inline Json::Value parseBlock(const std::string& block)
+{
+    Json::Value out(Json::objectValue);
+    std::string parent;
+    bool hasParent = false;
+
+    for (const std::string& raw : splitLines(block)) {
+        const std::string line = rtrim(raw);
+        const std::string trimmed = ltrim(line);
+        if (line.empty() || trimmed[0] == '#') {
+            continue;
+        }
+
+        size_t indent = 0;
+        while (indent < line.size() && isSpace(line[indent])) indent++;
+
+        const size_t colon = trimmed.find(':');
+        if (indent > 0 && !hasParent) {
+            continue;
+        }
+        if (indent == 0) {
+            hasParent = false;
+        }
+        if (colon == std::string::npos) {
+            continue;
+        }
+
+        const std::string key = trim(trimmed.substr(0, colon));
+        const std::string value = trim(trimmed.substr(colon + 1));
+        if (key.empty()) {
+            continue;
+        }
+
+        if (indent > 0) {
+            if (!isPhpIntKey(parent) && !isPhpIntKey(key)) {
+                out[parent][key] = scalar(value);
+            }
+            continue;
+        }
+
+        if (value.empty()) {
+            // Parent map (e.g. "start:")
+            parent = key;
+            hasParent = true;
+            if (!isPhpIntKey(key)) {
+                out[key] = Json::Value(Json::objectValue);
+            }
+            continue;
+        }
+
+        if (!isPhpIntKey(key)) {
+            out[key] = scalar(value);
+        }
+    }
+
+    return out;
+}
+
+} // namespace yaml
+
+/**
+ * Parsed metadata per distinct YAML block.
+ */
+class YamlInterner {
+public:
+    typedef std::shared_ptr<const Json::Value> Ptr;
+
+    /** Metadata for a DESCRIPTION value (null = no usable metadata) */
+    Ptr lookup(const std::string& description)
+    {
+        std::string block;
+        if (!yaml::extractBlock(yaml::trim(description), block)) {
+            return nullptr;
+        }
+
+        auto it = blocks_.find(block);
+        if (it != blocks_.end()) {
+            return it->second;
+        }
+
+        Json::Value parsed = yaml::parseBlock(block);
+        Ptr p = parsed.empty() ? nullptr : std::make_shared<const Json::Value>(std::move(parsed));
+        blocks_.emplace(std::move(block), p);
+        return p;
+    }
+
+    size_t size() const { return blocks_.size(); }
+
+private:
+    std::unordered_map<std::string, Ptr> blocks_;
+};
+
+} // namespace gcs
@@ -0,0 +1,132 @@
+#pragma once
+
+// -----------------------------------------------------------------
+// ZoneClock
+//
+// Wall-clock <-> epoch conversion between named IANA zones using the
+// C library (TZ + mktime/localtime_r).
+//
+// The process TZ is kept on the FPP zone; a foreign zone is only
+// switched in for the duration of a single conversion. glibc reloads
+// zone data whenever TZ changes, so callers should expect foreign
+// zones to be the exception (Google calendars normally use the same
+// zone as the FPP host, or UTC which needs no switch at all).
+// -----------------------------------------------------------------
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+
+#include <unistd.h>
+
+namespace gcs {
+
+struct WallTime {
+    int year = 1970, month = 1, day = 1;
+    int hour = 0, minute = 0, second = 0;
+};
+
+class ZoneClock {
+public:
+    explicit ZoneClock(const std::string& fppZone) : fppZone_(fppZone)
+    {
+        apply(fppZone_);
+    }
+
+    const std::string& fppZone() const { return fppZone_; }
+
+    /**
+     * True if the zone resolves to tz data (PHP DateTimeZone would
+     * accept it). UTC is always valid.
+     */
+    static bool isValidZone(const std::string& zone)
+    {
+        if (zone.empty() || zone.find("..") != std::string::npos || zone[0] == '/') {
+            return false;
+        }
+        if (zone == "UTC") {
+            return true;
+        }
+        const std::string path = "/usr/share/zoneinfo/" + zone;
+        return ::access(path.c_str(), R_OK) == 0;
+    }
+
+    /** Interpret wall time in zone; values out of range normalize */
+    time_t toEpoch(const WallTime& w, const std::string& zone)
+    {
+        struct tm t {};
+        t.tm_year = w.year - 1900;
+        t.tm_mon  = w.month - 1;
+        t.tm_mday = w.day;
+        t.tm_hour = w.hour;
+        t.tm_min  = w.minute;
+        t.tm_sec  = w.second;
+        t.tm_isdst = -1;
+
+        if (zone == "UTC") {
+            return ::timegm(&t);
+        }
+
+        if (zone == fppZone_) {
+            return std::mktime(&t);
+        }
+
+        apply(zone);
+        time_t out = std::mktime(&t);
+        apply(fppZone_);
+        return out;
+    }
+
+    /** Wall time of an instant in zone */
+    WallTime fromEpoch(time_t epoch, const std::string& zone)
+    {
+        struct tm t {};
+
+        if (zone == "UTC") {
+            ::gmtime_r(&epoch, &t);
+        } else if (zone == fppZone_) {
+            ::localtime_r(&epoch, &t);
+        } else {
+            apply(zone);
+            ::localtime_r(&epoch, &t);
+            apply(fppZone_);
+        }
+
+        WallTime w;
+        w.year   = t.tm_year + 1900;
+        w.month  = t.tm_mon + 1;
+        w.day    = t.tm_mday;
+        w.hour   = t.tm_hour;
+        w.minute = t.tm_min;
+        w.second = t.tm_sec;
+        return w;
+    }
+
+    /** Wall time of an instant in the FPP zone */
+    WallTime local(time_t epoch) { return fromEpoch(epoch, fppZone_); }
+
+    /** "Y-m-d H:i:s" */
+    static std::string format(const WallTime& w)
+    {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%04d-%02d-%02d %02d:%02d:%02d",
+            w.year, w.month, w.day, w.hour, w.minute, w.second);
+        return std::string(buf);
+    }
+
+private:
+    void apply(const std::string& zone)
+    {
+        if (zone.empty()) {
+            ::unsetenv("TZ");
+        } else {
+            ::setenv("TZ", zone.c_str(), 1);
+        }
+        ::tzset();
+    }
+
+    std::string fppZone_;
+};
+
+} // namespace gcs
@@ -8,6 +8,7 @@ declare(strict_types=1);
  * - Render plugin UI (HTML + JS)
  * - Handle POSTed UI actions (save, plan-only sync)
  * - Expose AJAX endpoints for:
+ *   - background preview / apply jobs (SyncJobs; the UI uses these)
  *   - plan status (PURE)
  *   - diff preview (PURE)
  *   - apply (WRITE via SchedulerApply only, dry-run guarded)
@@ -74,9 +75,9 @@ if ($_SERVER['REQUEST_METHOD'] === 'POST' && isset($_POST['action'])) {
         }
 
         // Sync = plan-only, never writes (UI removed in Phase 19.3)
-        // Intentionally discard result; UI status polling handles feedback
+        // Queued for the background worker; UI status polling handles feedback
         if ($_POST['action'] === 'sync') {
-            SchedulerPlanner::plan($cfg);
+            SyncJobs::submit(SyncJobs::TYPE_PREVIEW);
         }
     } catch (Throwable $e) {
         GcsLogger::instance()->error('GoogleCalendarScheduler error', [
@@ -108,6 +109,49 @@ if (isset($_GET['endpoint']) && is_string($_GET['endpoint'])) {
 if ($endpoint !== '') {
     try {
 
+        // --------------------------------------------------------------
+        // Background jobs: submit a preview / apply job, poll its status
+        //
+        // job_submit&type=preview|apply[&dryRun=1] -> {ok, job}
+        // job_status&id=ID[&wait=SECONDS]          -> {ok, job}
+        // A finished job's "result" is the response the synchronous
+        // plan_status + diff (preview) or apply endpoint would return.
+        // --------------------------------------------------------------
+        if ($endpoint === 'job_submit') {
+            gcsJsonHeader();
+
+            $type = (string)($_GET['type'] ?? '');
+            $dry  = $_GET['dryRun'] ?? null;
+
+            $job = SyncJobs::submit($type, $dry === '1' || $dry === 'true' || $dry === 'on');
+            if ($job === null) {
+                echo json_encode([
+                    'ok'    => false,
+                    'error' => 'Unable to queue sync job.',
+                ]);
+                exit;
+            }
+
+            echo json_encode(['ok' => true, 'job' => $job]);
+            exit;
+        }
+
+        if ($endpoint === 'job_status') {
+            gcsJsonHeader();
+
+            $job = SyncJobs::await((string)($_GET['id'] ?? ''), (int)($_GET['wait'] ?? 0));
+            if ($job === null) {
+                echo json_encode([
+                    'ok'    => false,
+                    'error' => 'Unknown sync job.',
+                ]);
+                exit;
+            }
+
+            echo json_encode(['ok' => true, 'job' => $job]);
+            exit;
+        }
+
         // --------------------------------------------------------------
         // Plan status (plan-only): returns counts
         // --------------------------------------------------------------
@@ -187,6 +231,16 @@ if ($endpoint !== '') {
             // We return both the plan (for UI parity) and the apply result.
             $plan = SchedulerPlanner::plan($cfg);
 
+            if (empty($plan['ok'])) {
+                gcsJsonHeader();
+                echo json_encode([
+                    'ok'    => false,
+                    'error' => 'Planning failed: ' . (string)($plan['error']['type'] ?? 'unknown'),
+                    'plan'  => $plan,
+                ]);
+                exit;
+            }
+
             $creates = (isset($plan['creates']) && is_array($plan['creates'])) ? count($plan['creates']) : 0;
             $updates = (isset($plan['updates']) && is_array($plan['updates'])) ? count($plan['updates']) : 0;
             $deletes = (isset($plan['deletes']) && is_array($plan['deletes'])) ? count($plan['deletes']) : 0;
@@ -204,7 +258,7 @@ if ($endpoint !== '') {
                 exit;
             }
 
-            $applyResult = SchedulerApply::applyFromConfig($cfg);
+            $applyResult = SchedulerApply::applyFromConfig($cfg, $plan);
 
             header('Content-Type: application/json; charset=utf-8');
             echo json_encode([
@@ -271,9 +325,15 @@ if ($endpoint !== '') {
                 exit;
             }
 
-            $result = ExportService::export($entries);
+            $icsPath = tempnam(sys_get_temp_dir(), 'gcs-ics-');
+            $result  = is_string($icsPath)
+                ? ExportService::exportToFile($cfg, $entries, $icsPath)
+                : ['ok' => false];
 
-            if (empty($result['ics'])) {
+            if (empty($result['ok'])) {
+                if (is_string($icsPath)) {
+                    @unlink($icsPath);
+                }
                 header('Content-Type: application/json; charset=utf-8');
                 header('Cache-Control: no-store');
                 echo json_encode([
@@ -286,8 +346,10 @@ if ($endpoint !== '') {
             header('Content-Type: text/calendar; charset=utf-8');
             header('Content-Disposition: attachment; filename="gcs-unmanaged-export.ics"');
             header('Cache-Control: no-store');
+            header('Content-Length: ' . (string)filesize($icsPath));
 
-            echo $result['ics'];
+            readfile($icsPath);
+            @unlink($icsPath);
             exit;
         }
 
@@ -543,6 +605,44 @@ function looksLikeIcs(url) {
     return /^https?:\/\/.+\.ics$/i.test(url);
 }
 
+// --------------------------------------------------
+// Background jobs: planning and apply run in the sync worker;
+// requests only queue a job and long-poll for its result
+// --------------------------------------------------
+
+function gcsAwaitJob(id) {
+    return fetch(ENDPOINT + '&endpoint=job_status&wait=10&id=' + encodeURIComponent(id))
+        .then(r => r.json())
+        .then(d => {
+            if (!d || !d.ok || !d.job) {
+                throw new Error('Unknown sync job');
+            }
+            if (d.job.state === 'queued' || d.job.state === 'running') {
+                return gcsAwaitJob(id);
+            }
+            if (d.job.state !== 'done') {
+                throw new Error(d.job.error || 'Sync job failed');
+            }
+            return d.job.result;
+        });
+}
+
+function gcsRunJob(type, dryRun) {
+    var url = ENDPOINT + '&endpoint=job_submit&type=' + type;
+    if (dryRun) {
+        url += '&dryRun=1';
+    }
+
+    return fetch(url)
+        .then(r => r.json())
+        .then(d => {
+            if (!d || !d.ok || !d.job) {
+                throw new Error((d && d.error) || 'Unable to queue sync job');
+            }
+            return gcsAwaitJob(d.job.id);
+        });
+}
+
 icsInput.addEventListener('input', function () {
     var val = icsInput.value.trim();
     saveBtn.disabled = !(val === '' || looksLikeIcs(val));
@@ -670,8 +770,7 @@ function runPlanStatus() {
         return;
     }
 
-    return fetch(ENDPOINT + '&endpoint=plan_status')
-        .then(r => r.json())
+    return gcsRunJob('preview')
         .then(d => {
             if (!d || !d.ok) return;
 
@@ -755,8 +854,7 @@ previewBtn.addEventListener('click', function () {
 
     hidePreviewButton();
 
-    fetch(ENDPOINT + '&endpoint=diff')
-        .then(r => r.json())
+    gcsRunJob('preview')
         .then(d => {
             if (!d || !d.ok) {
                 hidePreviewUi();
@@ -792,6 +890,10 @@ previewBtn.addEventListener('click', function () {
             } else {
                 applyBtn.disabled = false;
             }
+        })
+        .catch(() => {
+            hidePreviewUi();
+            gcsSetStatus('error', 'Error communicating with Google Calendar.');
         });
 });
 
@@ -809,15 +911,7 @@ applyBtn.addEventListener('click', function () {
     var dryRunCb = document.getElementById('gcs-dry-run');
     var isDryRun = dryRunCb && dryRunCb.checked;
 
-    var ep = isDryRun ? 'diff' : 'apply';
-    var url = ENDPOINT + '&endpoint=' + ep;
-
-    if (isDryRun) {
-        url += '&dryRun=1';
-    }
-
-    fetch(url)
-        .then(r => r.json())
+    gcsRunJob(isDryRun ? 'preview' : 'apply', isDryRun)
         .then(d => {
             if (!d || !d.ok) {
                 gcsSetStatus('error', 'Error communicating with Google Calendar.');
@@ -840,6 +934,11 @@ applyBtn.addEventListener('click', function () {
 
             // Refresh status after write
             runPlanStatus();
+        })
+        .catch(() => {
+            gcsSetStatus('error', 'Error communicating with Google Calendar.');
+            applyBtn.disabled = false;
+            closePreviewBtn.disabled = false;
         });
 });
 
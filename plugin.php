@@ -25,6 +25,7 @@ $pluginRoot = __DIR__;
 $exporter   = $pluginRoot . '/bin/gcs-export';
 $runtimeDir = $pluginRoot . '/runtime';
 $envFile    = $runtimeDir . '/fpp-env.json';
+$pidFile    = $runtimeDir . '/gcs-export.pid';
 
 // ---------------------------------------------------------------------
 // Ensure runtime directory exists
@@ -36,6 +37,16 @@ if (!is_dir($runtimeDir)) {
     }
 }
 
+// ---------------------------------------------------------------------
+// Resident exporter (gcs-export --watch) keeps fpp-env current itself.
+// Concurrent loads may both get past this check; the daemon holds
+// gcs-export.lock, so only one of the spawned watchers stays up.
+// ---------------------------------------------------------------------
+$watcherPid = is_file($pidFile) ? (int)@file_get_contents($pidFile) : 0;
+if ($watcherPid > 0 && is_dir('/proc/' . $watcherPid)) {
+    return;
+}
+
 // ---------------------------------------------------------------------
 // Run exporter (web-context only)
 // ---------------------------------------------------------------------
@@ -48,15 +59,35 @@ if (is_executable($exporter)) {
      */
     chdir($pluginRoot);
 
-    exec(
-        escapeshellcmd($exporter) . ' >/dev/null 2>&1',
-        $out,
-        $rc
+    // gcs-export logs into the plugin log; match its configured format
+    // and rotation (defaults otherwise, see bin/gcs/Log.h)
+    $cfg = json_decode(
+        (string)@file_get_contents('/home/fpp/media/config/plugin.googleCalendarScheduler.json'),
+        true
     );
+    $log = is_array($cfg['runtime']['log'] ?? null) ? $cfg['runtime']['log'] : [];
+    if (isset($log['format'])) {
+        putenv('GCS_LOG_FORMAT=' . (string)$log['format']);
+    }
+    if (isset($log['max_bytes'])) {
+        putenv('GCS_LOG_MAX_BYTES=' . (int)$log['max_bytes']);
+    }
+    if (isset($log['keep'])) {
+        putenv('GCS_LOG_KEEP=' . (int)$log['keep']);
+    }
+
+    $cmd = escapeshellcmd($exporter) . ' ' .
+        escapeshellarg('--output-dir=' . $runtimeDir);
+
+    // Export into this instance's runtime directory
+    exec($cmd . ' >/dev/null 2>&1', $out, $rc);
 
     if ($rc !== 0) {
         error_log("[GCS] gcs-export failed with exit code {$rc}");
     }
+
+    // Start the watcher so later page loads skip the exec entirely
+    exec('nohup ' . $cmd . ' --watch >/dev/null 2>&1 &');
 } else {
     error_log('[GCS] gcs-export binary missing or not executable');
-}
\ No newline at end of file
+}
@@ -0,0 +1,205 @@
+<?php
+declare(strict_types=1);
+
+/**
+ * AutoSync
+ *
+ * Periodic, change-driven sync run by the worker (gcs-worker.php
+ * --auto-sync), which the resident gcs-export watcher starts every
+ * runtime.auto_sync_interval seconds.
+ *
+ * RESPONSIBILITIES:
+ * - Poll the calendar digests with conditional fetch, parse off (a 304
+ *   costs neither download nor parse)
+ * - Parse and re-plan only when an input changed: calendar digests, the FPP
+ *   environment digest, schedule.json, the media inventory, the config
+ *   or the day (daily horizon / pruning)
+ * - Apply only a non-empty diff
+ *
+ * HARD RULES:
+ * - Runs under the worker lock, never beside a queued preview / apply
+ * - dry_run blocks writes exactly as for a manual apply
+ * - A failed fetch never plans (an empty calendar would delete every
+ *   managed entry)
+ * - State lives in runtime/auto-sync.json, not in the config file
+ */
+final class AutoSync
+{
+    public const STATE_PATH = NativeEngine::RUNTIME_DIR . '/auto-sync.json';
+
+    /** Lower bound for the interval; conditional fetch is cheap, not free */
+    public const MIN_INTERVAL = 60;
+
+    /**
+     * Configured interval in seconds (0 = disabled).
+     *
+     * @param array<string,mixed> $cfg
+     */
+    public static function interval(array $cfg): int
+    {
+        $interval = (int)($cfg['runtime']['auto_sync_interval'] ?? 0);
+        return $interval <= 0 ? 0 : max(self::MIN_INTERVAL, $interval);
+    }
+
+    /**
+     * One auto-sync check. Caller holds the worker lock.
+     *
+     * @param array<string,mixed> $cfg
+     * @return array<string,mixed> Outcome, also persisted as the state file
+     */
+    public static function tick(array $cfg): array
+    {
+        $interval = self::interval($cfg);
+        $state    = self::readState();
+        $now      = time();
+
+        if ($interval === 0 || Config::icsUrls($cfg) === []) {
+            return ['ok' => true, 'skipped' => 'disabled'];
+        }
+        // The watcher's timer and the worker's clock may drift apart by
+        // a few seconds; only a clearly early tick is dropped
+        if (isset($state['checkedAt']) && $now - (int)$state['checkedAt'] < $interval - 5) {
+            return ['ok' => true, 'skipped' => 'not-due'];
+        }
+
+        $state['checkedAt'] = $now;
+
+        try {
+            $sources = (new SchedulerRunner($cfg))->pollSources();
+
+            foreach ($sources as $i => $src) {
+                $digest = (string)($src['digest'] ?? '');
+                if ($digest === '' || $digest === hash('fnv1a64', '')) {
+                    $state['outcome'] = 'fetch-failed';
+                    self::writeState($state);
+                    // Index only: the URL carries the calendar's secret token
+                    GcsLogger::instance()->warn('Auto-sync skipped: calendar fetch failed', [
+                        'calendar' => $i + 1,
+                    ]);
+                    return ['ok' => false, 'skipped' => 'fetch-failed'];
+                }
+            }
+
+            $inputs      = self::inputs($cfg, $sources);
+            $fingerprint = $inputs . ':' . ScheduleInventory::signature();
+            if (($state['fingerprint'] ?? null) === $fingerprint) {
+                $state['outcome'] = 'unchanged';
+                self::writeState($state);
+                return ['ok' => true, 'skipped' => 'unchanged'];
+            }
+
+            // Natively fetched again with parsing in the engine's parallel
+            // workers (unchanged calendars are 304s); bodies fetched in
+            // PHP are not downloaded twice
+            $polledInPhp = array_filter($sources, static fn(array $src): bool => $src['path'] === null) !== [];
+            $plan    = SchedulerPlanner::plan($cfg, $polledInPhp ? $sources : null);
+            unset($sources);
+            $pending = count($plan['creates'] ?? []) + count($plan['updates'] ?? []) + count($plan['deletes'] ?? []);
+
+            if (empty($plan['ok'])) {
+                // Not remembered: the next tick plans again
+                unset($state['fingerprint']);
+                $state['outcome'] = 'plan-failed';
+                self::writeState($state);
+                return ['ok' => false, 'skipped' => 'plan-failed'];
+            }
+
+            $result = ['ok' => true, 'pending' => $pending];
+
+            if ($pending === 0) {
+                $state['outcome'] = 'noop';
+            } elseif (!empty($cfg['runtime']['dry_run'])) {
+                $state['outcome'] = 'dry-run';
+            } else {
+                // Throws (caught below) on failure
+                $result['apply'] = SchedulerApply::applyFromConfig($cfg, $plan);
+                $state['outcome']   = 'applied';
+                $state['appliedAt'] = $now;
+
+                GcsLogger::instance()->info('Auto-sync applied', [
+                    'creates' => count($plan['creates'] ?? []),
+                    'updates' => count($plan['updates'] ?? []),
+                    'deletes' => count($plan['deletes'] ?? []),
+                ]);
+            }
+
+            // Taken after the apply so the plugin's own schedule.json
+            // write does not trigger the next re-plan. A dry-run diff
+            // stays pending and is re-planned only when an input changes.
+            $state['fingerprint'] = $inputs . ':' . ScheduleInventory::signature();
+            $state['pending']     = $pending;
+            self::writeState($state);
+
+            return $result;
+        } catch (Throwable $e) {
+            unset($state['fingerprint']);
+            $state['outcome'] = 'error';
+            $state['error']   = $e->getMessage();
+            self::writeState($state);
+
+            GcsLogger::instance()->error('Auto-sync failed', ['error' => $e->getMessage()]);
+            return ['ok' => false, 'error' => $e->getMessage()];
+        }
+    }
+
+    /* =====================================================================
+     * Change detection
+     * ===================================================================== */
+
+    /**
+     * Digest of every planner input except schedule.json, whose stat
+     * signature is appended separately (it changes on our own apply).
+     *
+     * @param array<string,mixed> $cfg
+     * @param array<int,array<string,mixed>> $sources
+     */
+    private static function inputs(array $cfg, array $sources): string
+    {
+        $calendars = [];
+        foreach ($sources as $src) {
+            $calendars[] = [(string)($src['url'] ?? ''), (string)($src['digest'] ?? '')];
+        }
+
+        unset($cfg['sync']);
+
+        return sha1((string)json_encode([
+            $calendars,
+            FPPSemantics::getEnvironmentDigest(),
+            FPPSemantics::getSchedulerGuardDate()->format('Y-m-d'),
+            date('Y-m-d'),
+            date_default_timezone_get(),
+            TargetResolver::inventoryStamp(),
+            $cfg,
+        ]));
+    }
+
+    /* =====================================================================
+     * State
+     * ===================================================================== */
+
+    /**
+     * @return array<string,mixed>
+     */
+    public static function readState(): array
+    {
+        $raw = @file_get_contents(self::STATE_PATH);
+        $state = is_string($raw) ? json_decode($raw, true) : null;
+        return is_array($state) ? $state : [];
+    }
+
+    /**
+     * @param array<string,mixed> $state
+     */
+    private static function writeState(array $state): void
+    {
+        $dir = dirname(self::STATE_PATH);
+        if (!is_dir($dir) && !@mkdir($dir, 0755, true) && !is_dir($dir)) {
+            return;
+        }
+
+        $tmp = self::STATE_PATH . '.tmp';
+        if (@file_put_contents($tmp, json_encode($state, JSON_UNESCAPED_SLASHES)) !== false) {
+            @rename($tmp, self::STATE_PATH);
+        }
+    }
+}
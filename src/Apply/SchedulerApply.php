@@ -28,15 +28,40 @@ declare(strict_types=1);
  */
 final class SchedulerApply
 {
-    public static function applyFromConfig(array $cfg): array
+    /**
+     * @param array<string,mixed>|null $plan SchedulerPlanner::plan() result
+     *        the caller already computed and showed; null plans here
+     */
+    public static function applyFromConfig(array $cfg, ?array $plan = null): array
     {
         GcsLogger::instance()->info('GCS APPLY ENTERED', [
             'dryRun' => !empty($cfg['runtime']['dry_run']),
         ]);
 
-        $plan   = SchedulerPlanner::plan($cfg);
+        return GcsMetrics::measure('apply', static fn(): array => self::applyMeasured($cfg, $plan));
+    }
+
+    /**
+     * applyFromConfig() inside its metrics run.
+     *
+     * @param array<string,mixed>|null $plan
+     * @return array<string,mixed>
+     */
+    private static function applyMeasured(array $cfg, ?array $plan): array
+    {
+        $plan   = $plan ?? SchedulerPlanner::plan($cfg);
         $dryRun = !empty($cfg['runtime']['dry_run']);
 
+        // A failed plan (e.g. a calendar fetch failed) carries no entries;
+        // applying it would delete every managed entry
+        if (empty($plan['ok'])) {
+            return [
+                'ok'     => false,
+                'dryRun' => $dryRun,
+                'error'  => $plan['error'] ?? ['type' => 'plan_failed'],
+            ];
+        }
+
         $existing = (isset($plan['existingRaw']) && is_array($plan['existingRaw']))
             ? $plan['existingRaw']
             : [];
@@ -65,7 +90,12 @@ final class SchedulerApply
             ];
         }
 
-        $applyPlan = self::planApply($existing, $desired);
+        GcsMetrics::start('apply_plan');
+        $existingKeys = (isset($plan['existingKeys']) && is_array($plan['existingKeys']))
+            ? $plan['existingKeys']
+            : null;
+        $applyPlan = self::planApply($existing, $desired, $existingKeys);
+        GcsMetrics::stop('apply_plan');
 
         if (
             count($applyPlan['creates']) === 0 &&
@@ -73,32 +103,57 @@ final class SchedulerApply
             count($applyPlan['deletes']) === 0
         ) {
             return [
-                'ok'     => true,
-                'dryRun' => false,
-                'counts' => ['creates' => 0, 'updates' => 0, 'deletes' => 0],
-                'noop'   => true,
+                'ok'      => true,
+                'dryRun'  => false,
+                'counts'  => ['creates' => 0, 'updates' => 0, 'deletes' => 0],
+                'noop'    => true,
             ];
         }
 
-        $backupPath = SchedulerSync::backupScheduleFileOrThrow(
-            SchedulerSync::SCHEDULE_JSON_PATH
-        );
-
-        SchedulerSync::writeScheduleJsonAtomicallyOrThrow(
+        // Native: splice the patch into the file (untouched entries keep
+        // their bytes) with a delta backup; otherwise full copy + rewrite
+        GcsMetrics::start('write');
+        $native = NativeEngine::applySchedule(
+            $cfg,
             SchedulerSync::SCHEDULE_JSON_PATH,
-            $applyPlan['newSchedule']
+            $applyPlan['layout'],
+            (string)($plan['existingDigest'] ?? '')
         );
 
+        if ($native !== null) {
+            $backupPath = $native['backup'];
+            ScheduleInventory::invalidate(SchedulerSync::SCHEDULE_JSON_PATH);
+        } else {
+            // The native patch also refuses this case (exit 3 -> null)
+            SchedulerSync::assertScheduleUnchangedOrThrow(
+                SchedulerSync::SCHEDULE_JSON_PATH,
+                (string)($plan['existingDigest'] ?? '')
+            );
+
+            $backupPath = SchedulerSync::backupScheduleFileOrThrow(
+                SchedulerSync::SCHEDULE_JSON_PATH
+            );
+
+            SchedulerSync::writeScheduleJsonAtomicallyOrThrow(
+                SchedulerSync::SCHEDULE_JSON_PATH,
+                $applyPlan['newSchedule']
+            );
+        }
+
+        GcsMetrics::stop('write');
+
+        GcsMetrics::start('verify');
         SchedulerSync::verifyScheduleJsonKeysOrThrow(
             $applyPlan['expectedManagedKeys'],
             $applyPlan['expectedDeletedKeys']
         );
+        GcsMetrics::stop('verify');
 
         return [
-            'ok'     => true,
-            'dryRun' => false,
-            'counts' => $previewCounts,
-            'backup' => $backupPath,
+            'ok'      => true,
+            'dryRun'  => false,
+            'counts'  => $previewCounts,
+            'backup'  => $backupPath,
         ];
     }
 
@@ -106,15 +161,21 @@ final class SchedulerApply
      * Build apply plan:
      * - Unmanaged entries preserved in original order
      * - Managed entries rewritten in Planner-provided order
+     * - Managed entries equivalent to their desired form are kept as-is
+     *
+     * 'layout' describes newSchedule as a patch over $existing: one
+     * ['keep' => existing index] or ['entry' => array] per output entry.
      *
      * Identity model (Phase 29+):
      * - UID-only
      *
      * @param array<int,array<string,mixed>> $existing
      * @param array<int,array<string,mixed>> $desired
+     * @param array<int,string|null>|null $existingKeys Identity key per existing
+     *        index (ScheduleInventory::keys()); extracted here when null
      * @return array<string,mixed>
      */
-    private static function planApply(array $existing, array $desired): array
+    private static function planApply(array $existing, array $desired, ?array $existingKeys = null): array
     {
         // Desired managed entries indexed by UID
         $desiredByUid   = [];
@@ -137,25 +198,33 @@ final class SchedulerApply
             $desiredByUid[$uid] = self::normalizeForApply($d);
         }
 
-        // Existing managed entries indexed by UID
+        // Existing entries: managed ones indexed by UID
         $existingManagedByUid = [];
-        foreach ($existing as $ex) {
-            if (!is_array($ex)) {
-                continue;
+        $existingIndexByUid   = [];
+        $existingUids         = [];
+        if ($existingKeys !== null && count($existingKeys) !== count($existing)) {
+            $existingKeys = null;
+        }
+        foreach ($existing as $i => $ex) {
+            if ($existingKeys !== null) {
+                $uid = $existingKeys[$i] ?? null;
+            } else {
+                $uid = is_array($ex) ? SchedulerIdentity::extractKey($ex) : null;
             }
-
-            $uid = SchedulerIdentity::extractKey($ex);
+            $existingUids[$i] = $uid;
             if ($uid === null) {
                 continue;
             }
 
             $existingManagedByUid[$uid] = $ex;
+            $existingIndexByUid[$uid]   = $i;
         }
 
         // Compute creates / updates / deletes
-        $creates = [];
-        $updates = [];
-        $deletes = [];
+        $creates   = [];
+        $updates   = [];
+        $deletes   = [];
+        $unchanged = [];
 
         foreach ($desiredByUid as $uid => $d) {
             if (!isset($existingManagedByUid[$uid])) {
@@ -163,7 +232,9 @@ final class SchedulerApply
                 continue;
             }
 
-            if (!self::entriesEquivalentForCompare($existingManagedByUid[$uid], $d)) {
+            if (self::entriesEquivalentForCompare($existingManagedByUid[$uid], $d)) {
+                $unchanged[$uid] = true;
+            } else {
                 $updates[] = $uid;
             }
         }
@@ -180,21 +251,22 @@ final class SchedulerApply
          * 2) Append managed entries in Planner order
          */
         $newSchedule = [];
+        $layout      = [];
 
-        foreach ($existing as $ex) {
-            if (!is_array($ex)) {
-                $newSchedule[] = $ex;
-                continue;
-            }
-
-            if (SchedulerIdentity::extractKey($ex) === null) {
+        foreach ($existing as $i => $ex) {
+            if ($existingUids[$i] === null) {
                 $newSchedule[] = $ex;
+                $layout[]      = ['keep' => $i];
             }
         }
 
         foreach ($uidsInOrder as $uid) {
-            if (isset($desiredByUid[$uid])) {
+            if (isset($unchanged[$uid])) {
+                $newSchedule[] = $existingManagedByUid[$uid];
+                $layout[]      = ['keep' => $existingIndexByUid[$uid]];
+            } else {
                 $newSchedule[] = $desiredByUid[$uid];
+                $layout[]      = ['entry' => $desiredByUid[$uid]];
             }
         }
 
@@ -203,6 +275,7 @@ final class SchedulerApply
             'updates'             => $updates,
             'deletes'             => $deletes,
             'newSchedule'         => $newSchedule,
+            'layout'              => $layout,
             'expectedManagedKeys' => array_keys($desiredByUid),
             'expectedDeletedKeys' => $deletes,
         ];
@@ -37,24 +37,20 @@ final class SchedulerCleanupPlanner
     public static function plan(): array
     {
         try {
-            $entries = SchedulerSync::readScheduleJsonStatic(SchedulerSync::SCHEDULE_JSON_PATH);
+            $inventory = ScheduleInventory::load();
+            $entries   = $inventory->entries();
+            $counts    = $inventory->counts();
 
-            $total = 0;
-            $managedCount = 0;
-            $unmanagedCount = 0;
+            $total = $counts['total'];
+            $managedCount = $counts['managed'];
+            $unmanagedCount = $counts['unmanaged'];
 
             // Build fingerprint set for ALL managed entries (used as equivalence targets)
             $managedFingerprints = [];
-            foreach ($entries as $idx => $e) {
-                if (!is_array($e)) continue;
-                $total++;
-
-                if (SchedulerIdentity::isGcsManaged($e)) {
-                    $managedCount++;
-                    $fp = self::fingerprint($e);
-                    if ($fp !== '') {
-                        $managedFingerprints[$fp] = true;
-                    }
+            foreach ($inventory->managedIndexes() as $idx) {
+                $fp = self::fingerprint($entries[$idx]);
+                if ($fp !== '') {
+                    $managedFingerprints[$fp] = true;
                 }
             }
 
@@ -63,16 +59,8 @@ final class SchedulerCleanupPlanner
             $candidates = [];
             $blocked = [];
 
-            foreach ($entries as $idx => $e) {
-                if (!is_array($e)) continue;
-
-                if (SchedulerIdentity::isGcsManaged($e)) {
-                    continue;
-                }
-
-                $unmanagedCount++;
-
-                $fp = self::fingerprint($e);
+            foreach ($inventory->unmanagedIndexes() as $idx) {
+                $fp = self::fingerprint($entries[$idx]);
                 if ($fp === '') {
                     $blocked[] = [
                         'index' => $idx,
@@ -0,0 +1,467 @@
+<?php
+declare(strict_types=1);
+
+/**
+ * SyncJobs
+ *
+ * Background queue for preview (plan-only) and apply jobs, so UI
+ * requests never plan or write inline.
+ *
+ * RESPONSIBILITIES:
+ * - Record submitted jobs under runtime/jobs/<id>.json
+ * - Start the CLI worker (bin/gcs-worker.php) detached from the request
+ * - Drain the queue in the worker, one job at a time, and store each
+ *   job's result next to it
+ *
+ * JOB FILE:
+ *   {"id", "type": "preview"|"apply", "state": "queued"|"running"|
+ *    "done"|"failed", "dryRun", "createdAt", "startedAt",
+ *    "finishedAt", "result", "error"}
+ *
+ * HARD RULES:
+ * - A queued or running job of the same type is reused, not duplicated
+ * - Only one worker runs at a time (flock on runtime/jobs/worker.lock)
+ * - Apply jobs re-read the persisted config; dry-run never writes
+ * - Never throws to the caller; a failing job is recorded as "failed"
+ *
+ * NON-GOALS:
+ * - No planning or apply logic (SchedulerPlanner / SchedulerApply own it)
+ */
+final class SyncJobs
+{
+    public const TYPE_PREVIEW = 'preview';
+    public const TYPE_APPLY   = 'apply';
+
+    public const STATE_QUEUED  = 'queued';
+    public const STATE_RUNNING = 'running';
+    public const STATE_DONE    = 'done';
+    public const STATE_FAILED  = 'failed';
+
+    public const WORKER_PATH = __DIR__ . '/../../bin/gcs-worker.php';
+
+    /** Finished jobs kept for status polling */
+    private const KEEP_FINISHED = 20;
+
+    /** A job still queued after this long gets a fresh worker */
+    private const RESPAWN_AFTER_SECONDS = 5;
+
+    /* =====================================================================
+     * Submission / status (web request side)
+     * ===================================================================== */
+
+    /**
+     * Queue a job (or return the pending one of the same type) and make
+     * sure a worker is running.
+     *
+     * @return array<string,mixed>|null Job record; null if runtime/ is not writable
+     */
+    public static function submit(string $type, bool $dryRun = false): ?array
+    {
+        if ($type !== self::TYPE_PREVIEW && $type !== self::TYPE_APPLY) {
+            return null;
+        }
+        if (!self::ensureDir()) {
+            return null;
+        }
+
+        $job = null;
+        foreach (self::listJobs() as $existing) {
+            if ($existing['type'] === $type && (bool)$existing['dryRun'] === $dryRun &&
+                ($existing['state'] === self::STATE_QUEUED || $existing['state'] === self::STATE_RUNNING)) {
+                $job = $existing;
+                break;
+            }
+        }
+
+        if ($job === null) {
+            $job = [
+                'id'         => bin2hex(random_bytes(8)),
+                'type'       => $type,
+                'state'      => self::STATE_QUEUED,
+                'dryRun'     => $dryRun,
+                'createdAt'  => microtime(true),
+                'startedAt'  => null,
+                'finishedAt' => null,
+                'result'     => null,
+                'error'      => null,
+            ];
+            if (!self::write($job)) {
+                return null;
+            }
+        }
+
+        self::spawnWorker();
+
+        return $job;
+    }
+
+    /**
+     * Current record of a job, or null for an unknown id.
+     *
+     * A job left "running" by a worker that is gone is reported failed.
+     *
+     * @return array<string,mixed>|null
+     */
+    public static function status(string $id): ?array
+    {
+        $job = self::read($id);
+        if ($job === null) {
+            return null;
+        }
+
+        if ($job['state'] === self::STATE_RUNNING && !self::workerActive()) {
+            // Re-read: the worker may have finished after the first read
+            $job = self::read($id) ?? $job;
+            if ($job['state'] === self::STATE_RUNNING) {
+                $job['state']      = self::STATE_FAILED;
+                $job['error']      = 'Sync worker exited before the job finished.';
+                $job['finishedAt'] = microtime(true);
+                self::write($job);
+            }
+        }
+
+        // The worker started on submit may have failed to launch
+        if ($job['state'] === self::STATE_QUEUED &&
+            microtime(true) - (float)($job['createdAt'] ?? 0) > self::RESPAWN_AFTER_SECONDS) {
+            self::spawnWorker();
+        }
+
+        return $job;
+    }
+
+    /**
+     * status(), waiting up to $waitSeconds for the job to finish
+     * (long-poll; the request holds no locks while waiting).
+     *
+     * @return array<string,mixed>|null
+     */
+    public static function await(string $id, int $waitSeconds): ?array
+    {
+        $deadline = microtime(true) + max(0, min(25, $waitSeconds));
+
+        for (;;) {
+            $job = self::status($id);
+            if ($job === null || self::isFinished($job) || microtime(true) >= $deadline) {
+                return $job;
+            }
+            usleep(200000);
+        }
+    }
+
+    /**
+     * @param array<string,mixed> $job
+     */
+    public static function isFinished(array $job): bool
+    {
+        return $job['state'] === self::STATE_DONE || $job['state'] === self::STATE_FAILED;
+    }
+
+    /* =====================================================================
+     * Worker (CLI side)
+     * ===================================================================== */
+
+    /**
+     * Run queued jobs until the queue is empty. Returns immediately when
+     * another worker holds the lock.
+     *
+     * @param callable|null $first Run once under the lock before the
+     *        queue (AutoSync::tick); skipped when the lock is taken
+     * @return int Number of jobs run
+     */
+    public static function runWorker(?callable $first = null): int
+    {
+        if (!self::ensureDir()) {
+            return 0;
+        }
+
+        $ran = 0;
+
+        do {
+            $lock = @fopen(self::lockPath(), 'c');
+            if ($lock === false || !flock($lock, LOCK_EX | LOCK_NB)) {
+                if ($lock !== false) {
+                    fclose($lock);
+                }
+                return $ran;
+            }
+
+            if ($first !== null) {
+                try {
+                    $first();
+                } catch (Throwable $e) {
+                    GcsLogger::instance()->error('Worker task failed', ['error' => $e->getMessage()]);
+                }
+                $first = null;
+            }
+
+            while (($job = self::nextQueued()) !== null) {
+                self::runJob($job);
+                $ran++;
+            }
+            self::prune();
+
+            flock($lock, LOCK_UN);
+            fclose($lock);
+
+            // A job submitted while the lock was being released would
+            // otherwise wait for the next submission
+        } while (self::nextQueued() !== null);
+
+        return $ran;
+    }
+
+    /**
+     * @param array<string,mixed> $job
+     */
+    private static function runJob(array $job): void
+    {
+        $job['state']     = self::STATE_RUNNING;
+        $job['startedAt'] = microtime(true);
+        self::write($job);
+
+        try {
+            $cfg = Config::load();
+
+            $job['result'] = ($job['type'] === self::TYPE_APPLY)
+                ? self::runApply($cfg, (bool)$job['dryRun'])
+                : self::runPreview($cfg);
+            $job['state'] = self::STATE_DONE;
+        } catch (Throwable $e) {
+            $job['state'] = self::STATE_FAILED;
+            $job['error'] = $e->getMessage();
+        }
+
+        $job['finishedAt'] = microtime(true);
+        self::write($job);
+
+        GcsLogger::instance()->info('Sync job finished', [
+            'id'    => $job['id'],
+            'type'  => $job['type'],
+            'state' => $job['state'],
+            'ms'    => (int)round(($job['finishedAt'] - $job['startedAt']) * 1000),
+            'error' => $job['error'],
+        ]);
+    }
+
+    /**
+     * Plan-only: counts plus the diff the preview renders.
+     *
+     * @param array<string,mixed> $cfg
+     * @return array<string,mixed>
+     */
+    private static function runPreview(array $cfg): array
+    {
+        $plan = SchedulerPlanner::plan($cfg);
+        $norm = DiffPreviewer::normalizeResultForUi(['diff' => $plan]);
+
+        return [
+            'ok'     => !empty($plan['ok']),
+            'counts' => [
+                'creates' => count($norm['creates']),
+                'updates' => count($norm['updates']),
+                'deletes' => count($norm['deletes']),
+            ],
+            'diff'   => self::diffPayload($plan),
+        ];
+    }
+
+    /**
+     * Apply, guarded by the persisted and the requested dry-run flags
+     * (same contract as the synchronous "apply" endpoint).
+     *
+     * @param array<string,mixed> $cfg
+     * @return array<string,mixed>
+     */
+    private static function runApply(array $cfg, bool $requestDryRun): array
+    {
+        $plan = SchedulerPlanner::plan($cfg);
+
+        if (empty($plan['ok'])) {
+            return [
+                'ok'    => false,
+                'error' => $plan['error'] ?? ['type' => 'plan_failed'],
+            ];
+        }
+
+        if (!empty($cfg['runtime']['dry_run']) || $requestDryRun) {
+            return [
+                'ok'   => true,
+                'mode' => 'dry-run',
+                'diff' => self::diffPayload($plan),
+            ];
+        }
+
+        $pending = count(is_array($plan['creates'] ?? null) ? $plan['creates'] : [])
+            + count(is_array($plan['updates'] ?? null) ? $plan['updates'] : [])
+            + count(is_array($plan['deletes'] ?? null) ? $plan['deletes'] : []);
+
+        if ($pending === 0) {
+            return [
+                'ok'     => true,
+                'noop'   => true,
+                'result' => [
+                    'plan'  => $plan,
+                    'apply' => ['ok' => true, 'noop' => true],
+                ],
+            ];
+        }
+
+        return [
+            'ok'     => true,
+            'result' => [
+                'plan'  => $plan,
+                'apply' => SchedulerApply::applyFromConfig($cfg, $plan),
+            ],
+        ];
+    }
+
+    /**
+     * @param array<string,mixed> $plan
+     * @return array<string,array<int,mixed>>
+     */
+    private static function diffPayload(array $plan): array
+    {
+        $out = [];
+        foreach (['creates', 'updates', 'deletes', 'desiredEntries', 'existingRaw'] as $k) {
+            $out[$k] = (isset($plan[$k]) && is_array($plan[$k])) ? $plan[$k] : [];
+        }
+        return $out;
+    }
+
+    /* =====================================================================
+     * Storage
+     * ===================================================================== */
+
+    private static function dir(): string
+    {
+        return NativeEngine::RUNTIME_DIR . '/jobs';
+    }
+
+    private static function lockPath(): string
+    {
+        return self::dir() . '/worker.lock';
+    }
+
+    private static function ensureDir(): bool
+    {
+        $dir = self::dir();
+        return is_dir($dir) || @mkdir($dir, 0755, true) || is_dir($dir);
+    }
+
+    /**
+     * @return array<string,mixed>|null
+     */
+    private static function read(string $id): ?array
+    {
+        if (!preg_match('/^[0-9a-f]{16}$/', $id)) {
+            return null;
+        }
+
+        $job = json_decode((string)@file_get_contents(self::dir() . '/' . $id . '.json'), true);
+        if (!is_array($job) || ($job['id'] ?? null) !== $id || !isset($job['type'], $job['state'])) {
+            return null;
+        }
+        return $job;
+    }
+
+    /**
+     * @param array<string,mixed> $job
+     */
+    private static function write(array $job): bool
+    {
+        $json = json_encode($job, JSON_UNESCAPED_SLASHES | JSON_PARTIAL_OUTPUT_ON_ERROR);
+        if (!is_string($json)) {
+            return false;
+        }
+
+        $path = self::dir() . '/' . $job['id'] . '.json';
+        $tmp  = $path . '.tmp-' . getmypid();
+
+        if (@file_put_contents($tmp, $json, LOCK_EX) !== strlen($json) || !@rename($tmp, $path)) {
+            @unlink($tmp);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * All readable jobs, oldest first.
+     *
+     * @return array<int,array<string,mixed>>
+     */
+    private static function listJobs(): array
+    {
+        $jobs = [];
+        foreach (glob(self::dir() . '/*.json') ?: [] as $path) {
+            $job = self::read(basename($path, '.json'));
+            if ($job !== null) {
+                $jobs[] = $job;
+            }
+        }
+
+        usort($jobs, static function (array $a, array $b): int {
+            return ($a['createdAt'] ?? 0) <=> ($b['createdAt'] ?? 0);
+        });
+
+        return $jobs;
+    }
+
+    /**
+     * @return array<string,mixed>|null
+     */
+    private static function nextQueued(): ?array
+    {
+        foreach (self::listJobs() as $job) {
+            if ($job['state'] === self::STATE_QUEUED) {
+                return $job;
+            }
+        }
+        return null;
+    }
+
+    /** Drop all but the newest KEEP_FINISHED finished jobs */
+    private static function prune(): void
+    {
+        $finished = array_values(array_filter(self::listJobs(), [self::class, 'isFinished']));
+
+        for ($i = 0, $n = count($finished) - self::KEEP_FINISHED; $i < $n; $i++) {
+            @unlink(self::dir() . '/' . $finished[$i]['id'] . '.json');
+        }
+    }
+
+    /* =====================================================================
+     * Worker process
+     * ===================================================================== */
+
+    private static function workerActive(): bool
+    {
+        $lock = @fopen(self::lockPath(), 'c');
+        if ($lock === false) {
+            return false;
+        }
+
+        $free = flock($lock, LOCK_EX | LOCK_NB);
+        if ($free) {
+            flock($lock, LOCK_UN);
+        }
+        fclose($lock);
+
+        return !$free;
+    }
+
+    /** Start bin/gcs-worker.php in the background (no-op while one runs) */
+    private static function spawnWorker(): void
+    {
+        if (self::workerActive()) {
+            return;
+        }
+
+        // PHP_BINARY is the SAPI binary under php-fpm; use the CLI next to it
+        $php = PHP_BINDIR . '/php';
+        if (!is_executable($php)) {
+            $php = 'php';
+        }
+
+        exec('nohup ' . escapeshellcmd($php) . ' ' . escapeshellarg(self::WORKER_PATH) . ' >/dev/null 2>&1 &');
+    }
+}
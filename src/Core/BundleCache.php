@@ -0,0 +1,126 @@
+<?php
+declare(strict_types=1);
+
+/**
+ * BundleCache
+ *
+ * Per-UID cache of the planner's base bundles under runtime/, so a
+ * calendar edit re-expands and rebuilds only the UIDs it touched.
+ *
+ * ENTRY (per UID):
+ * - Group hash: sha1 over the UID's parsed VEVENT group (base +
+ *   overrides), see groupHash()
+ * - The bundle SchedulerPlanner built from it (null = series skipped)
+ *
+ * STAMP (sha1 over everything else a bundle depends on):
+ * - gcs-export environment digest (default stop type / repeat)
+ * - Scheduler guard date (series end dates) and PHP timezone
+ * - Playlist / sequence inventory stamp (target resolution)
+ * - Configuration, minus the informational "sync" block
+ * A different stamp discards the whole cache.
+ *
+ * HARD RULES:
+ * - Never throws; an unreadable / mismatching file is an empty cache
+ * - Caches bundles only: ordering, flattening, guard rules and the
+ *   diff always run over the full bundle list
+ * - Disabled together with the plan cache (runtime.plan_cache_ttl = 0)
+ *
+ * NON-GOALS:
+ * - No planning logic
+ */
+final class BundleCache
+{
+    /** Bump whenever the bundle shape or bundle-building semantics change */
+    private const FORMAT = 1;
+
+    private const MAGIC = 'GCSBUNDLES';
+
+    private const PATH = NativeEngine::RUNTIME_DIR . '/bundle-cache.bin';
+
+    /**
+     * Stamp for bundles built now, or null when bundles cannot be
+     * cached (disabled, no environment digest).
+     *
+     * @param array<string,mixed> $cfg
+     */
+    public static function stamp(array $cfg, string $guardDate): ?string
+    {
+        $envDigest = FPPSemantics::getEnvironmentDigest();
+        if (PlanCache::ttl($cfg) === 0 || $envDigest === null) {
+            return null;
+        }
+
+        unset($cfg['sync']);
+
+        $material = json_encode([
+            self::FORMAT,
+            $envDigest,
+            $guardDate,
+            date_default_timezone_get(),
+            TargetResolver::inventoryStamp(),
+            $cfg,
+        ]);
+
+        return is_string($material) ? sha1($material) : null;
+    }
+
+    /**
+     * Content hash of one UID's event group as SchedulerRunner groups it.
+     *
+     * @param array<string,mixed>|null $base
+     * @param array<string,array<string,mixed>> $overrides recurrenceId => event
+     */
+    public static function groupHash(?array $base, array $overrides): string
+    {
+        return sha1(serialize([$base, $overrides]));
+    }
+
+    /**
+     * Cached entries for $stamp (uid => ['hash', 'bundle']); empty on a miss.
+     *
+     * @return array<string,array{hash:string,bundle:array<string,mixed>|null}>
+     */
+    public static function load(string $stamp): array
+    {
+        $raw = @file_get_contents(self::PATH);
+        if (!is_string($raw)) {
+            return [];
+        }
+
+        $nl = strpos($raw, "\n");
+        if ($nl === false) {
+            return [];
+        }
+
+        $header = explode(' ', substr($raw, 0, $nl));
+        if (count($header) !== 3 || $header[0] !== self::MAGIC ||
+            (int)$header[1] !== self::FORMAT || $header[2] !== $stamp) {
+            return [];
+        }
+
+        $entries = @unserialize(substr($raw, $nl + 1), ['allowed_classes' => false]);
+        return is_array($entries) ? $entries : [];
+    }
+
+    /**
+     * Replace the cache with $entries (atomic); UIDs absent from the
+     * current plan are dropped with it.
+     *
+     * @param array<string,array{hash:string,bundle:array<string,mixed>|null}> $entries
+     */
+    public static function store(string $stamp, array $entries): void
+    {
+        $tmp  = self::PATH . '.tmp-' . getmypid();
+        $data = self::MAGIC . ' ' . self::FORMAT . ' ' . $stamp . "\n" . serialize($entries);
+
+        if (@file_put_contents($tmp, $data, LOCK_EX) !== strlen($data) || !@rename($tmp, self::PATH)) {
+            @unlink($tmp);
+        }
+    }
+
+    /** Drop the cache (verification mismatch) */
+    public static function clear(): void
+    {
+        @unlink(self::PATH);
+    }
+}
@@ -45,11 +45,60 @@ final class Config
 
             'calendar' => [
                 'ics_url' => '',
+
+                // Further ICS sources (config file only; the UI edits
+                // ics_url). All calendars are fetched concurrently and
+                // merged by UID, ics_url first.
+                'additional_ics_urls' => [],
             ],
 
             'runtime' => [
                 // When true, schedule.json is never modified
                 'dry_run' => true,
+
+                // Use bin/gcs-export native subcommands when present
+                // (falls back to the PHP implementation on any failure)
+                'native_engine' => true,
+
+                // Bulk native results (parse / fetch / expand) as JSON
+                // instead of the binary record stream (debugging)
+                'native_json' => false,
+
+                // Seconds a computed plan is reused while calendars,
+                // environment and config are unchanged (0 disables)
+                'plan_cache_ttl' => 900,
+
+                // Re-plan every incremental (bundle cache) plan in full
+                // too and log any difference (diagnostics; doubles the
+                // planning cost)
+                'verify_incremental' => false,
+
+                // Seconds between automatic syncs run by the resident
+                // gcs-export watcher (0 disables). Each run re-plans only
+                // when a calendar, the FPP environment, schedule.json or
+                // the config changed, and applies only a non-empty diff;
+                // dry_run still prevents writes.
+                'auto_sync_interval' => 0,
+
+                // Plugin log (shared with gcs-export): "text" or
+                // "ndjson"; rotated past max_bytes (0 disables), keeping
+                // `keep` old files
+                'log' => [
+                    'format'    => 'text',
+                    'max_bytes' => 1048576,
+                    'keep'      => 3,
+                ],
+
+                // Diagnostic tracing to /tmp per category (see GcsTrace):
+                // 0 = off, 1 = summary, 2 = detail
+                'trace' => [
+                    'parser'    => 0,
+                    'runner'    => 0,
+                    'ordering'  => 0,
+                    'inventory' => 0,
+                    'export'    => 0,
+                    'semantics' => 0,
+                ],
             ],
 
             /*
@@ -102,6 +151,31 @@ final class Config
         return array_replace_recursive(self::defaults(), $cfg);
     }
 
+    /**
+     * All configured ICS sources, primary first, trimmed and de-duplicated.
+     *
+     * @param array<string,mixed> $cfg
+     * @return array<int,string>
+     */
+    public static function icsUrls(array $cfg): array
+    {
+        $urls = [(string)($cfg['calendar']['ics_url'] ?? '')];
+        foreach ((array)($cfg['calendar']['additional_ics_urls'] ?? []) as $url) {
+            if (is_string($url)) {
+                $urls[] = $url;
+            }
+        }
+
+        $out = [];
+        foreach ($urls as $url) {
+            $url = trim($url);
+            if ($url !== '' && !in_array($url, $out, true)) {
+                $out[] = $url;
+            }
+        }
+        return $out;
+    }
+
     /**
      * Persist configuration to disk.
      *
@@ -0,0 +1,160 @@
+<?php
+declare(strict_types=1);
+
+/**
+ * DayMask
+ *
+ * Canonical weekday-set representation (7-bit integer mask).
+ *
+ * Bit 0 = Sunday .. bit 6 = Saturday, i.e. the same numbering as
+ * date('w'). Mirrors bin/gcs/DayMask.h so masks can be passed to the
+ * native engines unchanged.
+ *
+ * RESPONSIBILITIES:
+ * - Convert between masks and the textual day forms used in the plugin
+ *   (planner "MoWeFr", RRULE BYDAY "MO,WE,FR", FPP day enum)
+ * - Set operations (overlap / containment) as integer AND/compare
+ *
+ * NON-GOALS:
+ * - No calendar or scheduler policy
+ */
+final class DayMask
+{
+    public const NONE = 0x00;
+    public const SU   = 0x01;
+    public const MO   = 0x02;
+    public const TU   = 0x04;
+    public const WE   = 0x08;
+    public const TH   = 0x10;
+    public const FR   = 0x20;
+    public const SA   = 0x40;
+    public const ALL  = 0x7F;
+
+    private const SHORT = ['Su', 'Mo', 'Tu', 'We', 'Th', 'Fr', 'Sa'];
+    private const BYDAY = ['SU', 'MO', 'TU', 'WE', 'TH', 'FR', 'SA'];
+
+    /**
+     * FPP scheduler "day" enum (ScheduleEntry.cpp) -> mask.
+     * 0..6 single weekday, 7 everyday, 8 weekdays, 9 weekends,
+     * 10 M/W/F, 11 T/Th, 12 Sun-Thu, 13 Fri/Sat.
+     */
+    private const FPP_ENUM_MASKS = [
+        0  => self::SU,
+        1  => self::MO,
+        2  => self::TU,
+        3  => self::WE,
+        4  => self::TH,
+        5  => self::FR,
+        6  => self::SA,
+        7  => self::ALL,
+        8  => self::MO | self::TU | self::WE | self::TH | self::FR,
+        9  => self::SU | self::SA,
+        10 => self::MO | self::WE | self::FR,
+        11 => self::TU | self::TH,
+        12 => self::SU | self::MO | self::TU | self::WE | self::TH,
+        13 => self::FR | self::SA,
+    ];
+
+    /* =====================================================================
+     * Construction
+     * ===================================================================== */
+
+    /** @param int $dow 0 = Sunday .. 6 = Saturday */
+    public static function fromDow(int $dow): int
+    {
+        return ($dow >= 0 && $dow < 7) ? (1 << $dow) : self::NONE;
+    }
+
+    /**
+     * Planner compact form ("MoWeFr"); unknown chunks are ignored.
+     */
+    public static function fromShort(string $days): int
+    {
+        $mask = self::NONE;
+        $len = strlen($days);
+        for ($i = 0; $i + 1 < $len; $i += 2) {
+            $dow = array_search(substr($days, $i, 2), self::SHORT, true);
+            if ($dow !== false) {
+                $mask |= 1 << $dow;
+            }
+        }
+        return $mask;
+    }
+
+    /**
+     * RRULE BYDAY list ("MO,WE,FR", "1SU,-1SA"); ordinals are dropped.
+     */
+    public static function fromByDay(string $byDay): int
+    {
+        $mask = self::NONE;
+        foreach (explode(',', strtoupper(trim($byDay))) as $d) {
+            $d = preg_replace('/^[+-]?\d+/', '', trim($d));
+            $dow = array_search($d, self::BYDAY, true);
+            if ($dow !== false) {
+                $mask |= 1 << $dow;
+            }
+        }
+        return $mask;
+    }
+
+    /** FPP day enum -> mask; NONE for unknown values */
+    public static function fromFppEnum(int $enum): int
+    {
+        return self::FPP_ENUM_MASKS[$enum] ?? self::NONE;
+    }
+
+    /* =====================================================================
+     * Conversion
+     * ===================================================================== */
+
+    /** Compact planner form, Sunday first */
+    public static function toShort(int $mask): string
+    {
+        $out = '';
+        foreach (self::SHORT as $dow => $code) {
+            if ($mask & (1 << $dow)) {
+                $out .= $code;
+            }
+        }
+        return $out;
+    }
+
+    /** RRULE BYDAY list, Sunday first */
+    public static function toByDay(int $mask): string
+    {
+        $out = [];
+        foreach (self::BYDAY as $dow => $code) {
+            if ($mask & (1 << $dow)) {
+                $out[] = $code;
+            }
+        }
+        return implode(',', $out);
+    }
+
+    /** Mask -> FPP day enum; null when FPP has no selector for this set */
+    public static function toFppEnum(int $mask): ?int
+    {
+        $enum = array_search($mask, self::FPP_ENUM_MASKS, true);
+        return ($enum === false) ? null : $enum;
+    }
+
+    /* =====================================================================
+     * Set operations
+     * ===================================================================== */
+
+    public static function has(int $mask, int $dow): bool
+    {
+        return ($mask & self::fromDow($dow)) !== 0;
+    }
+
+    public static function overlaps(int $a, int $b): bool
+    {
+        return ($a & $b) !== 0;
+    }
+
+    /** true if every day in $inner is also in $outer ($inner non-empty) */
+    public static function contains(int $inner, int $outer): bool
+    {
+        return $inner !== self::NONE && ($inner & $outer) === $inner;
+    }
+}
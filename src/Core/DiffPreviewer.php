@@ -101,7 +101,7 @@ final class DiffPreviewer
         }
 
         // Execute the only permitted write boundary
-        $applyResult = SchedulerApply::applyFromConfig($config);
+        $applyResult = SchedulerApply::applyFromConfig($config, $plan);
 
         return [
             'ok'    => true,
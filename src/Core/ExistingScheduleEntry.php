@@ -21,6 +21,11 @@ final class ExistingScheduleEntry
     /** @var array<string,mixed> */
     private array $raw;
 
+    /** Memoized identity / comparable digest (raw never changes) */
+    private ?string $uid = null;
+    private bool $uidResolved = false;
+    private ?string $digest = null;
+
     /**
      * @param array<string,mixed> $raw Raw scheduler.json entry
      */
@@ -29,6 +34,20 @@ final class ExistingScheduleEntry
         $this->raw = $raw;
     }
 
+    /**
+     * Wrap an entry whose identity key was already extracted
+     * (ScheduleInventory classifies each entry once).
+     *
+     * @param array<string,mixed> $raw Raw scheduler.json entry
+     */
+    public static function withKey(array $raw, ?string $uid): self
+    {
+        $entry = new self($raw);
+        $entry->uid = $uid;
+        $entry->uidResolved = true;
+        return $entry;
+    }
+
     /**
      * Extract the GCS identity key from this scheduler entry.
      *
@@ -36,7 +55,11 @@ final class ExistingScheduleEntry
      */
     public function getGcsUid(): ?string
     {
-        return SchedulerIdentity::extractKey($this->raw);
+        if (!$this->uidResolved) {
+            $this->uid = SchedulerIdentity::extractKey($this->raw);
+            $this->uidResolved = true;
+        }
+        return $this->uid;
     }
 
     /**
@@ -44,7 +67,18 @@ final class ExistingScheduleEntry
      */
     public function isGcsManaged(): bool
     {
-        return SchedulerIdentity::isGcsManaged($this->raw);
+        return $this->getGcsUid() !== null;
+    }
+
+    /**
+     * SchedulerComparator::digest() of this entry, computed once.
+     */
+    public function comparableDigest(): string
+    {
+        if ($this->digest === null) {
+            $this->digest = SchedulerComparator::digest($this->raw);
+        }
+        return $this->digest;
     }
 
     /**
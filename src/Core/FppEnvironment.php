@@ -7,10 +7,16 @@ declare(strict_types=1);
  * Runtime environment exported by FPP (via gcs-export).
  *
  * Responsibilities:
- * - Load runtime/fpp-env.json
+ * - Load runtime/fpp-env.bin (binary snapshot, preferred) or
+ *   runtime/fpp-env.json (debug / fallback format)
  * - Validate schema and structure
  * - Provide typed accessors for environment values
  *
+ * The binary snapshot is read by offset: only the header and the export
+ * errors are decoded on load; the sun, holiday, resolved-date and
+ * target-index sections are read on first use. getRaw() decodes the
+ * fpp-env.json written beside the snapshot on demand.
+ *
  * NON-GOALS:
  * - No scheduler logic
  * - No calendar logic
@@ -23,6 +29,22 @@ final class FppEnvironment
 {
     public const SCHEMA_VERSION = 1;
 
+    /** Binary snapshot format version (see bin/gcs/EnvSnapshot.h) */
+    public const SNAPSHOT_VERSION = 1;
+
+    private const SNAPSHOT_MAGIC       = 'GCSE';
+    private const SNAPSHOT_HEADER_SIZE = 96;
+    private const SNAPSHOT_DIR_ENTRY   = 16;
+
+    public const RUNTIME_JSON_PATH     = __DIR__ . '/../../runtime/fpp-env.json';
+    public const RUNTIME_SNAPSHOT_PATH = __DIR__ . '/../../runtime/fpp-env.bin';
+
+    /** Process-wide environment (loaded once per request) */
+    private static ?self $runtime = null;
+
+    /** @var array<int,string> Warnings produced when $runtime was loaded */
+    private static array $runtimeWarnings = [];
+
     /** @var bool */
     private bool $ok = false;
 
@@ -38,22 +60,77 @@ final class FppEnvironment
     /** @var ?string */
     private ?string $error = null;
 
+    /**
+     * Precomputed sun-times table (see gcs-export buildSunTable()).
+     *
+     * Null when absent or malformed. The exporter computes it from the
+     * same settings read as the exported coordinates/timezone, and a
+     * settings change re-exports; it is not re-validated here.
+     *
+     * @var array<string,mixed>|null
+     */
+    private ?array $sunTable = null;
+
+    /**
+     * Holiday definitions indexed by shortName (lazy).
+     *
+     * @var array<string,array<string,mixed>>|null
+     */
+    private ?array $holidays = null;
+
+    /**
+     * Holiday dates resolved by gcs-export (lazy):
+     *   ['startYear' => int, 'years' => int,
+     *    'dates' => [shortName => ['Y-m-d' | '' (unresolved), ...]]]
+     *
+     * @var array<string,mixed>|null
+     */
+    private ?array $holidayDates = null;
+
+    /**
+     * Media target index exported by gcs-export (lazy):
+     *   ['stamp' => string, 'playlists' => [name => true],
+     *    'sequences' => ['<name>.fseq' => true]]
+     * false = not provided; null = not read yet.
+     *
+     * @var array<string,mixed>|false|null
+     */
+    private $targetIndex = null;
+
+    /** Exporter input digest ('' = not provided; null = not read yet) */
+    private ?string $digest = null;
+
+    /** Binary snapshot path backing lazy section reads (null for JSON) */
+    private ?string $snapshotPath = null;
+
+    /**
+     * Binary snapshot section directory: id => [offset, length, count].
+     *
+     * @var array<string,array{offset:int,length:int,count:int}>
+     */
+    private array $snapshotSections = [];
+
     /**
      * Raw decoded environment payload.
      *
-     * Always initialized to avoid typed-property access errors.
+     * Always initialized to avoid typed-property access errors; for a
+     * snapshot it is loaded by getRaw().
      *
      * @var array<string,mixed>
      */
     private array $raw = [];
 
+    /** Snapshot only: getRaw() has read the JSON companion */
+    private bool $rawLoaded = true;
+
     private function __construct(
         bool $ok,
         ?float $latitude,
         ?float $longitude,
         ?string $timezone,
         ?string $error,
-        array $raw
+        array $raw,
+        ?array $sunTable = null
     ) {
         $this->ok        = $ok;
         $this->latitude  = $latitude;
@@ -61,12 +138,129 @@ final class FppEnvironment
         $this->timezone  = $timezone;
         $this->error     = $error;
         $this->raw       = $raw;
+        $this->sunTable  = $sunTable;
     }
 
     /* =====================================================================
      * Factory
      * ===================================================================== */
 
+    /**
+     * Load the plugin runtime environment once per process.
+     *
+     * Prefers the binary snapshot and falls back to fpp-env.json.
+     * Subsequent calls return the cached instance (and replay the
+     * original load warnings) instead of re-reading the files.
+     */
+    public static function loadRuntime(array &$warnings): self
+    {
+        if (self::$runtime === null) {
+            $loadWarnings = [];
+
+            self::$runtime =
+                self::loadFromSnapshotFile(self::RUNTIME_SNAPSHOT_PATH, $loadWarnings)
+                ?? self::loadFromFile(self::RUNTIME_JSON_PATH, $loadWarnings);
+
+            self::$runtimeWarnings = $loadWarnings;
+        }
+
+        foreach (self::$runtimeWarnings as $w) {
+            $warnings[] = $w;
+        }
+
+        return self::$runtime;
+    }
+
+    /**
+     * Load the binary snapshot header and section directory.
+     *
+     * Returns null (never throws) when the snapshot is missing or not
+     * usable, so callers can fall back to the JSON file.
+     */
+    public static function loadFromSnapshotFile(string $path, array &$warnings): ?self
+    {
+        if (!is_file($path)) {
+            return null;
+        }
+
+        $fh = @fopen($path, 'rb');
+        if ($fh === false) {
+            $warnings[] = "Unable to read FPP environment snapshot: {$path}";
+            return null;
+        }
+
+        try {
+            $header = fread($fh, self::SNAPSHOT_HEADER_SIZE);
+            if (
+                !is_string($header) ||
+                strlen($header) < self::SNAPSHOT_HEADER_SIZE ||
+                substr($header, 0, 4) !== self::SNAPSHOT_MAGIC
+            ) {
+                $warnings[] = 'Invalid FPP environment snapshot header.';
+                return null;
+            }
+
+            $h = unpack(
+                'vversion/vsections/Vflags/VheaderSize/elatitude/elongitude',
+                $header,
+                4
+            );
+
+            if ($h === false || $h['version'] !== self::SNAPSHOT_VERSION) {
+                $warnings[] = 'Unsupported FPP environment snapshot version.';
+                return null;
+            }
+
+            $dirSize = $h['sections'] * self::SNAPSHOT_DIR_ENTRY;
+            if (fseek($fh, $h['headerSize']) !== 0) {
+                $warnings[] = 'Truncated FPP environment snapshot.';
+                return null;
+            }
+
+            $dir = $dirSize > 0 ? fread($fh, $dirSize) : '';
+            if (!is_string($dir) || strlen($dir) < $dirSize) {
+                $warnings[] = 'Truncated FPP environment snapshot.';
+                return null;
+            }
+        } finally {
+            fclose($fh);
+        }
+
+        $sections = [];
+        for ($i = 0; $i < $h['sections']; $i++) {
+            $at = $i * self::SNAPSHOT_DIR_ENTRY;
+            $id = substr($dir, $at, 4);
+            $entry = unpack('Voffset/Vlength/Vcount', $dir, $at + 4);
+            if ($entry !== false) {
+                $sections[$id] = $entry;
+            }
+        }
+
+        $tz = rtrim(substr($header, 32, 64), "\0");
+
+        $env = new self(
+            ($h['flags'] & 1) === 1,
+            (float)$h['latitude'],
+            (float)$h['longitude'],
+            $tz !== '' ? $tz : null,
+            null,
+            []
+        );
+
+        $env->snapshotPath     = $path;
+        $env->snapshotSections = $sections;
+        $env->rawLoaded        = false;
+
+        if (isset($sections['EERR'])) {
+            $env->error = $env->readSnapshotErrors();
+            if ($env->error !== null && !$env->ok) {
+                $warnings[] = "FPP environment error: {$env->error}";
+            }
+        }
+
+        return $env;
+    }
+
     public static function loadFromFile(string $path, array &$warnings): self
     {
         if (!is_file($path)) {
@@ -106,22 +300,63 @@ final class FppEnvironment
 
         $error = is_string($decoded['error'] ?? null)
             ? $decoded['error']
-            : null;
+            : self::joinErrors($decoded['errors'] ?? null);
 
         if (!$ok && $error) {
             $warnings[] = "FPP environment error: {$error}";
         }
 
+        $sunTable = self::validateSunTable($decoded['sunTable'] ?? null, $warnings);
+
         return new self(
             $ok,
             $lat,
             $lon,
             $tz,
             $error,
-            $decoded
+            $decoded,
+            $sunTable
         );
     }
 
+    /**
+     * Accept the exported sun table if it is well-formed.
+     *
+     * @param mixed $table
+     * @return array<string,mixed>|null
+     */
+    private static function validateSunTable($table, array &$warnings): ?array
+    {
+        if (!is_array($table)) {
+            return null;
+        }
+
+        if (
+            !is_string($table['startDate'] ?? null) ||
+            !is_array($table['times'] ?? null)
+        ) {
+            $warnings[] = 'Ignoring malformed sun table in FPP environment.';
+            return null;
+        }
+
+        return $table;
+    }
+
+    /**
+     * gcs-export's "errors" list as one message (null when empty).
+     *
+     * @param mixed $errors
+     */
+    private static function joinErrors($errors): ?string
+    {
+        if (!is_array($errors)) {
+            return null;
+        }
+
+        $messages = array_values(array_filter(array_map('strval', $errors), 'strlen'));
+        return $messages !== [] ? implode('; ', $messages) : null;
+    }
+
     private static function invalid(string $error): self
     {
         return new self(false, null, null, null, $error, []);
@@ -156,13 +391,425 @@ final class FppEnvironment
         return $this->error;
     }
 
+    /**
+     * Content digest of the exporter inputs (settings, locale, table
+     * windows), or null for exports that predate it.
+     *
+     * Stable across re-exports while nothing changes, so downstream
+     * caches can key on it instead of file mtimes.
+     */
+    public function getDigest(): ?string
+    {
+        if ($this->digest === null) {
+            $digest = isset($this->snapshotSections['EDIG'])
+                ? $this->readSnapshotSection('EDIG')
+                : ($this->raw['envDigest'] ?? null);
+
+            $this->digest = (is_string($digest) && $digest !== '') ? $digest : '';
+        }
+
+        return ($this->digest !== '') ? $this->digest : null;
+    }
+
+    /**
+     * Precomputed sun-times table, or null if unavailable.
+     *
+     * @return array<string,mixed>|null
+     */
+    public function getSunTable(): ?array
+    {
+        if ($this->sunTable === null && isset($this->snapshotSections['SUNT'])) {
+            $this->sunTable = $this->readSnapshotSunTable();
+        }
+
+        return $this->sunTable;
+    }
+
+    /**
+     * Holiday definitions from the FPP locale, indexed by shortName.
+     *
+     * Each definition mirrors the FPP locale JSON shape
+     * (shortName, month, day, optional calc block).
+     *
+     * @return array<string,array<string,mixed>>
+     */
+    public function getHolidays(): array
+    {
+        if ($this->holidays !== null) {
+            return $this->holidays;
+        }
+
+        $this->holidays = isset($this->snapshotSections['HDEF'])
+            ? $this->readSnapshotHolidays()
+            : self::indexLocaleHolidays($this->raw['rawLocale']['holidays'] ?? null);
+
+        return $this->holidays;
+    }
+
+    /**
+     * Precomputed holiday dates, or null if the exporter did not
+     * provide them (older gcs-export or locale failure).
+     *
+     * @return array<string,mixed>|null
+     */
+    public function getHolidayDates(): ?array
+    {
+        if ($this->holidayDates !== null) {
+            return $this->holidayDates;
+        }
+
+        if (isset($this->snapshotSections['HDAT'])) {
+            $this->holidayDates = $this->readSnapshotHolidayDates();
+        } else {
+            $this->holidayDates = self::validateHolidayDates($this->raw['holidayDates'] ?? null);
+        }
+
+        return $this->holidayDates;
+    }
+
+    /**
+     * Playlist / sequence names found by gcs-export, or null if the
+     * exporter did not provide them (older gcs-export).
+     *
+     * The stamp is the TargetResolver::inventoryStamp() value at export
+     * time; callers must treat the index as stale when it differs.
+     *
+     * @return array<string,mixed>|null
+     */
+    public function getTargetIndex(): ?array
+    {
+        if ($this->targetIndex === null) {
+            $index = isset($this->snapshotSections['TIDX'])
+                ? $this->readSnapshotTargetIndex()
+                : self::validateTargetIndex($this->raw['targetIndex'] ?? null);
+
+            $this->targetIndex = $index ?? false;
+        }
+
+        return ($this->targetIndex !== false) ? $this->targetIndex : null;
+    }
+
+    /**
+     * @param mixed $index
+     * @return array<string,mixed>|null
+     */
+    private static function validateTargetIndex($index): ?array
+    {
+        if (
+            !is_array($index) ||
+            !is_string($index['stamp'] ?? null) ||
+            !is_array($index['playlists'] ?? null) ||
+            !is_array($index['sequences'] ?? null)
+        ) {
+            return null;
+        }
+
+        return [
+            'stamp'     => $index['stamp'],
+            'playlists' => array_fill_keys(array_map('strval', $index['playlists']), true),
+            'sequences' => array_fill_keys(array_map('strval', $index['sequences']), true),
+        ];
+    }
+
+    /**
+     * @param mixed $table
+     * @return array<string,mixed>|null
+     */
+    private static function validateHolidayDates($table): ?array
+    {
+        if (
+            !is_array($table) ||
+            !is_int($table['startYear'] ?? null) ||
+            !is_int($table['years'] ?? null) ||
+            !is_array($table['dates'] ?? null)
+        ) {
+            return null;
+        }
+
+        return [
+            'startYear' => $table['startYear'],
+            'years'     => $table['years'],
+            'dates'     => $table['dates'],
+        ];
+    }
+
+    /* =====================================================================
+     * Binary snapshot sections
+     * ===================================================================== */
+
+    private function readSnapshotSection(string $id): ?string
+    {
+        $sec = $this->snapshotSections[$id] ?? null;
+        if ($sec === null || $this->snapshotPath === null || $sec['length'] === 0) {
+            return null;
+        }
+
+        $fh = @fopen($this->snapshotPath, 'rb');
+        if ($fh === false) {
+            return null;
+        }
+
+        try {
+            if (fseek($fh, $sec['offset']) !== 0) {
+                return null;
+            }
+            $body = fread($fh, $sec['length']);
+        } finally {
+            fclose($fh);
+        }
+
+        return (is_string($body) && strlen($body) === $sec['length']) ? $body : null;
+    }
+
+    /**
+     * SUNT: i32 startEpochDay, u32 days, then days x 4 x u32.
+     *
+     * The rows stay packed; FPPSemantics unpacks a single row per lookup.
+     *
+     * @return array<string,mixed>|null
+     */
+    private function readSnapshotSunTable(): ?array
+    {
+        $body = $this->readSnapshotSection('SUNT');
+        if ($body === null || strlen($body) < 8) {
+            return null;
+        }
+
+        $h = unpack('VstartDay/Vdays', $body);
+        $startDay = $h['startDay'] >= 0x80000000 ? $h['startDay'] - 0x100000000 : $h['startDay'];
+
+        if (strlen($body) < 8 + $h['days'] * 16) {
+            return null;
+        }
+
+        return [
+            'startDay'  => $startDay,
+            'days'      => $h['days'],
+            'latitude'  => $this->latitude,
+            'longitude' => $this->longitude,
+            'timezone'  => $this->timezone,
+            'packed'    => substr($body, 8),
+        ];
+    }
+
+    /**
+     * HDEF: u16 nameLen, name, i8 month, i8 day, u8 calcType,
+     *       i8 calcMonth, i8 dow, i8 week, i16 offset.
+     *
+     * @return array<string,array<string,mixed>>
+     */
+    private function readSnapshotHolidays(): array
+    {
+        $body = $this->readSnapshotSection('HDEF');
+        if ($body === null) {
+            return [];
+        }
+
+        $out = [];
+        $len = strlen($body);
+        $at = 0;
+
+        while ($at + 2 <= $len) {
+            $nameLen = unpack('v', $body, $at)[1];
+            $at += 2;
+            if ($at + $nameLen + 8 > $len) {
+                break;
+            }
+
+            $name = substr($body, $at, $nameLen);
+            $at += $nameLen;
+
+            $r = unpack('cmonth/cday/Ctype/ccalcMonth/cdow/cweek/voffset', $body, $at);
+            $at += 8;
+
+            $def = [
+                'shortName' => $name,
+                'month'     => $r['month'],
+                'day'       => $r['day'],
+            ];
+
+            $offset = $r['offset'] >= 0x8000 ? $r['offset'] - 0x10000 : $r['offset'];
+
+            if ($r['type'] === 1) {
+                $def['calc'] = ['type' => 'easter', 'offset' => $offset];
+            } elseif ($r['type'] === 2 || $r['type'] === 3) {
+                $def['calc'] = [
+                    'type'  => ($r['type'] === 2) ? 'head' : 'tail',
+                    'month' => $r['calcMonth'],
+                    'dow'   => $r['dow'],
+                    'week'  => $r['week'],
+                ];
+            }
+
+            $out[$name] = $def;
+        }
+
+        return $out;
+    }
+
+    /**
+     * HDAT: i32 startYear, u32 years, then records of
+     *       u16 nameLen, name, years x i32 epochDay (-1 = unresolved).
+     *
+     * @return array<string,mixed>|null
+     */
+    private function readSnapshotHolidayDates(): ?array
+    {
+        $body = $this->readSnapshotSection('HDAT');
+        if ($body === null || strlen($body) < 8) {
+            return null;
+        }
+
+        $h = unpack('VstartYear/Vyears', $body);
+        $years = $h['years'];
+
+        $dates = [];
+        $len = strlen($body);
+        $at = 8;
+
+        while ($at + 2 <= $len) {
+            $nameLen = unpack('v', $body, $at)[1];
+            $at += 2;
+            if ($at + $nameLen + $years * 4 > $len) {
+                break;
+            }
+
+            $name = substr($body, $at, $nameLen);
+            $at += $nameLen;
+
+            $list = [];
+            foreach (unpack('V' . $years, $body, $at) ?: [] as $day) {
+                $list[] = ($day === 0xFFFFFFFF) ? '' : gmdate('Y-m-d', $day * 86400);
+            }
+            $at += $years * 4;
+
+            $dates[$name] = $list;
+        }
+
+        return [
+            'startYear' => $h['startYear'],
+            'years'     => $years,
+            'dates'     => $dates,
+        ];
+    }
+
+    /**
+     * EERR: count x (u16 len, message).
+     */
+    private function readSnapshotErrors(): ?string
+    {
+        $body = $this->readSnapshotSection('EERR');
+        if ($body === null) {
+            return null;
+        }
+
+        $errors = [];
+        $len = strlen($body);
+        $at = 0;
+        while ($at + 2 <= $len) {
+            $msgLen = unpack('v', $body, $at)[1];
+            $at += 2;
+            if ($at + $msgLen > $len) {
+                break;
+            }
+            $errors[] = substr($body, $at, $msgLen);
+            $at += $msgLen;
+        }
+
+        return self::joinErrors($errors);
+    }
+
+    /**
+     * TIDX: u16 stampLen, stamp, then records of
+     *       u8 kind (1 playlist, 2 sequence), u16 nameLen, name.
+     *
+     * @return array<string,mixed>|null
+     */
+    private function readSnapshotTargetIndex(): ?array
+    {
+        $body = $this->readSnapshotSection('TIDX');
+        if ($body === null || strlen($body) < 2) {
+            return null;
+        }
+
+        $len = strlen($body);
+        $stampLen = unpack('v', $body)[1];
+        if (2 + $stampLen > $len) {
+            return null;
+        }
+
+        $out = [
+            'stamp'     => substr($body, 2, $stampLen),
+            'playlists' => [],
+            'sequences' => [],
+        ];
+
+        $at = 2 + $stampLen;
+        while ($at + 3 <= $len) {
+            $r = unpack('Ckind/vnameLen', $body, $at);
+            $at += 3;
+            if ($at + $r['nameLen'] > $len) {
+                break;
+            }
+
+            $name = substr($body, $at, $r['nameLen']);
+            $at += $r['nameLen'];
+
+            if ($r['kind'] === 1) {
+                $out['playlists'][$name] = true;
+            } elseif ($r['kind'] === 2) {
+                $out['sequences'][$name] = true;
+            }
+        }
+
+        return $out;
+    }
+
+    /**
+     * Index raw FPP locale holidays strictly by shortName.
+     *
+     * @param mixed $holidays
+     * @return array<string,array<string,mixed>>
+     */
+    private static function indexLocaleHolidays($holidays): array
+    {
+        if (!is_array($holidays)) {
+            return [];
+        }
+
+        $out = [];
+        foreach ($holidays as $h) {
+            if (!is_array($h) || !isset($h['shortName']) || !is_string($h['shortName'])) {
+                continue;
+            }
+            // shortName is canonical and exact-match
+            $out[$h['shortName']] = $h;
+        }
+
+        return $out;
+    }
+
     /**
      * Raw environment payload (debug / diagnostics only).
      *
+     * A snapshot carries no raw payload; the fpp-env.json the same
+     * export wrote beside it is decoded on first use (empty when it is
+     * missing or unreadable).
+     *
      * @return array<string,mixed>
      */
     public function getRaw(): array
     {
+        if (!$this->rawLoaded) {
+            $this->rawLoaded = true;
+
+            $json = ($this->snapshotPath !== null)
+                ? @file_get_contents(dirname($this->snapshotPath) . '/' . basename(self::RUNTIME_JSON_PATH))
+                : false;
+            $decoded = is_string($json) ? json_decode($json, true) : null;
+            $this->raw = is_array($decoded) ? $decoded : [];
+        }
+
         return $this->raw;
     }
 
@@ -177,6 +824,7 @@ final class FppEnvironment
             'longitude' => $this->longitude,
             'timezone'  => $this->timezone,
             'error'     => $this->error,
+            'digest'    => $this->getDigest(),
         ];
     }
 }
\ No newline at end of file
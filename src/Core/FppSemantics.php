@@ -102,6 +102,36 @@ final class FPPSemantics
     public static function setEnvironment(array $env): void
     {
         self::$environment = $env;
+        self::resetResolutionMemo();
+    }
+
+    /**
+     * Precomputed sun table exported by gcs-export (optional).
+     *
+     * @var array<string,mixed>|null
+     */
+    private static ?array $sunTable = null;
+
+    /** Epoch day of sunTable.startDate (cached) */
+    private static ?int $sunTableStartDay = null;
+
+    /**
+     * Inject the exported sun table (null disables table lookups).
+     *
+     * @param array<string,mixed>|null $table
+     */
+    public static function setSunTable(?array $table): void
+    {
+        self::$sunTable = $table;
+        self::resetResolutionMemo();
+
+        if ($table === null) {
+            self::$sunTableStartDay = null;
+        } elseif (is_int($table['startDay'] ?? null)) {
+            self::$sunTableStartDay = $table['startDay'];
+        } else {
+            self::$sunTableStartDay = self::epochDayFromYmd((string)($table['startDate'] ?? ''));
+        }
     }
 
     public static function hasEnvironment(): bool
@@ -109,6 +139,13 @@ final class FPPSemantics
         return is_array(self::$environment);
     }
 
+    /** gcs-export input digest of the injected environment, if known */
+    public static function getEnvironmentDigest(): ?string
+    {
+        $digest = self::$environment['digest'] ?? null;
+        return (is_string($digest) && $digest !== '') ? $digest : null;
+    }
+
     public static function getLatitude(): ?float
     {
         return is_numeric(self::$environment['latitude'] ?? null)
@@ -134,6 +171,29 @@ final class FPPSemantics
      * Canonical DateTime construction
      * ===================================================================== */
 
+    /**
+     * Convert YYYY-MM-DD into days since 1970-01-01 (no timezone, no DateTime).
+     */
+    public static function epochDayFromYmd(string $ymd): ?int
+    {
+        if (!preg_match('/^(\d{4})-(\d{2})-(\d{2})$/', $ymd, $m)) {
+            return null;
+        }
+
+        $y = (int)$m[1];
+        $mo = (int)$m[2];
+        $d = (int)$m[3];
+
+        // days_from_civil (proleptic Gregorian)
+        $y -= ($mo <= 2) ? 1 : 0;
+        $era = intdiv($y >= 0 ? $y : $y - 399, 400);
+        $yoe = $y - $era * 400;
+        $doy = intdiv(153 * ($mo + ($mo > 2 ? -3 : 9)) + 2, 5) + $d - 1;
+        $doe = $yoe * 365 + intdiv($yoe, 4) - intdiv($yoe, 100) + $doy;
+
+        return $era * 146097 + $doe - 719468;
+    }
+
     public static function combineDateTime(
         string $ymd,
         string $hms
@@ -247,25 +307,17 @@ final class FPPSemantics
      * Day-of-week enum semantics
      * ===================================================================== */
 
+    /**
+     * FPP day enum -> RRULE BYDAY list (see DayMask for the enum table).
+     * Everyday (7) and unknown values yield '' (no BYDAY constraint).
+     */
     public static function dayEnumToByDay(int $enum): string
     {
-        return match ($enum) {
-            0  => 'SU',
-            1  => 'MO',
-            2  => 'TU',
-            3  => 'WE',
-            4  => 'TH',
-            5  => 'FR',
-            6  => 'SA',
-            7  => '',
-            8  => 'MO,TU,WE,TH,FR',
-            9  => 'SU,SA',
-            10 => 'MO,WE,FR',
-            11 => 'TU,TH',
-            12 => 'SU,MO,TU,WE,TH',
-            13 => 'FR,SA',
-            default => '',
-        };
+        $mask = DayMask::fromFppEnum($enum);
+        if ($mask === DayMask::ALL) {
+            return '';
+        }
+        return DayMask::toByDay($mask);
     }
 
     /* =====================================================================
@@ -301,6 +353,29 @@ final class FPPSemantics
             && in_array($value, self::SYMBOLIC_TIMES, true);
     }
 
+    /**
+     * Resolution memo tables (request-scoped).
+     *
+     * The export adapter resolves the same few (date, symbol, offset)
+     * and (date/holiday, fallback) tuples for entry after entry; each
+     * distinct tuple is estimated / resolved once. Both tables sit on
+     * the injected environment / sun table and are cleared whenever
+     * either is replaced. Hits and misses are stage-metrics counters
+     * (sunMemoHits / sunMemoMisses, dateMemoHits / dateMemoMisses).
+     *
+     * @var array<string,array<string,mixed>|null>
+     */
+    private static array $symbolicMemo = [];
+
+    /** @var array<string,string|null> */
+    private static array $dateMemo = [];
+
+    private static function resetResolutionMemo(): void
+    {
+        self::$symbolicMemo = [];
+        self::$dateMemo     = [];
+    }
+
     /**
      * Resolve symbolic time using runtime environment.
      */
@@ -313,6 +388,29 @@ final class FPPSemantics
             return null;
         }
 
+        $key = $date . '|' . $symbolic . '|' . $offsetMinutes;
+        if (!array_key_exists($key, self::$symbolicMemo)) {
+            GcsMetrics::count('sunMemoMisses');
+            self::$symbolicMemo[$key] = self::computeSymbolicTime($date, $symbolic, $offsetMinutes);
+        } else {
+            GcsMetrics::count('sunMemoHits');
+        }
+
+        $resolved = self::$symbolicMemo[$key];
+        if ($resolved === null) {
+            return null;
+        }
+
+        // Callers own the DateTime they get back
+        $resolved['datetime'] = clone $resolved['datetime'];
+        return $resolved;
+    }
+
+    private static function computeSymbolicTime(
+        string $date,
+        string $symbolic,
+        int $offsetMinutes
+    ): ?array {
         $lat = self::getLatitude();
         $lon = self::getLongitude();
 
@@ -320,14 +418,22 @@ final class FPPSemantics
             return null;
         }
 
-        $display = SunTimeEstimator::estimate(
-            $date,
-            $symbolic,
-            $lat,
-            $lon,
-            $offsetMinutes,
-            self::DEFAULT_ROUNDING_MINUTES
-        );
+        $base = self::lookupSunTable($date, $symbolic);
+
+        $display = ($base !== null)
+            ? SunTimeEstimator::formatSeconds(
+                $base,
+                $offsetMinutes,
+                self::DEFAULT_ROUNDING_MINUTES
+            )
+            : SunTimeEstimator::estimate(
+                $date,
+                $symbolic,
+                $lat,
+                $lon,
+                $offsetMinutes,
+                self::DEFAULT_ROUNDING_MINUTES
+            );
 
         if (!$display) {
             return null;
@@ -348,6 +454,49 @@ final class FPPSemantics
         ];
     }
 
+    /**
+     * O(1) sun table lookup.
+     *
+     * @return int|null Unrounded seconds since local midnight, or null
+     *                  when the date falls outside the exported table.
+     */
+    private static function lookupSunTable(string $date, string $symbolic): ?int
+    {
+        if (self::$sunTable === null || self::$sunTableStartDay === null) {
+            return null;
+        }
+
+        $day = self::epochDayFromYmd($date);
+        if ($day === null) {
+            return null;
+        }
+
+        $col = match ($symbolic) {
+            'Dawn'    => 0,
+            'SunRise' => 1,
+            'SunSet'  => 2,
+            'Dusk'    => 3,
+            default   => null,
+        };
+        if ($col === null) {
+            return null;
+        }
+
+        $idx = $day - self::$sunTableStartDay;
+
+        // Binary snapshot: rows stay packed (4 x u32 per day)
+        if (isset(self::$sunTable['packed'])) {
+            if ($idx < 0 || $idx >= (int)self::$sunTable['days']) {
+                return null;
+            }
+            return unpack('V', self::$sunTable['packed'], ($idx * 16) + ($col * 4))[1];
+        }
+
+        $row = self::$sunTable['times'][$idx] ?? null;
+
+        return (is_array($row) && is_int($row[$col] ?? null)) ? $row[$col] : null;
+    }
+
     /* =====================================================================
      * Date resolution (sentinel + holidays)
      * ===================================================================== */
@@ -360,11 +509,35 @@ final class FPPSemantics
     ): ?string {
         $raw = trim($raw);
 
-        error_log(
-            '[GCS DEBUG][FPPSemantics::resolveDate] context=' . $context .
-            ' raw=' . ($raw !== '' ? $raw : '(empty)') .
-            ' fallbackDate=' . ($fallbackDate ?? '(null)')
-        );
+        // Sentinel years and the holiday season heuristic follow "today"
+        $key = $raw . '|' . ($fallbackDate ?? '') . '|' . date('Y-m-d');
+        if (array_key_exists($key, self::$dateMemo)) {
+            GcsMetrics::count('dateMemoHits');
+            if (self::$dateMemo[$key] === null) {
+                $warnings[] = "Export: {$context} '{$raw}' invalid.";
+            }
+            return self::$dateMemo[$key];
+        }
+        GcsMetrics::count('dateMemoMisses');
+
+        self::$dateMemo[$key] = self::computeDate($raw, $fallbackDate, $warnings, $context);
+        return self::$dateMemo[$key];
+    }
+
+    /**
+     * @param array<int,string> $warnings
+     */
+    private static function computeDate(
+        string $raw,
+        ?string $fallbackDate,
+        array &$warnings,
+        string $context
+    ): ?string {
+        GcsTrace::event(GcsTrace::SEMANTICS, 'resolve_date', [
+            'context'      => $context,
+            'raw'          => $raw,
+            'fallbackDate' => $fallbackDate,
+        ], GcsTrace::DETAIL);
 
         // Absolute date
         if (preg_match('/^\d{4}-\d{2}-\d{2}$/', $raw)) {
@@ -388,10 +561,10 @@ final class FPPSemantics
                 ? (int)substr($fallbackDate, 0, 4)
                 : $currentYear;
 
-            error_log(
-                '[GCS DEBUG][FPPSemantics::resolveDate] attempting holiday resolve ' .
-                $raw . ' using yearHint=' . $yearHint
-            );
+            GcsTrace::event(GcsTrace::SEMANTICS, 'holiday_attempt', [
+                'holiday'  => $raw,
+                'yearHint' => $yearHint,
+            ], GcsTrace::DETAIL);
 
             $dt = HolidayResolver::dateFromHoliday($raw, $yearHint);
 
@@ -401,11 +574,11 @@ final class FPPSemantics
                 $futureCutoff = (clone $today)->modify('+180 days');
                 if ($dt > $futureCutoff) {
                     $altYear = $yearHint - 1;
-                    error_log(
-                        '[GCS DEBUG][FPPSemantics::resolveDate] holiday ' . $raw .
-                        ' resolved far-future (' . $dt->format('Y-m-d') .
-                        '), retrying with yearHint=' . $altYear
-                    );
+                    GcsTrace::event(GcsTrace::SEMANTICS, 'holiday_far_future', static fn(): array => [
+                        'holiday'  => $raw,
+                        'resolved' => $dt->format('Y-m-d'),
+                        'yearHint' => $altYear,
+                    ], GcsTrace::DETAIL);
                     $alt = HolidayResolver::dateFromHoliday($raw, $altYear);
                     if ($alt instanceof DateTime) {
                         $dt = $alt;
@@ -420,12 +593,12 @@ final class FPPSemantics
                 $fb = DateTime::createFromFormat('Y-m-d', $fallbackDate);
                 if ($fb instanceof DateTime && $dt < $fb) {
                     $altYear = $yearHint + 1;
-                    error_log(
-                        '[GCS DEBUG][FPPSemantics::resolveDate] holiday ' . $raw .
-                        ' resolved before fallback (' . $dt->format('Y-m-d') .
-                        ' < ' . $fb->format('Y-m-d') .
-                        '), retrying with yearHint=' . $altYear
-                    );
+                    GcsTrace::event(GcsTrace::SEMANTICS, 'holiday_before_fallback', static fn(): array => [
+                        'holiday'  => $raw,
+                        'resolved' => $dt->format('Y-m-d'),
+                        'fallback' => $fb->format('Y-m-d'),
+                        'yearHint' => $altYear,
+                    ], GcsTrace::DETAIL);
                     $alt = HolidayResolver::dateFromHoliday($raw, $altYear);
                     if ($alt instanceof DateTime) {
                         $dt = $alt;
@@ -435,18 +608,18 @@ final class FPPSemantics
             }
 
             if ($dt instanceof DateTime) {
-                error_log(
-                    '[GCS DEBUG][FPPSemantics::resolveDate] holiday ' .
-                    $raw . ' resolved to ' . $dt->format('Y-m-d')
-                );
+                GcsTrace::event(GcsTrace::SEMANTICS, 'holiday_resolved', static fn(): array => [
+                    'holiday'  => $raw,
+                    'resolved' => $dt->format('Y-m-d'),
+                ], GcsTrace::DETAIL);
                 return $dt->format('Y-m-d');
             }
         }
 
-        error_log(
-            '[GCS DEBUG][FPPSemantics::resolveDate] FAILED to resolve ' .
-            $raw . ' in context=' . $context
-        );
+        GcsTrace::event(GcsTrace::SEMANTICS, 'resolve_date_failed', [
+            'context' => $context,
+            'raw'     => $raw,
+        ]);
         $warnings[] = "Export: {$context} '{$raw}' invalid.";
         return null;
     }
@@ -8,17 +8,39 @@ declare(strict_types=1);
  *
  * Responsibilities:
  * - Format log lines consistently
- * - Append log entries to the configured log file
+ * - Buffer entries per request and append them to the configured log
+ *   file in one write (at shutdown, or once FLUSH_BYTES are pending)
+ * - Rotate the file by size: log -> log.1 -> ... -> log.<keep>; a
+ *   writer that waited for the lock reopens if the file was rotated
+ *   away meanwhile (see openLocked())
+ *
+ * Formats (config runtime.log.format):
+ * - text   : [Y-m-d H:i:s] LEVEL message {"ctx":...}
+ * - ndjson : {"ts":"<ISO 8601>","level","src":"php","msg","ctx"}
+ *
+ * gcs-export writes the same formats to the same file (bin/gcs/Log.h);
+ * see env() for the settings handed to it.
  *
  * HARD GUARANTEES:
  * - No exceptions thrown
- * - No dependency on plugin state
- * - No side effects beyond file append
+ * - No dependency on plugin state (settings are read from the
+ *   persisted config on first flush)
+ * - No side effects beyond file append / rotation
  *
  * This class is intentionally minimal and static.
  */
 final class GcsLog
 {
+    private const FLUSH_BYTES = 16384;
+
+    /** Pending lines, not yet written */
+    private static string $buffer = '';
+
+    private static bool $shutdownRegistered = false;
+
+    /** @var array{format:string,max_bytes:int,keep:int}|null */
+    private static ?array $settings = null;
+
     /**
      * Write a single log entry.
      *
@@ -28,18 +50,159 @@ final class GcsLog
      */
     private static function write(string $level, string $msg, array $ctx = []): void
     {
-        $line = sprintf(
-            "[%s] %s %s",
-            date('Y-m-d H:i:s'),
-            $level,
-            $msg
-        );
-
-        if (!empty($ctx)) {
-            $line .= ' ' . json_encode($ctx, JSON_UNESCAPED_SLASHES);
+        try {
+            if (self::settings()['format'] === 'ndjson') {
+                $record = [
+                    'ts'    => date('c'),
+                    'level' => $level,
+                    'src'   => 'php',
+                    'msg'   => $msg,
+                ];
+                if (!empty($ctx)) {
+                    $record['ctx'] = $ctx;
+                }
+                $line = json_encode($record, JSON_UNESCAPED_SLASHES | JSON_INVALID_UTF8_SUBSTITUTE);
+                if (!is_string($line)) {
+                    return;
+                }
+            } else {
+                $line = sprintf(
+                    "[%s] %s %s",
+                    date('Y-m-d H:i:s'),
+                    $level,
+                    $msg
+                );
+
+                if (!empty($ctx)) {
+                    $line .= ' ' . json_encode($ctx, JSON_UNESCAPED_SLASHES);
+                }
+            }
+
+            self::$buffer .= $line . "\n";
+
+            if (!self::$shutdownRegistered) {
+                self::$shutdownRegistered = true;
+                register_shutdown_function([self::class, 'flush']);
+            }
+
+            if (strlen(self::$buffer) >= self::FLUSH_BYTES) {
+                self::flush();
+            }
+        } catch (Throwable $e) {
+            // Logging must never break the caller
+        }
+    }
+
+    /**
+     * Append pending entries to GCS_LOG_PATH, rotating first when the
+     * write would take the file past runtime.log.max_bytes.
+     */
+    public static function flush(): void
+    {
+        if (self::$buffer === '') {
+            return;
+        }
+
+        $data = self::$buffer;
+        self::$buffer = '';
+
+        try {
+            $fh = self::openLocked();
+            if ($fh === false) {
+                return;
+            }
+
+            $settings = self::settings();
+            $stat = @fstat($fh);
+            $size = is_array($stat) ? (int)$stat['size'] : 0;
+
+            if ($settings['max_bytes'] > 0 && $size > 0 && $size + strlen($data) > $settings['max_bytes']) {
+                self::rotate($settings['keep']);
+                fclose($fh); // releases the lock on the rotated file
+
+                $fh = self::openLocked();
+                if ($fh === false) {
+                    return;
+                }
+            }
+
+            @fwrite($fh, $data);
+            @fflush($fh);
+            fclose($fh);
+        } catch (Throwable $e) {
+            // A lost log write is not fatal
         }
+    }
 
-        file_put_contents(GCS_LOG_PATH, $line . "\n", FILE_APPEND);
+    /**
+     * Environment for a gcs-export child so it logs into the same stream.
+     * Pending entries are flushed first to keep the file in order.
+     *
+     * @return array<string,string>
+     */
+    public static function env(): array
+    {
+        self::flush();
+
+        $settings = self::settings();
+        return [
+            'GCS_LOG_PATH'      => GCS_LOG_PATH,
+            'GCS_LOG_FORMAT'    => $settings['format'],
+            'GCS_LOG_MAX_BYTES' => (string)$settings['max_bytes'],
+            'GCS_LOG_KEEP'      => (string)$settings['keep'],
+        ];
+    }
+
+    /**
+     * @return array{format:string,max_bytes:int,keep:int}
+     */
+    private static function settings(): array
+    {
+        if (self::$settings === null) {
+            $log = (array)(Config::load()['runtime']['log'] ?? []);
+            self::$settings = [
+                'format'    => (($log['format'] ?? 'text') === 'ndjson') ? 'ndjson' : 'text',
+                'max_bytes' => max(0, (int)($log['max_bytes'] ?? 0)),
+                'keep'      => max(1, (int)($log['keep'] ?? 1)),
+            ];
+        }
+        return self::$settings;
+    }
+
+    /**
+     * Open and lock the current log file. Another writer may rotate it
+     * while we wait for the lock, leaving the handle on log.1; reopen
+     * until the locked inode is the one at GCS_LOG_PATH.
+     *
+     * @return resource|false
+     */
+    private static function openLocked()
+    {
+        for ($attempt = 0; $attempt < 8; $attempt++) {
+            $fh = @fopen(GCS_LOG_PATH, 'ab');
+            if ($fh === false) {
+                return false;
+            }
+            @flock($fh, LOCK_EX);
+
+            clearstatcache(true, GCS_LOG_PATH);
+            $held = @fstat($fh);
+            $cur  = @stat(GCS_LOG_PATH);
+            if (!is_array($held) || !is_array($cur)
+                || ($held['dev'] === $cur['dev'] && $held['ino'] === $cur['ino'])) {
+                return $fh;
+            }
+            fclose($fh);
+        }
+        return @fopen(GCS_LOG_PATH, 'ab');
+    }
+
+    private static function rotate(int $keep): void
+    {
+        for ($i = $keep - 1; $i >= 1; $i--) {
+            @rename(GCS_LOG_PATH . '.' . $i, GCS_LOG_PATH . '.' . ($i + 1));
+        }
+        @rename(GCS_LOG_PATH, GCS_LOG_PATH . '.1');
     }
 
     /**
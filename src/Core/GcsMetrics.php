@@ -0,0 +1,184 @@
+<?php
+declare(strict_types=1);
+
+/**
+ * GcsMetrics
+ *
+ * Per-request stage timings and counters for plan / apply.
+ *
+ * A run is opened with begin() and closed with end($scope), normally
+ * through measure(), which closes it even when the body throws; runs
+ * nest (apply opens one around plan), and only the outermost end()
+ * appends the record to METRICS_FILE. Stages accumulate wall time and call
+ * count; peakKb is the process peak memory when the stage last ended.
+ *
+ * Record (one JSON object per line, shared with gcs-export, see
+ * bin/gcs/Metrics.h):
+ *   {"ts","src":"php","scope","totalMs","peakKb",
+ *    "stages":{"<stage>":{"ms","calls","peakKb"}},"counters":{...}}
+ *
+ * HARD RULES:
+ * - Never throws
+ * - start()/stop() outside a run are no-ops
+ *
+ * NON-GOALS:
+ * - No aggregation; the file is a raw append log, rotated once it
+ *   reaches ROTATE_BYTES (previous file kept as .1)
+ */
+final class GcsMetrics
+{
+    public const METRICS_FILE = 'metrics.jsonl';
+
+    private const ROTATE_BYTES = 262144;
+
+    private static int $depth = 0;
+
+    private static float $runStart = 0.0;
+
+    /** @var array<string,array{ms:float,calls:int,peakKb:int}> */
+    private static array $stages = [];
+
+    /** @var array<string,float> stage => start time of the open span */
+    private static array $open = [];
+
+    /** @var array<string,int|float|bool> */
+    private static array $counters = [];
+
+    public static function begin(): void
+    {
+        if (self::$depth++ === 0) {
+            self::$runStart = microtime(true);
+            self::$stages   = [];
+            self::$open     = [];
+            self::$counters = [];
+        }
+    }
+
+    /**
+     * Close the run; the outermost call appends the record.
+     *
+     * @return array<string,mixed> snapshot()
+     */
+    public static function end(string $scope): array
+    {
+        $snapshot = self::snapshot();
+        if (self::$depth > 0 && --self::$depth === 0) {
+            self::append($scope, $snapshot);
+        }
+        return $snapshot;
+    }
+
+    /**
+     * Run $fn as one metrics run and add the snapshot to its result as
+     * 'metrics'. The run is closed when $fn throws too (recorded with
+     * the "failed" counter), so a long-lived worker never stays nested.
+     *
+     * @param callable(): array<string,mixed> $fn
+     * @return array<string,mixed>
+     */
+    public static function measure(string $scope, callable $fn): array
+    {
+        self::begin();
+        try {
+            $result = $fn();
+        } catch (Throwable $e) {
+            self::set('failed', true);
+            throw $e;
+        } finally {
+            $metrics = self::end($scope);
+        }
+
+        $result['metrics'] = $metrics;
+        return $result;
+    }
+
+    public static function start(string $stage): void
+    {
+        if (self::$depth > 0) {
+            self::$open[$stage] = microtime(true);
+        }
+    }
+
+    public static function stop(string $stage): void
+    {
+        if (!isset(self::$open[$stage])) {
+            return;
+        }
+
+        $ms = (microtime(true) - self::$open[$stage]) * 1000.0;
+        unset(self::$open[$stage]);
+
+        $s = self::$stages[$stage] ?? ['ms' => 0.0, 'calls' => 0, 'peakKb' => 0];
+        $s['ms']    += $ms;
+        $s['calls'] += 1;
+        $s['peakKb'] = intdiv(memory_get_peak_usage(), 1024);
+        self::$stages[$stage] = $s;
+    }
+
+    public static function count(string $name, int $n = 1): void
+    {
+        if (self::$depth > 0) {
+            self::$counters[$name] = (int)(self::$counters[$name] ?? 0) + $n;
+        }
+    }
+
+    /**
+     * @param int|float|bool $value
+     */
+    public static function set(string $name, $value): void
+    {
+        if (self::$depth > 0) {
+            self::$counters[$name] = $value;
+        }
+    }
+
+    /**
+     * Current run so far (stages still open are not included).
+     *
+     * @return array<string,mixed>
+     */
+    public static function snapshot(): array
+    {
+        $stages = [];
+        foreach (self::$stages as $name => $s) {
+            $stages[$name] = [
+                'ms'     => round($s['ms'], 2),
+                'calls'  => $s['calls'],
+                'peakKb' => $s['peakKb'],
+            ];
+        }
+
+        return [
+            'totalMs'  => round((microtime(true) - self::$runStart) * 1000.0, 2),
+            'peakKb'   => intdiv(memory_get_peak_usage(), 1024),
+            'stages'   => $stages,
+            'counters' => self::$counters,
+        ];
+    }
+
+    /**
+     * @param array<string,mixed> $snapshot
+     */
+    private static function append(string $scope, array $snapshot): void
+    {
+        $snapshot['stages']   = (object)$snapshot['stages'];
+        $snapshot['counters'] = (object)$snapshot['counters'];
+
+        $line = json_encode(
+            ['ts' => date('c'), 'src' => 'php', 'scope' => $scope] + $snapshot,
+            JSON_UNESCAPED_SLASHES
+        );
+        if (!is_string($line)) {
+            return;
+        }
+
+        $path = NativeEngine::RUNTIME_DIR . '/' . self::METRICS_FILE;
+
+        $size = @filesize($path);
+        if ($size !== false && $size >= self::ROTATE_BYTES) {
+            @rename($path, $path . '.1');
+        }
+
+        @file_put_contents($path, $line . "\n", FILE_APPEND | LOCK_EX);
+    }
+}
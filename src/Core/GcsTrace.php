@@ -0,0 +1,151 @@
+<?php
+declare(strict_types=1);
+
+/**
+ * GcsTrace
+ *
+ * Opt-in diagnostic tracing, by category and level.
+ *
+ * Levels (per category):
+ * - OFF     : nothing is evaluated or written (default)
+ * - SUMMARY : stage-level events
+ * - DETAIL  : per-item events and full data dumps
+ *
+ * Enabled via:
+ * - config['runtime']['trace'][<category>] = <level>
+ * - export GCS_TRACE="ordering:2,runner" (a bare category means DETAIL;
+ *   overrides config)
+ * - legacy: runtime.debug_ordering / GCS_DEBUG_ORDERING -> ordering DETAIL
+ *
+ * Output (DIR):
+ * - gcs_trace_<category>.jsonl : events, one JSON object per line
+ * - dump() files under the caller's file name
+ *
+ * HARD RULES:
+ * - Never throws
+ * - Callers guard expensive payloads with enabled() or pass a closure,
+ *   so a disabled category costs one array lookup
+ */
+final class GcsTrace
+{
+    public const OFF     = 0;
+    public const SUMMARY = 1;
+    public const DETAIL  = 2;
+
+    public const PARSER    = 'parser';
+    public const RUNNER    = 'runner';
+    public const ORDERING  = 'ordering';
+    public const INVENTORY = 'inventory';
+    public const EXPORT    = 'export';
+    public const SEMANTICS = 'semantics';
+
+    public const DIR = '/tmp';
+
+    /** @var array<string,int>|null category => level (null = not resolved yet) */
+    private static ?array $levels = null;
+
+    /**
+     * Resolve levels from $cfg (and the environment). Without a call,
+     * the persisted config is loaded on first use.
+     *
+     * @param array<string,mixed> $cfg
+     */
+    public static function configure(array $cfg): void
+    {
+        $levels = [];
+        foreach ((array)($cfg['runtime']['trace'] ?? []) as $category => $level) {
+            if (is_string($category) && is_numeric($level)) {
+                $levels[$category] = max(self::OFF, min(self::DETAIL, (int)$level));
+            }
+        }
+
+        $legacy = getenv('GCS_DEBUG_ORDERING');
+        if (!empty($cfg['runtime']['debug_ordering']) || ($legacy !== false && $legacy !== '' && $legacy !== '0')) {
+            $levels[self::ORDERING] = self::DETAIL;
+        }
+
+        $env = getenv('GCS_TRACE');
+        if (is_string($env) && $env !== '') {
+            foreach (explode(',', $env) as $item) {
+                $parts = explode(':', trim($item), 2);
+                if ($parts[0] !== '') {
+                    $levels[$parts[0]] = isset($parts[1])
+                        ? max(self::OFF, min(self::DETAIL, (int)$parts[1]))
+                        : self::DETAIL;
+                }
+            }
+        }
+
+        self::$levels = $levels;
+    }
+
+    public static function enabled(string $category, int $level = self::SUMMARY): bool
+    {
+        if (self::$levels === null) {
+            self::configure(Config::load());
+        }
+        return (self::$levels[$category] ?? self::OFF) >= $level;
+    }
+
+    /**
+     * Append one event to the category's JSONL file.
+     *
+     * @param array<string,mixed>|Closure $data Closure: evaluated only when enabled
+     */
+    public static function event(string $category, string $tag, $data = [], int $level = self::SUMMARY): void
+    {
+        if (!self::enabled($category, $level)) {
+            return;
+        }
+
+        $line = json_encode([
+            'ts'   => date('c'),
+            'tag'  => $tag,
+            'data' => ($data instanceof Closure) ? $data() : $data,
+        ], JSON_UNESCAPED_SLASHES);
+
+        if (is_string($line)) {
+            @file_put_contents(self::eventPath($category), $line . PHP_EOL, FILE_APPEND);
+        }
+    }
+
+    /**
+     * Replace DIR/$file with $content (a closure is only evaluated when
+     * the category is enabled at $level).
+     *
+     * @param string|Closure $content
+     */
+    public static function dump(string $category, string $file, $content, int $level = self::DETAIL): void
+    {
+        if (!self::enabled($category, $level)) {
+            return;
+        }
+
+        $body = ($content instanceof Closure) ? $content() : $content;
+        if (is_string($body)) {
+            @file_put_contents(self::DIR . '/' . $file, $body);
+        }
+    }
+
+    /**
+     * Start a fresh trace for $category (events file + listed dumps).
+     *
+     * @param array<int,string> $dumpFiles
+     */
+    public static function reset(string $category, array $dumpFiles = []): void
+    {
+        if (!self::enabled($category)) {
+            return;
+        }
+
+        @unlink(self::eventPath($category));
+        foreach ($dumpFiles as $file) {
+            @unlink(self::DIR . '/' . $file);
+        }
+    }
+
+    private static function eventPath(string $category): string
+    {
+        return self::DIR . '/gcs_trace_' . $category . '.jsonl';
+    }
+}
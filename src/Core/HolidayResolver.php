@@ -12,6 +12,9 @@ declare(strict_types=1);
  * - schedule.json stores shortName values (e.g. "NewYearsEve")
  * - UI "name" is NOT used for resolution
  * - All rules come from FPP (no hard-coded tables)
+ * - Dates precomputed by gcs-export (holidayDates) are used when the
+ *   year falls inside the exported window; the rule calculation below
+ *   is only the fallback outside it
  *
  * This class is PURE:
  * - No I/O
@@ -27,6 +30,13 @@ final class HolidayResolver
      */
     private static ?array $holidayIndex = null;
 
+    /**
+     * Cached exporter holiday date table (false = not available).
+     *
+     * @var array<string,mixed>|false|null
+     */
+    private static $holidayDates = null;
+
     /* ============================================================
      * Public API
      * ============================================================ */
@@ -41,6 +51,15 @@ final class HolidayResolver
      */
     public static function dateFromHoliday(string $shortName, int $year): ?DateTime
     {
+        $table = self::getHolidayDates();
+        if ($table !== null) {
+            $slot = $year - $table['startYear'];
+            if ($slot >= 0 && $slot < $table['years'] && isset($table['dates'][$shortName])) {
+                $ymd = $table['dates'][$shortName][$slot] ?? '';
+                return ($ymd !== '') ? new DateTime($ymd) : null;
+            }
+        }
+
         $index = self::getHolidayIndex();
         if ($index === []) {
             return null;
@@ -55,17 +74,11 @@ final class HolidayResolver
         // Calculated holiday (FPP uses month/day=0 with a calc block)
         if (isset($def['calc']) && is_array($def['calc'])) {
             $dt = self::resolveCalculatedHoliday($def['calc'], $year);
-            if ($dt instanceof DateTime) {
-                error_log(
-                    '[GCS DEBUG][HolidayResolver] ' .
-                    $shortName . ' ' . $year . ' resolved to ' . $dt->format('Y-m-d')
-                );
-            } else {
-                error_log(
-                    '[GCS DEBUG][HolidayResolver] ' .
-                    $shortName . ' ' . $year . ' failed to resolve'
-                );
-            }
+            GcsTrace::event(GcsTrace::SEMANTICS, 'holiday_calc', static fn(): array => [
+                'holiday'  => $shortName,
+                'year'     => $year,
+                'resolved' => ($dt instanceof DateTime) ? $dt->format('Y-m-d') : null,
+            ], GcsTrace::DETAIL);
             return $dt;
         }
 
@@ -104,37 +117,32 @@ final class HolidayResolver
             return self::$holidayIndex;
         }
 
-        // The environment is already loaded during bootstrap
-        // and exposed via Config / runtime paths.
+        // Shared runtime environment (loaded once per request by bootstrap;
+        // served from the binary snapshot when available)
         $warnings = [];
-        $envPath  = __DIR__ . '/../../runtime/fpp-env.json';
-
-        if (!is_file($envPath)) {
-            return self::$holidayIndex;
-        }
-
-        $env = FppEnvironment::loadFromFile($envPath, $warnings);
-        $raw = $env->getRaw();
+        self::$holidayIndex = FppEnvironment::loadRuntime($warnings)->getHolidays();
 
-        $holidays = $raw['rawLocale']['holidays'] ?? null;
-        if (!is_array($holidays)) {
-            return self::$holidayIndex;
-        }
+        return self::$holidayIndex;
+    }
 
-        foreach ($holidays as $h) {
-            if (!is_array($h)) {
-                continue;
-            }
+    /**
+     * Exporter-resolved holiday dates, or null when unavailable.
+     *
+     * @return array<string,mixed>|null
+     */
+    private static function getHolidayDates(): ?array
+    {
+        if (self::$holidayDates === null) {
+            self::$holidayDates = false;
 
-            if (!isset($h['shortName']) || !is_string($h['shortName'])) {
-                continue;
+            if (class_exists('FppEnvironment')) {
+                $warnings = [];
+                self::$holidayDates =
+                    FppEnvironment::loadRuntime($warnings)->getHolidayDates() ?? false;
             }
-
-            // shortName is canonical and exact-match
-            self::$holidayIndex[$h['shortName']] = $h;
         }
 
-        return self::$holidayIndex;
+        return (self::$holidayDates === false) ? null : self::$holidayDates;
     }
 
     /**
@@ -16,7 +16,8 @@ declare(strict_types=1);
  *
  * NON-GOALS:
  * - No scheduler knowledge
- * - No horizon trimming logic beyond basic end-time filtering
+ * - No horizon trimming logic beyond dropping expired events /
+ *   finished series and events that start after horizonEnd
  * - No intent consolidation
  * - No side effects outside logging
  *
@@ -43,8 +44,10 @@ final class IcsParser
      * Parse raw ICS content into structured event records.
      *
      * @param string        $ics        Raw ICS text
-     * @param DateTime|null $now        Optional "now" for pruning expired non-recurring events
-     * @param DateTime      $horizonEnd Upper bound used by caller (not enforced here)
+     * @param DateTime|null $now        Optional "now" for pruning expired events and
+     *                                  finished series (isFinishedSeries())
+     * @param DateTime      $horizonEnd Events starting after this are dropped (overrides
+     *                                  are kept while their RECURRENCE-ID is not)
      *
      * @return array<int,array<string,mixed>> Normalized event records
      */
@@ -122,21 +125,20 @@ final class IcsParser
                 $exDates        = [];
                 $recurrenceId   = null;
 
-                if (preg_match('/UID:(.+)/', $raw, $m)) {
-                    $uid = trim($m[1]);
-                }
-
-                if (preg_match('/SUMMARY:(.+)/', $raw, $m)) {
-                    $summary = trim($m[1]);
+                // Pruning needs DTSTART / RECURRENCE-ID / DTEND / RRULE
+                // only; the other properties are decoded for live events
+                if (preg_match('/DTSTART([^:]*):(.+)/', $raw, $m)) {
+                    [$dtstart, $isAllDay] = $this->parseDateWithTimezone($m[2], $m[1]);
                 }
 
-                if (preg_match('/DESCRIPTION:(.+)/s', $raw, $m)) {
-                    // Normalize Google Calendar literal "\n"
-                    $description = str_replace('\n', "\n", trim($m[1]));
+                if (preg_match('/RECURRENCE-ID([^:]*):(.+)/', $raw, $m)) {
+                    $recurrenceId = $this->parseDateWithTimezone($m[2], $m[1])[0];
                 }
 
-                if (preg_match('/DTSTART([^:]*):(.+)/', $raw, $m)) {
-                    [$dtstart, $isAllDay] = $this->parseDateWithTimezone($m[2], $m[1]);
+                // Skip events beyond the horizon; an override still replaces
+                // an in-horizon instance, so it is kept while its RECURRENCE-ID is
+                if ($dtstart && $dtstart > $horizonEnd && ($recurrenceId === null || $recurrenceId > $horizonEnd)) {
+                    continue;
                 }
 
                 if (preg_match('/DTEND([^:]*):(.+)/', $raw, $m)) {
@@ -148,17 +150,14 @@ final class IcsParser
                     $rrule = $this->parseRrule($m[1]);
                 }
 
-                if (preg_match_all('/EXDATE([^:]*):([^\r\n]+)/', $raw, $m, PREG_SET_ORDER)) {
-                    foreach ($m as $ex) {
-                        $exDates = array_merge(
-                            $exDates,
-                            $this->parseExDates($ex[2], $ex[1])
-                        );
-                    }
+                // Skip fully-expired events and finished series
+                if ($now && $dtstart && $dtend &&
+                    (empty($rrule) ? $dtend < $now : $this->isFinishedSeries($rrule, $dtstart, $dtend, $now))) {
+                    continue;
                 }
 
-                if (preg_match('/RECURRENCE-ID([^:]*):(.+)/', $raw, $m)) {
-                    $recurrenceId = $this->parseDateWithTimezone($m[2], $m[1])[0];
+                if (preg_match('/UID:(.+)/', $raw, $m)) {
+                    $uid = trim($m[1]);
                 }
 
                 // Minimal validity check
@@ -166,9 +165,22 @@ final class IcsParser
                     continue;
                 }
 
-                // Skip fully-expired non-recurring events
-                if ($now && $dtend < $now && empty($rrule)) {
-                    continue;
+                if (preg_match('/SUMMARY:(.+)/', $raw, $m)) {
+                    $summary = trim($m[1]);
+                }
+
+                if (preg_match('/DESCRIPTION:(.+)/s', $raw, $m)) {
+                    // Normalize Google Calendar literal "\n"
+                    $description = str_replace('\n', "\n", trim($m[1]));
+                }
+
+                if (preg_match_all('/EXDATE([^:]*):([^\r\n]+)/', $raw, $m, PREG_SET_ORDER)) {
+                    foreach ($m as $ex) {
+                        $exDates = array_merge(
+                            $exDates,
+                            $this->parseExDates($ex[2], $ex[1])
+                        );
+                    }
                 }
 
                 $events[] = [
@@ -269,6 +281,84 @@ final class IcsParser
         return $out;
     }
 
+    /**
+     * True when the series provably has no instance ending at or after
+     * $now (twin of IcsPushParser::seriesFinished()): the last start is
+     * bounded by UNTIL, or for a plain COUNT rule by COUNT periods of the
+     * longest gap FREQ allows. A day of slack covers zone interpretation;
+     * any rule that cannot be bounded is kept.
+     *
+     * @param array<string,string> $rrule
+     */
+    private function isFinishedSeries(array $rrule, DateTime $dtstart, DateTime $dtend, DateTime $now): bool
+    {
+        $day      = 86400;
+        $duration = max(0, $dtend->getTimestamp() - $dtstart->getTimestamp());
+
+        if (isset($rrule['UNTIL'])) {
+            $until = $this->parseUntil((string)$rrule['UNTIL']);
+            return $until !== null && $until + $duration + $day < $now->getTimestamp();
+        }
+
+        $count    = (string)($rrule['COUNT'] ?? '');
+        $interval = (string)($rrule['INTERVAL'] ?? '1');
+        if (!preg_match('/^\d{1,6}$/', $count) || !preg_match('/^\d{1,4}$/', $interval) || (int)$interval < 1) {
+            return false;
+        }
+
+        $byDay = false;
+        foreach (array_keys($rrule) as $key) {
+            if (!str_starts_with((string)$key, 'BY')) {
+                continue;
+            }
+            if ($key !== 'BYDAY') {
+                return false;
+            }
+            $byDay = true;
+        }
+
+        // Longest gap between two instances. BYDAY: at least one per
+        // week (DAILY / WEEKLY only). MONTHLY / YEARLY: exact only while
+        // every month has the DTSTART day.
+        $freq = strtoupper((string)($rrule['FREQ'] ?? ''));
+        $gap  = 0;
+        if ($byDay) {
+            $gap = in_array($freq, ['DAILY', 'WEEKLY'], true) ? 7 * $day : 0;
+        } elseif ($freq === 'DAILY') {
+            $gap = $day;
+        } elseif ($freq === 'WEEKLY') {
+            $gap = 7 * $day;
+        } elseif ((int)$dtstart->format('j') <= 28) {
+            $gap = ['MONTHLY' => 31 * $day, 'YEARLY' => 366 * $day][$freq] ?? 0;
+        }
+        if ($gap === 0) {
+            return false;
+        }
+
+        // With BYDAY the first week may hold none of the instances
+        $periods = (int)$count + ($byDay ? 1 : 0);
+        return $dtstart->getTimestamp() + $periods * (int)$interval * $gap + $duration + $day < $now->getTimestamp();
+    }
+
+    /**
+     * UNTIL as SchedulerPlanner reads it (date = 23:59:59, floating =
+     * FPP timezone), as a timestamp.
+     */
+    private function parseUntil(string $value): ?int
+    {
+        if (preg_match('/^\d{8}$/', $value)) {
+            $dt = DateTime::createFromFormat('!YmdHis', $value . '235959', $this->fppTz);
+        } elseif (preg_match('/^\d{8}T\d{6}Z$/', $value)) {
+            $dt = DateTime::createFromFormat('!Ymd\THis\Z', $value, new DateTimeZone('UTC'));
+        } elseif (preg_match('/^\d{8}T\d{6}$/', $value)) {
+            $dt = DateTime::createFromFormat('!Ymd\THis', $value, $this->fppTz);
+        } else {
+            return null;
+        }
+
+        return $dt ? $dt->getTimestamp() : null;
+    }
+
     /**
      * Parse EXDATE values into DateTime list.
      *
@@ -9,10 +9,16 @@ declare(strict_types=1);
  * - Uses the FPP system timezone (date_default_timezone_get()) with TZID + VTIMEZONE
  * - DTSTART/DTEND are local wall-clock times
  * - YAML metadata is embedded as fenced YAML in DESCRIPTION
+ * - Lines are folded at 75 octets (RFC 5545 3.1), never inside a UTF-8 sequence
  * - Output is deterministic and round-trip safe
+ *
+ * bin/gcs-export export-ics writes the same calendar natively (see
+ * bin/gcs/IcsExport.h); keep the two in step.
  */
 final class IcsWriter
 {
+    private const FOLD_OCTETS = 75;
+
     /**
      * @param array<int,array<string,mixed>> $events Export intents
      */
@@ -31,23 +37,25 @@ final class IcsWriter
 
         $lines = array_merge($lines, self::buildVtimezone($tz));
 
+        $seenUids = [];
         foreach ($events as $ev) {
             if (!is_array($ev)) {
                 continue;
             }
-            $lines = array_merge($lines, self::buildEventBlock($ev, $tzName));
+            $lines = array_merge($lines, self::buildEventBlock($ev, $tzName, $seenUids));
         }
 
         $lines[] = 'END:VCALENDAR';
 
-        return implode("\r\n", $lines) . "\r\n";
+        return implode("\r\n", array_map([self::class, 'foldLine'], $lines)) . "\r\n";
     }
 
     /**
      * @param array<string,mixed> $ev
+     * @param array<string,int> $seenUids Generated UID counts for this calendar
      * @return array<int,string>
      */
-    private static function buildEventBlock(array $ev, string $tzName): array
+    private static function buildEventBlock(array $ev, string $tzName, array &$seenUids): array
     {
         /** @var DateTime $dtStart */
         $dtStart = $ev['dtstart'];
@@ -68,11 +76,15 @@ final class IcsWriter
             }
         }
 
+        $start    = $dtStart->format('Ymd\THis');
+        $end      = $dtEnd->format('Ymd\THis');
+        $yamlText = !empty($yaml) ? self::emitYamlBlock($yaml) : '';
+
         $lines = [];
         $lines[] = 'BEGIN:VEVENT';
 
-        $lines[] = 'DTSTART;TZID=' . $tzName . ':' . $dtStart->format('Ymd\THis');
-        $lines[] = 'DTEND;TZID='   . $tzName . ':' . $dtEnd->format('Ymd\THis');
+        $lines[] = 'DTSTART;TZID=' . $tzName . ':' . $start;
+        $lines[] = 'DTEND;TZID='   . $tzName . ':' . $end;
 
         if (is_string($rrule) && $rrule !== '') {
             $lines[] = 'RRULE:' . $rrule;
@@ -86,13 +98,19 @@ final class IcsWriter
             $lines[] = 'SUMMARY:' . self::escapeText($summary);
         }
 
-        if (!empty($yaml)) {
-            $yamlText = self::emitYamlBlock($yaml);
-            $lines[]  = 'DESCRIPTION:' . self::escapeText($yamlText);
+        if ($yamlText !== '') {
+            $lines[] = 'DESCRIPTION:' . self::escapeText($yamlText);
+        }
+
+        if ($uid === '') {
+            $uid = self::generateUid(
+                $summary . "\n" . $start . "\n" . $end . "\n" . (is_string($rrule) ? $rrule : '') . "\n" . $yamlText,
+                $seenUids
+            );
         }
 
         $lines[] = 'DTSTAMP:' . gmdate('Ymd\THis\Z');
-        $lines[] = 'UID:' . ($uid !== '' ? $uid : self::generateUid());
+        $lines[] = 'UID:' . $uid;
 
         $lines[] = 'END:VEVENT';
 
@@ -235,8 +253,49 @@ final class IcsWriter
         return $text;
     }
 
-    private static function generateUid(): string
+    /**
+     * Content-derived UID, so re-exports of an unchanged schedule keep
+     * their UIDs; the n-th identical event gets a "-n" suffix.
+     *
+     * @param array<string,int> $seenUids
+     */
+    private static function generateUid(string $content, array &$seenUids): string
+    {
+        $hash = hash('fnv1a64', $content);
+        $n = $seenUids[$hash] = ($seenUids[$hash] ?? 0) + 1;
+
+        return 'gcs-export-' . $hash . ($n > 1 ? '-' . $n : '') . '@local';
+    }
+
+    /**
+     * Fold one content line: 75 octets, then 74 per continuation after
+     * the leading space. A cut never splits a UTF-8 sequence.
+     */
+    private static function foldLine(string $line): string
     {
-        return uniqid('gcs-export-', true) . '@local';
+        $len = strlen($line);
+        if ($len <= self::FOLD_OCTETS) {
+            return $line;
+        }
+
+        $out   = '';
+        $at    = 0;
+        $limit = self::FOLD_OCTETS;
+
+        while ($len - $at > $limit) {
+            $cut = $at + $limit;
+            while ($cut > $at && (ord($line[$cut]) & 0xC0) === 0x80) {
+                $cut--;
+            }
+            if ($cut === $at) {
+                $cut = $at + $limit;
+            }
+
+            $out  .= substr($line, $at, $cut - $at) . "\r\n ";
+            $at    = $cut;
+            $limit = self::FOLD_OCTETS - 1;
+        }
+
+        return $out . substr($line, $at);
     }
 }
\ No newline at end of file
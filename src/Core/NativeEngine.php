@@ -0,0 +1,639 @@
+<?php
+declare(strict_types=1);
+
+/**
+ * NativeEngine
+ *
+ * Thin bridge to the native subcommands of bin/gcs-export.
+ *
+ * RESPONSIBILITIES:
+ * - Locate the exporter binary and decide whether native paths are usable
+ * - Run a subcommand and decode its JSON result, or the binary record
+ *   stream of the bulk subcommands (NativeRecords)
+ * - Return null on ANY failure so callers fall back to the PHP code path
+ *
+ * HARD RULES:
+ * - Never throws
+ * - Output shapes are identical to the PHP implementations they replace
+ * - Disabled by runtime.native_engine = false
+ * - runtime.native_json = true keeps the bulk subcommands on JSON
+ *   (debugging; same arrays, slower to decode)
+ *
+ * NON-GOALS:
+ * - No scheduler logic
+ * - No caching (callers own that)
+ */
+final class NativeEngine
+{
+    public const BINARY_PATH = __DIR__ . '/../../bin/gcs-export';
+
+    /** ICS cache (ics-cache-<key>.ics / .json per URL) lives here */
+    public const RUNTIME_DIR = __DIR__ . '/../../runtime';
+
+    /** Pipe read size (exec()) */
+    private const READ_CHUNK = 65536;
+
+    /* =====================================================================
+     * Availability
+     * ===================================================================== */
+
+    /**
+     * @param array<string,mixed> $cfg
+     */
+    public static function isEnabled(array $cfg): bool
+    {
+        if (!($cfg['runtime']['native_engine'] ?? true)) {
+            return false;
+        }
+
+        return is_file(self::BINARY_PATH) && is_executable(self::BINARY_PATH);
+    }
+
+    /* =====================================================================
+     * Subcommands
+     * ===================================================================== */
+
+    /**
+     * Conditional download of every calendar into RUNTIME_DIR, fetched
+     * and parsed concurrently (a 304 parses the cached body instead).
+     *
+     * Returns one entry per URL, in order: ['status' =>
+     * 'fetched'|'not_modified', 'path' => cached body, 'digest' =>
+     * hash('fnv1a64') of the body, 'events' => IcsParser::parse()
+     * shape], or null for a calendar that must be fetched in PHP.
+     * With $parse = false the bodies are only cached (no 'events').
+     * Returns null when the engine is unavailable.
+     *
+     * @param array<string,mixed> $cfg
+     * @param array<int,string> $urls
+     * @return array<int,array{status:string,path:string,digest:string,events?:array<int,array<string,mixed>>}|null>|null
+     */
+    public static function fetchCalendars(
+        array $cfg,
+        array $urls,
+        ?DateTime $now,
+        ?DateTime $horizonEnd,
+        bool $parse = true
+    ): ?array {
+        $urls = array_values($urls);
+        if ($urls === [] || !self::isEnabled($cfg)) {
+            return null;
+        }
+
+        // URLs carry the calendar's secret token: stdin, never argv
+        $request = json_encode(['urls' => $urls], JSON_UNESCAPED_SLASHES);
+        if (!is_string($request)) {
+            return null;
+        }
+
+        $args = ['fetch-ics', '-', '--cache-dir=' . self::RUNTIME_DIR];
+        if ($parse) {
+            $args   = array_merge($args, ['--parse'], self::parseArgs($now, $horizonEnd));
+            $result = self::runBulk($cfg, $args, $request);
+        } else {
+            $result = self::run($args, $request);
+        }
+        if ($result === null) {
+            return null;
+        }
+
+        // A single URL prints its calendar object directly (JSON only;
+        // a record stream always lists its calendars)
+        $calendars = $result['calendars'] ?? ((count($urls) === 1) ? [$result] : null);
+        if (!is_array($calendars) || count($calendars) !== count($urls)) {
+            return null;
+        }
+
+        $out = [];
+        foreach ($calendars as $i => $cal) {
+            $status = $cal['status'] ?? null;
+            $path   = $cal['path'] ?? null;
+            $digest = $cal['digest'] ?? null;
+            if (empty($cal['ok']) || !in_array($status, ['fetched', 'not_modified'], true) ||
+                !is_string($path) || !is_string($digest) || $digest === '' ||
+                ($parse && !is_array($cal['events'] ?? null))) {
+                GcsLogger::instance()->warn('Native ICS fetch failed; using PHP path', [
+                    // Index only: the URL carries the calendar's secret token
+                    'calendar' => $i + 1,
+                ]);
+                $out[] = null;
+                continue;
+            }
+
+            GcsLogger::instance()->info('ICS fetch', [
+                'status'    => $status,
+                'bytes'     => (int)($cal['bytes'] ?? 0),
+                'wireBytes' => (int)($cal['wireBytes'] ?? 0),
+                'events'    => $parse ? count($cal['events']) : null,
+                'dropped'   => (int)($cal['droppedBeyondHorizon'] ?? 0),
+                'expired'   => (int)($cal['droppedExpired'] ?? 0),
+            ]);
+
+            $entry = ['status' => $status, 'path' => $path, 'digest' => $digest];
+            if ($parse) {
+                self::warnIfTzDefaulted($cal);
+                $entry['events'] = $cal['events'];
+            }
+            $out[] = $entry;
+        }
+
+        return $out;
+    }
+
+    /**
+     * Native IcsParser::parse().
+     *
+     * @param array<string,mixed> $cfg
+     * @return array<int,array<string,mixed>>|null Same shape as IcsParser::parse()
+     */
+    public static function parseIcs(array $cfg, string $ics, ?DateTime $now, ?DateTime $horizonEnd = null): ?array
+    {
+        if (!self::isEnabled($cfg)) {
+            return null;
+        }
+
+        $tmp = @tempnam(sys_get_temp_dir(), 'gcs-ics-');
+        if ($tmp === false) {
+            return null;
+        }
+
+        try {
+            if (@file_put_contents($tmp, $ics) !== strlen($ics)) {
+                return null;
+            }
+            return self::parseIcsFile($cfg, $tmp, $now, $horizonEnd);
+        } finally {
+            @unlink($tmp);
+        }
+    }
+
+    /**
+     * Native IcsParser::parse() on an ICS file (the engine maps it, so
+     * the body never has to be loaded into PHP).
+     *
+     * @param array<string,mixed> $cfg
+     * @return array<int,array<string,mixed>>|null Same shape as IcsParser::parse()
+     */
+    public static function parseIcsFile(array $cfg, string $path, ?DateTime $now, ?DateTime $horizonEnd = null): ?array
+    {
+        if (!self::isEnabled($cfg)) {
+            return null;
+        }
+
+        $result = self::runBulk($cfg, array_merge(['parse-ics', $path], self::parseArgs($now, $horizonEnd)));
+        if (is_array($result['calendars'] ?? null)) {
+            $result = $result['calendars'][0] ?? null;
+        }
+        if ($result === null || !is_array($result['events'] ?? null)) {
+            return null;
+        }
+
+        self::warnIfTzDefaulted($result);
+
+        return $result['events'];
+    }
+
+    /**
+     * @return array<int,string>
+     */
+    private static function parseArgs(?DateTime $now, ?DateTime $horizonEnd): array
+    {
+        $args = ['--tz=' . date_default_timezone_get()];
+        if ($now !== null) {
+            $args[] = '--now=' . $now->getTimestamp();
+        }
+        if ($horizonEnd !== null) {
+            $args[] = '--horizon-end=' . $horizonEnd->getTimestamp();
+        }
+        return $args;
+    }
+
+    /**
+     * @param array<string,mixed> $result
+     */
+    private static function warnIfTzDefaulted(array $result): void
+    {
+        if (!empty($result['calendarTzDefaulted'])) {
+            GcsLogger::instance()->warn(
+                'ICS calendar timezone missing; defaulting to FPP timezone',
+                ['fpp_tz' => date_default_timezone_get()]
+            );
+        }
+    }
+
+    /**
+     * Bulk occurrence expansion for SchedulerRunner.
+     *
+     * Each job: ['base' => ?array event, 'overrides' => [rid => event]].
+     * Returns one entry per job: a list of
+     * ['start', 'end', 'isOverride'] occurrences, or null when that
+     * series must be expanded in PHP (RRULE parts the engine does not
+     * support).
+     *
+     * @param array<string,mixed> $cfg
+     * @param array<int,array<string,mixed>> $jobs
+     * @return array<int,array<int,array<string,mixed>>|null>|null
+     */
+    public static function expandOccurrences(
+        array $cfg,
+        array $jobs,
+        DateTime $horizonStart,
+        DateTime $horizonEnd
+    ): ?array {
+        if ($jobs === [] || !self::isEnabled($cfg)) {
+            return null;
+        }
+
+        $series = [];
+        foreach ($jobs as $job) {
+            $base = is_array($job['base'] ?? null) ? $job['base'] : null;
+
+            $overrides = [];
+            foreach (($job['overrides'] ?? []) as $rid => $ov) {
+                $overrides[] = [
+                    'rid'   => (string)$rid,
+                    'start' => (string)($ov['start'] ?? ''),
+                    'end'   => (string)($ov['end'] ?? ''),
+                ];
+            }
+
+            $series[] = [
+                'start'     => $base ? (string)($base['start'] ?? '') : null,
+                'end'       => $base ? (string)($base['end'] ?? '') : null,
+                'rrule'     => ($base && !empty($base['rrule'])) ? $base['rrule'] : null,
+                'exDates'   => $base ? array_values((array)($base['exDates'] ?? [])) : [],
+                'overrides' => $overrides,
+            ];
+        }
+
+        $request = json_encode([
+            'horizonStart' => $horizonStart->format('Y-m-d H:i:s'),
+            'horizonEnd'   => $horizonEnd->format('Y-m-d H:i:s'),
+            'series'       => $series,
+        ], JSON_UNESCAPED_SLASHES);
+
+        if (!is_string($request)) {
+            return null;
+        }
+
+        $result = self::runBulk(
+            $cfg,
+            ['expand', '--tz=' . date_default_timezone_get()],
+            $request
+        );
+
+        if ($result === null || !is_array($result['series'] ?? null) ||
+            count($result['series']) !== count($jobs)) {
+            return null;
+        }
+
+        return $result['series'];
+    }
+
+    /**
+     * Native SchedulerPlanner dominance relaxation.
+     *
+     * $bundles must already be in baseline order. Returns the reordered
+     * bundles plus the pass/swap counters, or null when the PHP loop must
+     * run instead (non-array base, malformed date range, or a mutually
+     * dominating pair).
+     *
+     * @param array<string,mixed> $cfg
+     * @param array<int,array<string,mixed>> $bundles
+     * @return array{bundles:array<int,array<string,mixed>>,passes:int,swaps:int}|null
+     */
+    public static function orderBundles(array $cfg, array $bundles, int $maxPasses): ?array
+    {
+        if (count($bundles) < 2 || !self::isEnabled($cfg)) {
+            return null;
+        }
+
+        $bundles = array_values($bundles);
+
+        $packed = [];
+        foreach ($bundles as $bundle) {
+            $base = $bundle['base'] ?? null;
+            if (!is_array($base)) {
+                return null;
+            }
+
+            $dayMask = $base['range']['dayMask'] ?? null;
+            if (!is_int($dayMask)) {
+                $dayMask = DayMask::fromShort((string)($base['range']['days'] ?? ''));
+            }
+
+            $packed[] = [
+                'start'     => (string)($base['range']['start'] ?? ''),
+                'end'       => (string)($base['range']['end'] ?? ''),
+                'dayMask'   => $dayMask,
+                'startTime' => substr((string)($base['template']['start'] ?? ''), 11),
+                'endTime'   => substr((string)($base['template']['end'] ?? ''), 11),
+            ];
+        }
+
+        $request = json_encode([
+            'maxPasses' => $maxPasses,
+            'bundles'   => $packed,
+        ], JSON_UNESCAPED_SLASHES);
+
+        if (!is_string($request)) {
+            return null;
+        }
+
+        $result = self::run(['order'], $request);
+        if ($result === null || !is_array($result['order'] ?? null) ||
+            count($result['order']) !== count($bundles)) {
+            return null;
+        }
+
+        $ordered = [];
+        foreach ($result['order'] as $idx) {
+            if (!is_int($idx) || !isset($bundles[$idx])) {
+                return null;
+            }
+            $ordered[] = $bundles[$idx];
+        }
+
+        return [
+            'bundles' => $ordered,
+            'passes'  => (int)($result['passes'] ?? 0),
+            'swaps'   => (int)($result['swaps'] ?? 0),
+        ];
+    }
+
+    /**
+     * Minimal-rewrite schedule.json update (SchedulerApply).
+     *
+     * $layout is one ['keep' => index into the schedule as read] or
+     * ['entry' => array] per output entry. Kept entries retain their
+     * bytes; the previous file is recoverable from a rotating delta
+     * backup, and the newest one also from .prev (a hard link to the
+     * replaced file, not a copy). Returns ['backup' => delta path ('' if the file was
+     * already up to date), 'bytes' => new size], or null when the
+     * caller must write the file itself (nothing was changed then).
+     *
+     * $expectDigest is hash('fnv1a64') of the schedule.json bytes the
+     * layout was planned against (ScheduleInventory::digest()); the
+     * native side refuses to patch a file whose bytes differ. Without
+     * it the patch is not attempted.
+     *
+     * @param array<string,mixed> $cfg
+     * @param array<int,array<string,mixed>> $layout
+     * @return array{backup:string,bytes:int}|null
+     */
+    public static function applySchedule(array $cfg, string $path, array $layout, string $expectDigest): ?array
+    {
+        if (!self::isEnabled($cfg) || $expectDigest === '') {
+            return null;
+        }
+
+        $entries = [];
+        foreach ($layout as $item) {
+            if (isset($item['keep'])) {
+                $entries[] = ['keep' => (int)$item['keep']];
+                continue;
+            }
+
+            $json = json_encode($item['entry'] ?? null, JSON_PRETTY_PRINT | JSON_UNESCAPED_SLASHES);
+            if (!is_string($json)) {
+                return null;
+            }
+            $entries[] = ['json' => $json];
+        }
+
+        $request = json_encode([
+            'path'          => $path,
+            'expectDigest'  => $expectDigest,
+            'backupStamp'   => date('Ymd-His'),
+            'keepBackups'   => SchedulerSync::SCHEDULE_BACKUPS_KEPT,
+            'entries'       => $entries,
+        ], JSON_UNESCAPED_SLASHES);
+        if (!is_string($request)) {
+            return null;
+        }
+
+        $result = self::run(['apply-schedule'], $request);
+        if ($result === null) {
+            return null;
+        }
+
+        GcsLogger::instance()->info('schedule.json patched', [
+            'kept'      => (int)($result['kept'] ?? 0),
+            'written'   => (int)($result['written'] ?? 0),
+            'bytes'     => (int)($result['bytes'] ?? 0),
+            'unchanged' => !empty($result['unchanged']),
+        ]);
+
+        return [
+            'backup' => (string)($result['backup'] ?? ''),
+            'bytes'  => (int)($result['bytes'] ?? 0),
+        ];
+    }
+
+    /**
+     * Stream an ICS export of schedule entries to $outPath
+     * (ExportService). Environment comes from the runtime fpp-env.json;
+     * the zone is the current PHP default, as IcsWriter uses. Returns
+     * ['events', 'skipped', 'bytes', 'warnings'], or null when the
+     * caller must export in PHP ($outPath is left untouched then).
+     *
+     * @param array<string,mixed> $cfg
+     * @param array<int,array<string,mixed>> $entries
+     * @return array{events:int,skipped:int,bytes:int,warnings:array<int,string>}|null
+     */
+    public static function exportIcs(array $cfg, array $entries, string $outPath): ?array
+    {
+        if (!self::isEnabled($cfg)) {
+            return null;
+        }
+
+        $request = json_encode(array_values($entries), JSON_UNESCAPED_SLASHES);
+        if (!is_string($request)) {
+            return null;
+        }
+
+        $result = self::run([
+            'export-ics',
+            '-',
+            '--out=' . $outPath,
+            '--env-dir=' . self::RUNTIME_DIR,
+            '--tz=' . date_default_timezone_get(),
+        ], $request);
+        if ($result === null) {
+            return null;
+        }
+
+        return [
+            'events'   => (int)($result['events'] ?? 0),
+            'skipped'  => (int)($result['skipped'] ?? 0),
+            'bytes'    => (int)($result['bytes'] ?? 0),
+            'warnings' => array_values(array_map('strval', (array)($result['warnings'] ?? []))),
+        ];
+    }
+
+    /* =====================================================================
+     * Process execution
+     * ===================================================================== */
+
+    /**
+     * Run a subcommand and decode its JSON stdout.
+     *
+     * @param array<int,string> $args
+     * @param string|null $stdin Request body written to the child's stdin
+     * @return array<string,mixed>|null
+     */
+    public static function run(array $args, ?string $stdin = null): ?array
+    {
+        $stdout = self::exec($args, $stdin);
+        if ($stdout === null) {
+            return null;
+        }
+
+        $decoded = json_decode($stdout, true);
+        if (!is_array($decoded) || empty($decoded['ok'])) {
+            GcsLogger::instance()->warn('Native engine returned invalid output; using PHP path', [
+                'command' => $args[0] ?? '',
+            ]);
+            return null;
+        }
+
+        return $decoded;
+    }
+
+    /**
+     * Run a bulk subcommand (parse-ics, fetch-ics --parse, expand) with
+     * binary record output, decoded by NativeRecords. Returns what the
+     * JSON output decodes to, except that calendars always come as
+     * ['calendars' => [...]].
+     *
+     * @param array<string,mixed> $cfg
+     * @param array<int,string> $args
+     * @return array<string,mixed>|null
+     */
+    private static function runBulk(array $cfg, array $args, ?string $stdin = null): ?array
+    {
+        if (!empty($cfg['runtime']['native_json'])) {
+            return self::run($args, $stdin);
+        }
+
+        // Records are decoded as they arrive; the stream is never held whole
+        $decoder = new NativeRecords();
+        $stdout  = self::exec(
+            array_merge($args, ['--format=bin']),
+            $stdin,
+            static function (string $chunk) use ($decoder): void {
+                GcsMetrics::start('native_decode');
+                $decoder->feed($chunk);
+                GcsMetrics::stop('native_decode');
+            }
+        );
+        if ($stdout === null) {
+            return null;
+        }
+
+        $decoded = $decoder->finish();
+
+        if ($decoded === null) {
+            GcsLogger::instance()->warn('Native engine returned invalid output; using PHP path', [
+                'command' => $args[0] ?? '',
+            ]);
+            return null;
+        }
+
+        return $decoded;
+    }
+
+    /**
+     * Run a subcommand; its raw stdout, or null when it could not run or
+     * exited non-zero.
+     *
+     * stdout and stderr are read together in READ_CHUNK pieces as the
+     * child writes them. With $sink, each stdout chunk is handed to it
+     * instead of being collected (the return value is then ''); a sink
+     * must tolerate being fed output of a run that later fails.
+     *
+     * @param array<int,string> $args
+     * @param (callable(string):void)|null $sink
+     */
+    private static function exec(array $args, ?string $stdin, ?callable $sink = null): ?string
+    {
+        $cmd   = array_merge([self::BINARY_PATH], $args);
+        $stage = 'native_' . ($args[0] ?? '');
+
+        $spec = [
+            0 => ($stdin !== null) ? ['pipe', 'r'] : ['file', '/dev/null', 'r'],
+            1 => ['pipe', 'w'],
+            2 => ['pipe', 'w'],
+        ];
+
+        // The child logs into the plugin log (same format and rotation)
+        $env = array_merge(getenv(), GcsLog::env());
+
+        GcsMetrics::start($stage);
+        $proc = @proc_open($cmd, $spec, $pipes, null, $env);
+        if (!is_resource($proc)) {
+            GcsMetrics::stop($stage);
+            GcsLogger::instance()->warn('Native engine unavailable; using PHP path', [
+                'command' => $args[0] ?? '',
+            ]);
+            return null;
+        }
+
+        // The engine reads its whole request before writing any output
+        if ($stdin !== null) {
+            fwrite($pipes[0], $stdin);
+            fclose($pipes[0]);
+        }
+
+        $stdout = '';
+        $stderr = '';
+
+        stream_set_blocking($pipes[1], false);
+        stream_set_blocking($pipes[2], false);
+
+        // Both pipes at once: a child blocked on a full stderr pipe
+        // would never finish its stdout
+        $open = [1 => $pipes[1], 2 => $pipes[2]];
+        while ($open !== []) {
+            $read   = array_values($open);
+            $write  = null;
+            $except = null;
+            if (@stream_select($read, $write, $except, null) === false) {
+                break;
+            }
+
+            foreach ($read as $pipe) {
+                $fd    = ($pipe === $pipes[1]) ? 1 : 2;
+                $chunk = fread($pipe, self::READ_CHUNK);
+                if ($chunk === false || ($chunk === '' && feof($pipe))) {
+                    unset($open[$fd]);
+                    continue;
+                }
+
+                if ($fd === 2) {
+                    $stderr .= $chunk;
+                } elseif ($sink !== null) {
+                    $sink($chunk);
+                } else {
+                    $stdout .= $chunk;
+                }
+            }
+        }
+        fclose($pipes[1]);
+        fclose($pipes[2]);
+
+        $rc = proc_close($proc);
+        GcsMetrics::stop($stage);
+
+        if ($rc !== 0) {
+            GcsLogger::instance()->warn('Native engine failed; using PHP path', [
+                'command' => $args[0] ?? '',
+                'exit'    => $rc,
+                'stderr'  => trim($stderr),
+            ]);
+            return null;
+        }
+
+        return $stdout;
+    }
+}
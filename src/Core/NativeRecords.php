@@ -0,0 +1,346 @@
+<?php
+declare(strict_types=1);
+
+/**
+ * NativeRecords
+ *
+ * Decoder for the binary record stream of the bulk native subcommands
+ * (parse-ics / fetch-ics --parse / expand with --format=bin), see
+ * bin/gcs/RecordStream.h for the layout.
+ *
+ * RESPONSIBILITIES:
+ * - Validate the stream header (magic, version, kind)
+ * - Rebuild exactly the arrays the JSON output decodes to, key order
+ *   included (jsoncpp writes object keys sorted)
+ * - Decode incrementally: feed() takes the stream in chunks as it is
+ *   read from the pipe and decodes every complete record, so only the
+ *   unfinished tail record is ever buffered
+ *
+ * HARD RULES:
+ * - Never throws; a truncated or foreign stream decodes to null
+ * - Unknown record types are skipped
+ *
+ * NON-GOALS:
+ * - No process handling (NativeEngine)
+ */
+final class NativeRecords
+{
+    public const VERSION = 1;
+
+    public const KIND_CALENDARS = 1;
+    public const KIND_SERIES    = 2;
+
+    private const MAGIC = 'GCSR';
+
+    private const REC_STRING = 1;
+    private const REC_EVENT  = 2;
+    private const REC_META   = 3;
+    private const REC_SERIES = 4;
+
+    private const NONE = 0xffffffff;
+
+    private const EVENT_ALL_DAY    = 1;
+    private const EVENT_RRULE      = 2;
+    private const EVENT_RECURRENCE = 4;
+    private const EVENT_TEXT_TIMES = 8;
+
+    private const OCC_OVERRIDE = 1;
+
+    /** u32 uid, summary, description, yaml; u8 flags; u32 rrule parts, exDates */
+    private const EVENT_FIXED = 25;
+
+    /** Bytes not yet decoded (header, or the start of an unfinished record) */
+    private string $buf = '';
+
+    /** Stream kind from the header; null until the header arrived */
+    private ?int $kind = null;
+
+    private bool $failed = false;
+
+    /** @var array<int,array<string,mixed>> */
+    private array $calendars = [];
+
+    /** @var array<int,array<int,array<string,mixed>>|null> */
+    private array $series = [];
+
+    /** @var array<int,string> Strings of the calendar being decoded */
+    private array $strings = [];
+
+    /** @var array<int,array<string,mixed>> */
+    private array $yamls = [];
+
+    /** @var array<int,array<string,mixed>> */
+    private array $events = [];
+
+    /**
+     * Decode a whole stream.
+     *
+     * Calendars: ['ok' => true, 'calendars' => [calendar object as in
+     * the JSON output, 'events' included unless 'ok' is false]].
+     * Series: ['ok' => true, 'series' => [occurrence list | null]].
+     *
+     * @return array<string,mixed>|null
+     */
+    public static function decode(string $buf): ?array
+    {
+        $decoder = new self();
+        return $decoder->feed($buf) ? $decoder->finish() : null;
+    }
+
+    /**
+     * Decode the complete records in $chunk (plus the tail left by the
+     * previous call). False once the stream is known to be malformed;
+     * later chunks are then ignored.
+     */
+    public function feed(string $chunk): bool
+    {
+        if ($this->failed) {
+            return false;
+        }
+
+        $buf = ($this->buf === '') ? $chunk : $this->buf . $chunk;
+        $len = strlen($buf);
+        $off = 0;
+
+        if ($this->kind === null) {
+            if ($len < 8) {
+                $this->buf = $buf;
+                return true;
+            }
+            $head = unpack('vversion/vkind', $buf, 4);
+            if (substr($buf, 0, 4) !== self::MAGIC || $head === false || $head['version'] !== self::VERSION) {
+                return $this->fail();
+            }
+            $this->kind = (int)$head['kind'];
+            $off = 8;
+        }
+
+        while ($len - $off >= 5) {
+            $rec  = unpack('Ctype/Vsize', $buf, $off);
+            $size = (int)$rec['size'];
+            if ($len - $off - 5 < $size) {
+                break;
+            }
+            $off += 5;
+
+            if (!$this->record((int)$rec['type'], $buf, $off, $size)) {
+                return $this->fail();
+            }
+            $off += $size;
+        }
+
+        $this->buf = ($off >= $len) ? '' : substr($buf, $off);
+        return true;
+    }
+
+    /**
+     * Result of the stream fed so far (see decode()); null when it was
+     * malformed or ended inside a record or calendar.
+     *
+     * @return array<string,mixed>|null
+     */
+    public function finish(): ?array
+    {
+        if ($this->failed || $this->kind === null || $this->buf !== '') {
+            return null;
+        }
+
+        if ($this->kind === self::KIND_CALENDARS) {
+            // Events after the last META belong to an unterminated calendar
+            return $this->events === [] ? ['ok' => true, 'calendars' => $this->calendars] : null;
+        }
+        if ($this->kind === self::KIND_SERIES) {
+            return ['ok' => true, 'series' => $this->series];
+        }
+        return null;
+    }
+
+    private function fail(): bool
+    {
+        $this->failed = true;
+        $this->buf    = '';
+        return false;
+    }
+
+    /* =====================================================================
+     * Records
+     * ===================================================================== */
+
+    /**
+     * One complete record at $off in $buf.
+     */
+    private function record(int $type, string $buf, int $off, int $size): bool
+    {
+        switch ($type) {
+            case self::REC_STRING:
+                $this->strings[] = (string)substr($buf, $off, $size);
+                return true;
+
+            case self::REC_EVENT:
+                $event = self::event($buf, $off, $size, $this->strings, $this->yamls);
+                if ($event === null) {
+                    return false;
+                }
+                $this->events[] = $event;
+                return true;
+
+            case self::REC_META:
+                $meta = json_decode((string)substr($buf, $off, $size), true);
+                if (!is_array($meta)) {
+                    return false;
+                }
+                if (!empty($meta['ok'])) {
+                    $meta['events'] = $this->events;
+                    ksort($meta, SORT_STRING);
+                }
+                $this->calendars[] = $meta;
+
+                $this->strings = [];
+                $this->yamls   = [];
+                $this->events  = [];
+                return true;
+
+            case self::REC_SERIES:
+                $occs = self::series($buf, $off, $size);
+                if ($occs === false) {
+                    return false;
+                }
+                $this->series[] = $occs;
+                return true;
+        }
+
+        return true;
+    }
+
+    /**
+     * @param array<int,string> $strings
+     * @param array<int,array<string,mixed>> $yamls Decoded metadata by string id
+     * @return array<string,mixed>|null
+     */
+    private static function event(string $buf, int $off, int $size, array $strings, array &$yamls): ?array
+    {
+        if ($size < self::EVENT_FIXED) {
+            return null;
+        }
+
+        $f = unpack('Vuid/Vsummary/Vdescription/Vyaml/Cflags/Vparts/VexDates', $buf, $off);
+        $flags  = $f['flags'];
+        $parts  = $f['parts'];
+        $nTimes = 2 + (($flags & self::EVENT_RECURRENCE) ? 1 : 0) + $f['exDates'];
+        $text   = ($flags & self::EVENT_TEXT_TIMES) !== 0;
+
+        if ($size !== self::EVENT_FIXED + 8 * $parts + ($text ? 4 : 8) * $nTimes) {
+            return null;
+        }
+        $off += self::EVENT_FIXED;
+
+        $rrule = null;
+        if ($flags & self::EVENT_RRULE) {
+            $rrule = [];
+            if ($parts > 0) {
+                $ids = array_values(unpack('V' . (2 * $parts), $buf, $off));
+                for ($i = 0; $i < 2 * $parts; $i += 2) {
+                    if (!isset($strings[$ids[$i]], $strings[$ids[$i + 1]])) {
+                        return null;
+                    }
+                    $rrule[$strings[$ids[$i]]] = $strings[$ids[$i + 1]];
+                }
+            }
+        }
+        $off += 8 * $parts;
+
+        $times = [];
+        if ($text) {
+            foreach (unpack('V' . $nTimes, $buf, $off) as $id) {
+                if (!isset($strings[$id])) {
+                    return null;
+                }
+                $times[] = $strings[$id];
+            }
+        } else {
+            foreach (unpack('P' . $nTimes, $buf, $off) as $secs) {
+                $times[] = gmdate('Y-m-d H:i:s', $secs);
+            }
+        }
+
+        $uid     = $strings[$f['uid']] ?? null;
+        $summary = $strings[$f['summary']] ?? null;
+        if ($uid === null || $summary === null) {
+            return null;
+        }
+
+        $description = null;
+        if ($f['description'] !== self::NONE) {
+            $description = $strings[$f['description']] ?? null;
+            if ($description === null) {
+                return null;
+            }
+        }
+
+        $yaml = [];
+        if ($f['yaml'] !== self::NONE) {
+            $id = $f['yaml'];
+            if (!isset($yamls[$id])) {
+                $decoded = isset($strings[$id]) ? json_decode($strings[$id], true) : null;
+                if (!is_array($decoded)) {
+                    return null;
+                }
+                $yamls[$id] = $decoded;
+            }
+            $yaml = $yamls[$id];
+        }
+
+        $recurrence = ($flags & self::EVENT_RECURRENCE) !== 0;
+
+        return [
+            'description'  => $description,
+            'end'          => $times[1],
+            'exDates'      => array_slice($times, $recurrence ? 3 : 2),
+            'isAllDay'     => ($flags & self::EVENT_ALL_DAY) !== 0,
+            'isOverride'   => $recurrence,
+            'recurrenceId' => $recurrence ? $times[2] : null,
+            'rrule'        => $rrule,
+            'start'        => $times[0],
+            'summary'      => $summary,
+            'uid'          => $uid,
+            'yaml'         => $yaml,
+        ];
+    }
+
+    /**
+     * @return array<int,array{end:string,isOverride:bool,start:string}>|null|false
+     *         null = expand in PHP, false = malformed record
+     */
+    private static function series(string $buf, int $off, int $size): array|null|false
+    {
+        if ($size < 4) {
+            return false;
+        }
+
+        $n = unpack('V', $buf, $off)[1];
+        if ($n === self::NONE) {
+            return $size === 4 ? null : false;
+        }
+        if ($size !== 4 + 17 * $n) {
+            return false;
+        }
+        if ($n === 0) {
+            return [];
+        }
+        $off += 4;
+
+        $starts = array_values(unpack('P' . $n, $buf, $off));
+        $ends   = array_values(unpack('P' . $n, $buf, $off + 8 * $n));
+        $flags  = array_values(unpack('C' . $n, $buf, $off + 16 * $n));
+
+        $out = [];
+        for ($i = 0; $i < $n; $i++) {
+            $out[] = [
+                'end'        => gmdate('Y-m-d H:i:s', $ends[$i]),
+                'isOverride' => ($flags[$i] & self::OCC_OVERRIDE) !== 0,
+                'start'      => gmdate('Y-m-d H:i:s', $starts[$i]),
+            ];
+        }
+        return $out;
+    }
+}
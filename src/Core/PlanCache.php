@@ -0,0 +1,166 @@
+<?php
+declare(strict_types=1);
+
+/**
+ * PlanCache
+ *
+ * Content-addressed cache of the planner's desired state (ordered
+ * bundles + flattened entries) under runtime/.
+ *
+ * KEY (sha1 over):
+ * - Content digest of every calendar body, in config order
+ * - gcs-export environment digest (settings, locale, sun table)
+ * - Scheduler guard date and PHP timezone
+ * - Playlist / sequence inventory stamp (target resolution)
+ * - Configuration, minus the informational "sync" block
+ *
+ * The desired state also depends on the current time (expired one-off
+ * events are pruned, the occurrence horizon starts "now"), so entries
+ * expire after runtime.plan_cache_ttl seconds. Within that window a
+ * preview and the following apply share the exact same plan.
+ *
+ * HARD RULES:
+ * - Never throws; any unreadable / mismatching entry is a miss
+ * - Never caches the diff: existing scheduler state is always re-read
+ *
+ * NON-GOALS:
+ * - No planning logic
+ */
+final class PlanCache
+{
+    /** Bump whenever the cached payload or planner semantics change */
+    private const FORMAT = 1;
+
+    private const MAGIC = 'GCSPLAN';
+
+    private const FILE_PREFIX = 'plan-cache-';
+    private const FILE_SUFFIX = '.bin';
+
+    /**
+     * @param array<string,mixed> $cfg
+     */
+    public static function ttl(array $cfg): int
+    {
+        return max(0, (int)($cfg['runtime']['plan_cache_ttl'] ?? 0));
+    }
+
+    /**
+     * Cache key for a plan over $sources, or null when this plan cannot
+     * be cached (disabled, no environment digest, empty calendar body).
+     *
+     * @param array<string,mixed> $cfg
+     * @param array<int,array<string,mixed>> $sources SchedulerRunner::fetchSources()
+     */
+    public static function key(array $cfg, array $sources, string $guardDate): ?string
+    {
+        $envDigest = FPPSemantics::getEnvironmentDigest();
+        if (self::ttl($cfg) === 0 || $envDigest === null) {
+            return null;
+        }
+
+        $calendars = [];
+        foreach ($sources as $src) {
+            $digest = (string)($src['digest'] ?? '');
+            // A failed fetch must never be remembered as an empty plan
+            if ($digest === '' || $digest === hash('fnv1a64', '')) {
+                return null;
+            }
+            $calendars[] = [(string)($src['url'] ?? ''), $digest];
+        }
+
+        unset($cfg['sync']);
+
+        $material = json_encode([
+            self::FORMAT,
+            $calendars,
+            $envDigest,
+            $guardDate,
+            date_default_timezone_get(),
+            TargetResolver::inventoryStamp(),
+            $cfg,
+        ]);
+
+        return is_string($material) ? sha1($material) : null;
+    }
+
+    /**
+     * Cached desired state for $key, or null on a miss.
+     *
+     * @param array<string,mixed> $cfg
+     * @return array<string,mixed>|null
+     */
+    public static function load(array $cfg, string $key): ?array
+    {
+        $raw = @file_get_contents(self::pathFor($key));
+        if (!is_string($raw)) {
+            return null;
+        }
+
+        $nl = strpos($raw, "\n");
+        if ($nl === false) {
+            return null;
+        }
+
+        $header = explode(' ', substr($raw, 0, $nl));
+        if (count($header) !== 4 || $header[0] !== self::MAGIC ||
+            (int)$header[1] !== self::FORMAT || $header[2] !== $key) {
+            return null;
+        }
+
+        $body = substr($raw, $nl + 1);
+        if ($header[3] === 'z') {
+            $body = function_exists('gzuncompress') ? @gzuncompress($body) : false;
+            if (!is_string($body)) {
+                return null;
+            }
+        }
+
+        $entry = @unserialize($body, ['allowed_classes' => false]);
+        if (!is_array($entry) || !is_array($entry['plan'] ?? null) ||
+            time() - (int)($entry['createdAt'] ?? 0) > self::ttl($cfg)) {
+            return null;
+        }
+
+        return $entry['plan'];
+    }
+
+    /**
+     * Store the desired state for $key (atomic replace), dropping any
+     * other cached plan.
+     *
+     * @param array<string,mixed> $plan
+     */
+    public static function store(string $key, array $plan): void
+    {
+        $body = serialize(['createdAt' => time(), 'plan' => $plan]);
+
+        $flag = '-';
+        if (function_exists('gzcompress')) {
+            $z = gzcompress($body, 1);
+            if (is_string($z)) {
+                $body = $z;
+                $flag = 'z';
+            }
+        }
+
+        $path = self::pathFor($key);
+        $tmp  = $path . '.tmp-' . getmypid();
+        $data = self::MAGIC . ' ' . self::FORMAT . ' ' . $key . ' ' . $flag . "\n" . $body;
+
+        if (@file_put_contents($tmp, $data, LOCK_EX) !== strlen($data) || !@rename($tmp, $path)) {
+            @unlink($tmp);
+            return;
+        }
+
+        foreach (glob(NativeEngine::RUNTIME_DIR . '/' . self::FILE_PREFIX . '*' . self::FILE_SUFFIX) ?: [] as $old) {
+            if ($old !== $path) {
+                @unlink($old);
+            }
+        }
+    }
+
+    private static function pathFor(string $key): string
+    {
+        return NativeEngine::RUNTIME_DIR . '/' . self::FILE_PREFIX . $key . self::FILE_SUFFIX;
+    }
+}
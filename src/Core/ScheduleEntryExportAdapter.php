@@ -9,18 +9,15 @@ final class ScheduleEntryExportAdapter
 
     private static function debugSkip(string $summary, string $reason, array $entry): void
     {
-        $playlist = trim((string)($entry['playlist'] ?? ''));
-        $command  = trim((string)($entry['command'] ?? ''));
-        $enabled  = array_key_exists('enabled', $entry) ? (string)$entry['enabled'] : '(unset)';
-
-        error_log(sprintf(
-            '[GCS DEBUG][ExportAdapter] SKIP "%s": %s | playlist=%s command=%s enabled=%s',
-            ($summary !== '' ? $summary : '(no summary)'),
-            $reason,
-            ($playlist !== '' ? $playlist : '(none)'),
-            ($command !== '' ? $command : '(none)'),
-            $enabled
-        ));
+        GcsTrace::event(GcsTrace::EXPORT, 'skip', static function () use ($summary, $reason, $entry) {
+            return [
+                'summary'  => $summary,
+                'reason'   => $reason,
+                'playlist' => trim((string)($entry['playlist'] ?? '')),
+                'command'  => trim((string)($entry['command'] ?? '')),
+                'enabled'  => $entry['enabled'] ?? null,
+            ];
+        }, GcsTrace::DETAIL);
     }
 
     /* =====================================================================
@@ -10,6 +10,12 @@ declare(strict_types=1);
  * PURPOSE:
  * - Decide UPDATE vs NO-OP once identity has already been matched
  *
+ * Each entry's comparable form (semantic fields only, keys sorted) is
+ * reduced to one 128-bit digest, so an entry is hashed once and every
+ * comparison is a string compare. Two entries are equivalent iff their
+ * comparable forms are identical (===); serialize() preserves value
+ * types and nested order, so the digests agree with that.
+ *
  * IMPORTANT ASSUMPTIONS (Phase 17+):
  * - Identity matching is already complete before comparison
  * - Identity is defined by the FULL GCS v1 tag (handled elsewhere)
@@ -22,6 +28,17 @@ declare(strict_types=1);
  */
 final class SchedulerComparator
 {
+    /**
+     * Non-semantic / runtime-only fields.
+     *
+     * These fields do not affect scheduler behavior and must not
+     * cause spurious updates.
+     */
+    private const IGNORED_FIELDS = ['id', 'lastRun'];
+
+    /** hash() algorithm for digests (xxh128 from PHP 8.1) */
+    private static ?string $algo = null;
+
     /**
      * Determine whether an existing scheduler entry and a desired entry
      * are functionally equivalent.
@@ -37,30 +54,29 @@ final class SchedulerComparator
         ExistingScheduleEntry $existing,
         array $desired
     ): bool {
-        $a = $existing->raw();
-        $b = $desired;
+        return $existing->comparableDigest() === self::digest($desired);
+    }
 
-        /*
-         * Remove non-semantic / runtime-only fields.
-         *
-         * These fields do not affect scheduler behavior and must not
-         * cause spurious updates.
-         */
-        unset(
-            $a['id'],
-            $a['lastRun'],
-            $b['id']
-        );
+    /**
+     * Stable digest of an entry's comparable form.
+     *
+     * @param array<string,mixed> $entry
+     */
+    public static function digest(array $entry): string
+    {
+        if (self::$algo === null) {
+            self::$algo = in_array('xxh128', hash_algos(), true) ? 'xxh128' : 'md5';
+        }
 
-        // Compare normalized structures
-        return self::normalize($a) === self::normalize($b);
+        return hash(self::$algo, serialize(self::normalize($entry)));
     }
 
     /**
      * Normalize an entry for comparison.
      *
      * Current strategy:
-     * - Sort keys recursively at the top level
+     * - Drop IGNORED_FIELDS
+     * - Sort keys at the top level
      *
      * NOTE:
      * - Values are assumed to already be normalized by upstream mapping
@@ -71,6 +87,10 @@ final class SchedulerComparator
      */
     private static function normalize(array $entry): array
     {
+        foreach (self::IGNORED_FIELDS as $field) {
+            unset($entry[$field]);
+        }
+
         ksort($entry);
         return $entry;
     }
@@ -69,6 +69,25 @@ final class SunTimeEstimator
             return null;
         }
 
+        return self::formatSeconds($baseSeconds, $offsetMinutes, $roundMinutes);
+    }
+
+    /**
+     * Apply offset + rounding to a precomputed base time.
+     *
+     * Used with the gcs-export sun table so table lookups and
+     * estimate() produce identical display strings: both take the UTC
+     * offset at noon of the requested date.
+     *
+     * @param int $baseSeconds Seconds since local midnight (unrounded)
+     *
+     * @return string HH:MM:SS
+     */
+    public static function formatSeconds(
+        int $baseSeconds,
+        int $offsetMinutes = 0,
+        int $roundMinutes = 30
+    ): string {
         $seconds = $baseSeconds + ($offsetMinutes * 60);
 
         return self::roundSeconds($seconds, $roundMinutes);
@@ -91,13 +110,17 @@ final class SunTimeEstimator
 
         $lngHour = $lon / 15.0;
 
-        $sunrise = self::calcSolarTime($dayOfYear, $lat, $lngHour, true,  -0.833);
-        $sunset  = self::calcSolarTime($dayOfYear, $lat, $lngHour, false, -0.833);
+        // UTC offset of this date (DST-correct), as bin/gcs/SunTable.h
+        $tzOffsetHours = (int)date('Z', $timestamp) / 3600;
+
+        $sunrise = self::calcSolarTime($dayOfYear, $lat, $lngHour, $tzOffsetHours, true,  -0.833);
+        $sunset  = self::calcSolarTime($dayOfYear, $lat, $lngHour, $tzOffsetHours, false, -0.833);
 
         $dawn = self::calcSolarTime(
             $dayOfYear,
             $lat,
             $lngHour,
+            $tzOffsetHours,
             true,
             self::CIVIL_TWILIGHT_DEGREES
         );
@@ -106,6 +129,7 @@ final class SunTimeEstimator
             $dayOfYear,
             $lat,
             $lngHour,
+            $tzOffsetHours,
             false,
             self::CIVIL_TWILIGHT_DEGREES
         );
@@ -122,6 +146,7 @@ final class SunTimeEstimator
         int $dayOfYear,
         float $lat,
         float $lngHour,
+        float $tzOffsetHours,
         bool $isRise,
         float $zenith
     ): int {
@@ -175,9 +200,8 @@ final class SunTimeEstimator
         $UT = fmod($T - $lngHour + 24, 24);
 
         // -----------------------------------------------------------------
-        // FIX: Convert UTC → local wall-clock time
+        // FIX: Convert UTC → local wall-clock time (offset of the date)
         // -----------------------------------------------------------------
-        $tzOffsetHours = date('Z') / 3600; // respects DST
         $localTime = fmod($UT + $tzOffsetHours + 24, 24);
 
         return (int)round($localTime * 3600);
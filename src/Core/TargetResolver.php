@@ -22,10 +22,23 @@ declare(strict_types=1);
  * - No scheduler mutation
  * - No inference beyond explicit file existence
  *
+ * Playlist / sequence existence comes from the target index exported
+ * by gcs-export (FppEnvironment::getTargetIndex()) when its stamp
+ * matches inventoryStamp(); otherwise each lookup stats the media
+ * directories as before. The check is made once per process.
+ *
  * If no valid target is found, resolution fails cleanly.
  */
 final class TargetResolver
 {
+    private const PLAYLIST_DIR = '/home/fpp/media/playlists';
+    private const SEQUENCE_DIR = '/home/fpp/media/sequences';
+
+    /** @var array<string,mixed>|null Current target index, if usable */
+    private static ?array $index = null;
+
+    private static bool $indexLoaded = false;
+
     /**
      * Attempt to resolve an FPP scheduler target from a calendar summary.
      *
@@ -76,6 +89,44 @@ final class TargetResolver
         return null;
     }
 
+    /**
+     * Change stamp of the playlist and sequence directories (their
+     * mtimes; adding, removing or renaming an entry bumps them). Only
+     * existence matters to resolve(), so content edits are irrelevant;
+     * a dir-based playlist gaining playlist.json later is not seen.
+     */
+    public static function inventoryStamp(): string
+    {
+        clearstatcache();
+        $parts = [];
+        foreach ([self::PLAYLIST_DIR, self::SEQUENCE_DIR] as $dir) {
+            $mtime = @filemtime($dir);
+            $parts[] = ($mtime === false) ? '-' : (string)$mtime;
+        }
+        return implode(':', $parts);
+    }
+
+    /**
+     * Exported target index, or null when missing or stale.
+     *
+     * @return array<string,mixed>|null
+     */
+    private static function index(): ?array
+    {
+        if (!self::$indexLoaded) {
+            self::$indexLoaded = true;
+
+            $warnings = [];
+            $index = FppEnvironment::loadRuntime($warnings)->getTargetIndex();
+
+            self::$index = ($index !== null && $index['stamp'] === self::inventoryStamp())
+                ? $index
+                : null;
+        }
+
+        return self::$index;
+    }
+
     /**
      * Check whether a named FPP playlist exists.
      *
@@ -85,8 +136,13 @@ final class TargetResolver
      */
     private static function playlistExists(string $name): bool
     {
-        $dirBased  = "/home/fpp/media/playlists/{$name}/playlist.json";
-        $fileBased = "/home/fpp/media/playlists/{$name}.json";
+        $index = self::index();
+        if ($index !== null) {
+            return isset($index['playlists'][$name]);
+        }
+
+        $dirBased  = self::PLAYLIST_DIR . "/{$name}/playlist.json";
+        $fileBased = self::PLAYLIST_DIR . "/{$name}.json";
 
         return is_file($dirBased) || is_file($fileBased);
     }
@@ -99,6 +155,11 @@ final class TargetResolver
      */
     private static function sequenceExists(string $name): bool
     {
-        return is_file("/home/fpp/media/sequences/{$name}");
+        $index = self::index();
+        if ($index !== null) {
+            return isset($index['sequences'][$name]);
+        }
+
+        return is_file(self::SEQUENCE_DIR . "/{$name}");
     }
 }
@@ -29,9 +29,20 @@ declare(strict_types=1);
  * - Anchors, tags, or advanced YAML features
  *
  * If parsing fails or metadata is invalid, an empty array is returned.
+ *
+ * Results are memoized per distinct YAML block (recurring overrides
+ * usually repeat the base event's block). Events from the native
+ * parser arrive with this metadata already parsed (bin/gcs/YamlMeta.h)
+ * and skip this class.
  */
 final class YamlMetadata
 {
+    /** Memoized blocks kept before the memo is reset */
+    private const MEMO_MAX = 256;
+
+    /** @var array<string,array<string,mixed>> YAML block => parse() result */
+    private static array $memo = [];
+
     /**
      * Parse YAML metadata from a calendar event description.
      *
@@ -55,6 +66,22 @@ final class YamlMetadata
             return [];
         }
 
+        if (isset(self::$memo[$yamlText])) {
+            return self::$memo[$yamlText];
+        }
+
+        if (count(self::$memo) >= self::MEMO_MAX) {
+            self::$memo = [];
+        }
+
+        return self::$memo[$yamlText] = self::parseAndNormalize($yamlText);
+    }
+
+    /**
+     * @return array<string,mixed>
+     */
+    private static function parseAndNormalize(string $yamlText): array
+    {
         try {
             $parsed = self::parseYamlBlock($yamlText);
             if (empty($parsed)) {
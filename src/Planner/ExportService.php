@@ -3,9 +3,6 @@ declare(strict_types=1);
 
 final class ExportService
 {
-    private const FPP_ENV_PATH =
-        __DIR__ . '/../../runtime/fpp-env.json';
-
     /**
      * Export scheduler entries into calendar payload.
      *
@@ -13,35 +10,39 @@ final class ExportService
      * @return array<string,mixed>
      */
     public static function export(array $entries): array
+    {
+        return GcsMetrics::measure('export', static fn(): array => self::exportMeasured($entries));
+    }
+
+    /**
+     * export() inside its metrics run.
+     *
+     * @param array<int,array<string,mixed>> $entries
+     * @return array<string,mixed>
+     */
+    private static function exportMeasured(array $entries): array
     {
         $warnings = [];
 
         // -----------------------------------------------------------------
         // Load runtime FPP environment
         // -----------------------------------------------------------------
-        $env = FppEnvironment::loadFromFile(
-            self::FPP_ENV_PATH,
-            $warnings
-        );
-
-        // Register environment with FPPSemantics
-        FPPSemantics::setEnvironment($env->toArray());
-
-        if ($env->getTimezone()) {
-            date_default_timezone_set($env->getTimezone());
-        }
+        $env = self::loadEnvironment($warnings);
 
         // -----------------------------------------------------------------
         // Adapt scheduler entries
         // -----------------------------------------------------------------
         $events = [];
 
+        GcsMetrics::start('adapt');
         foreach ($entries as $entry) {
             $adapted = ScheduleEntryExportAdapter::adapt($entry, $warnings);
             if ($adapted !== null) {
                 $events[] = $adapted;
             }
         }
+        GcsMetrics::stop('adapt');
+        GcsMetrics::set('events', count($events));
 
         // -----------------------------------------------------------------
         // Build ICS payload
@@ -69,9 +70,7 @@ final class ExportService
                 $ics = null;
             }
         } else {
-            error_log(
-                '[GCS DEBUG] No events passed to IcsWriter'
-            );
+            GcsTrace::event(GcsTrace::EXPORT, 'no_events');
         }
 
         return [
@@ -81,4 +80,72 @@ final class ExportService
             'fppEnv'   => $env->toArray(),
         ];
     }
-}
\ No newline at end of file
+
+    /**
+     * Export scheduler entries straight into an ICS file.
+     *
+     * The native exporter streams the calendar without holding the
+     * adapted events; the PHP path (export() + one write) is the
+     * fallback. No file is written when nothing was exportable.
+     *
+     * @param array<string,mixed> $cfg
+     * @param array<int,array<string,mixed>> $entries
+     * @return array{ok:bool,events:int,warnings:array<int,string>}
+     */
+    public static function exportToFile(array $cfg, array $entries, string $path): array
+    {
+        $warnings = [];
+        self::loadEnvironment($warnings);
+
+        $native = NativeEngine::exportIcs($cfg, $entries, $path);
+        if ($native !== null) {
+            $warnings = array_merge($warnings, $native['warnings']);
+            if ($native['events'] === 0) {
+                @unlink($path);
+            }
+            return [
+                'ok'       => $native['events'] > 0,
+                'events'   => $native['events'],
+                'warnings' => $warnings,
+            ];
+        }
+
+        $result = self::export($entries);
+        $ics    = $result['ics'];
+
+        if (!is_string($ics) || @file_put_contents($path, $ics) !== strlen($ics)) {
+            return [
+                'ok'       => false,
+                'events'   => count($result['events']),
+                'warnings' => $result['warnings'],
+            ];
+        }
+
+        return [
+            'ok'       => true,
+            'events'   => count($result['events']),
+            'warnings' => $result['warnings'],
+        ];
+    }
+
+    /**
+     * Runtime FPP environment, registered with FPPSemantics, and its
+     * timezone made the PHP default (IcsWriter writes in it).
+     *
+     * @param array<int,string> $warnings
+     */
+    private static function loadEnvironment(array &$warnings): FppEnvironment
+    {
+        $env = FppEnvironment::loadRuntime($warnings);
+
+        // Register environment with FPPSemantics
+        FPPSemantics::setEnvironment($env->toArray());
+        FPPSemantics::setSunTable($env->getSunTable());
+
+        if ($env->getTimezone()) {
+            date_default_timezone_set($env->getTimezone());
+        }
+
+        return $env;
+    }
+}
@@ -12,6 +12,8 @@ declare(strict_types=1);
  * - Track disabled unmanaged entries for visibility
  * - Provide raw unmanaged entries for export
  *
+ * Classification is done once per request by ScheduleInventory.
+ *
  * Guarantees:
  * - Never mutates scheduler.json
  * - Never infers ownership beyond the GCS identity tag
@@ -33,121 +35,33 @@ final class InventoryService
      */
     public static function getInventory(): array
     {
-        $entries = SchedulerSync::readScheduleJsonStatic(
-            SchedulerSync::SCHEDULE_JSON_PATH
-        );
-
-        // 🔍 TEMP DEBUG — REMOVE AFTER VALIDATION
-        foreach ($entries as $i => $entry) {
-            if (!is_array($entry)) {
-                continue;
-            }
-
-            // Legacy normalization: sequences were historically stored as playlist "<name>.fseq"
-            // Ensure inventory classification treats them as sequences with extensionless names.
-            if (
-                isset($entry['playlist']) &&
-                is_string($entry['playlist']) &&
-                str_ends_with($entry['playlist'], '.fseq')
-            ) {
-                $entry['sequence'] = 1;
-                $entry['playlist'] = pathinfo($entry['playlist'], PATHINFO_FILENAME);
-            }
-
-            $managed = SchedulerIdentity::isGcsManaged($entry);
-
-            error_log(sprintf(
-                '[GCS DEBUG][Inventory] #%d playlist=%s managed=%s args=%s',
-                $i,
-                $entry['playlist'] ?? '(none)',
-                $managed ? 'YES' : 'NO',
-                json_encode($entry['args'] ?? null)
-            ));
-        }
-
-        $total = 0;
-        $managed = 0;
-        $unmanaged = 0;
-        $unmanagedDisabled = 0;
-
-        foreach ($entries as $entry) {
-            if (!is_array($entry)) {
-                continue;
-            }
-
-            // Legacy normalization: sequences were historically stored as playlist "<name>.fseq"
-            // Ensure inventory classification treats them as sequences with extensionless names.
-            if (
-                isset($entry['playlist']) &&
-                is_string($entry['playlist']) &&
-                str_ends_with($entry['playlist'], '.fseq')
-            ) {
-                $entry['sequence'] = 1;
-                $entry['playlist'] = pathinfo($entry['playlist'], PATHINFO_FILENAME);
-            }
-
-            $total++;
-
-            if (SchedulerIdentity::isGcsManaged($entry)) {
-                $managed++;
-                continue;
-            }
-
-            // Unmanaged scheduler entry (non-GCS)
-            $unmanaged++;
-
-            if (isset($entry['enabled']) && (int)$entry['enabled'] === 0) {
-                $unmanagedDisabled++;
+        $inventory = ScheduleInventory::load();
+
+        if (GcsTrace::enabled(GcsTrace::INVENTORY, GcsTrace::DETAIL)) {
+            foreach ($inventory->entries() as $i => $entry) {
+                GcsTrace::event(GcsTrace::INVENTORY, 'entry', [
+                    'index'    => $i,
+                    'playlist' => $entry['playlist'] ?? null,
+                    'managed'  => $inventory->isManaged($i),
+                    'args'     => $entry['args'] ?? null,
+                ], GcsTrace::DETAIL);
             }
         }
 
-        return [
-            'total'              => $total,
-            'managed'            => $managed,
-            'unmanaged'          => $unmanaged,
-            'unmanaged_disabled' => $unmanagedDisabled,
-        ];
+        return $inventory->counts();
     }
 
     /**
      * Return raw unmanaged scheduler entries.
      *
      * These are entries present in scheduler.json that are NOT
-     * managed by GoogleCalendarScheduler.
+     * managed by GoogleCalendarScheduler. Legacy sequences (playlist
+     * "<name>.fseq") come back as sequences with extensionless names.
      *
      * @return array<int,array<string,mixed>>
      */
     public static function getUnmanagedEntries(): array
     {
-        $entries = SchedulerSync::readScheduleJsonStatic(
-            SchedulerSync::SCHEDULE_JSON_PATH
-        );
-
-        $unmanaged = [];
-
-        foreach ($entries as $entry) {
-            if (!is_array($entry)) {
-                continue;
-            }
-
-            // Legacy normalization: sequences were historically stored as playlist "<name>.fseq"
-            // Ensure inventory classification treats them as sequences with extensionless names.
-            if (
-                isset($entry['playlist']) &&
-                is_string($entry['playlist']) &&
-                str_ends_with($entry['playlist'], '.fseq')
-            ) {
-                $entry['sequence'] = 1;
-                $entry['playlist'] = pathinfo($entry['playlist'], PATHINFO_FILENAME);
-            }
-
-            if (SchedulerIdentity::isGcsManaged($entry)) {
-                continue;
-            }
-
-            $unmanaged[] = $entry;
-        }
-
-        return $unmanaged;
+        return ScheduleInventory::load()->unmanagedEntries();
     }
 }
\ No newline at end of file
@@ -36,13 +36,10 @@ final class InventorySnapshot
     public static function summarize(
         string $path = SchedulerSync::SCHEDULE_JSON_PATH
     ): array {
-        $managed = 0;
-        $unmanaged = 0;
-        $invalid = 0;
         $errors = [];
 
         try {
-            $entries = SchedulerSync::readScheduleJsonStatic($path);
+            $counts = ScheduleInventory::load($path)->counts();
         } catch (Throwable $e) {
             return [
                 'ok'              => false,
@@ -55,18 +52,10 @@ final class InventorySnapshot
             ];
         }
 
-        foreach ($entries as $entry) {
-            if (!is_array($entry)) {
-                $invalid++;
-                continue;
-            }
-
-            if (SchedulerIdentity::isGcsManaged($entry)) {
-                $managed++;
-            } else {
-                $unmanaged++;
-            }
-        }
+        // Non-object entries never reach the inventory (dropped on read)
+        $managed   = $counts['managed'];
+        $unmanaged = $counts['unmanaged'];
+        $invalid   = 0;
 
         return [
             'ok'              => true,
@@ -0,0 +1,242 @@
+<?php
+declare(strict_types=1);
+
+/**
+ * ScheduleInventory
+ *
+ * schedule.json decoded and classified once per request.
+ *
+ * RESPONSIBILITIES:
+ * - Read schedule.json (SchedulerSync::decodeScheduleJsonStatic()) and
+ *   digest the bytes read, so a native apply can refuse a file that
+ *   changed since it was planned
+ * - Extract each entry's GCS identity key exactly once
+ * - Hold the managed / unmanaged partition, the key -> index map and
+ *   the inventory counts shared by InventoryService, InventorySnapshot,
+ *   SchedulerCleanupPlanner and the planner diff
+ *
+ * HARD RULES:
+ * - Read-only; never mutates schedule.json
+ * - Ownership comes solely from SchedulerIdentity::extractKey()
+ * - A cached inventory is reused only while the file's stat signature
+ *   is unchanged; writers call invalidate() as well
+ *
+ * NON-GOALS:
+ * - Apply-time revalidation and post-write verification still read the
+ *   file directly
+ */
+final class ScheduleInventory
+{
+    /** @var array<string,array{sig:string,inventory:self}> path => cached inventory */
+    private static array $cache = [];
+
+    /** @var array<int,array<string,mixed>> */
+    private array $entries;
+
+    /** @var array<int,string|null> index => identity key (null = unmanaged) */
+    private array $keys = [];
+
+    /** @var array<string,int> identity key => index (last entry wins, as in the diff) */
+    private array $keyIndex = [];
+
+    /** @var array<int,int> */
+    private array $managed = [];
+
+    /** @var array<int,int> */
+    private array $unmanaged = [];
+
+    private int $unmanagedDisabled = 0;
+
+    private ?SchedulerState $state = null;
+
+    /** hash('fnv1a64') of the bytes the entries were decoded from ('' = unknown) */
+    private string $digest;
+
+    /**
+     * @param array<int,array<string,mixed>> $entries Decoded schedule.json entries
+     */
+    public function __construct(array $entries, string $digest = '')
+    {
+        $this->entries = array_values($entries);
+        $this->digest  = $digest;
+
+        foreach ($this->entries as $i => $entry) {
+            $key = SchedulerIdentity::extractKey($entry);
+            $this->keys[$i] = $key;
+
+            if ($key !== null) {
+                $this->managed[]      = $i;
+                $this->keyIndex[$key] = $i;
+                continue;
+            }
+
+            $this->unmanaged[] = $i;
+            if (isset($entry['enabled']) && (int)$entry['enabled'] === 0) {
+                $this->unmanagedDisabled++;
+            }
+        }
+    }
+
+    /**
+     * Inventory of the schedule.json at $path, shared within the request.
+     */
+    public static function load(string $path = SchedulerSync::SCHEDULE_JSON_PATH): self
+    {
+        $sig = self::signature($path);
+        if (isset(self::$cache[$path]) && self::$cache[$path]['sig'] === $sig) {
+            return self::$cache[$path]['inventory'];
+        }
+
+        $raw = is_file($path) ? @file_get_contents($path) : '';
+        if ($raw === false) {
+            $raw = '';
+        }
+
+        $inventory = new self(SchedulerSync::decodeScheduleJsonStatic($raw), hash('fnv1a64', $raw));
+        self::$cache[$path] = ['sig' => $sig, 'inventory' => $inventory];
+
+        return $inventory;
+    }
+
+    /**
+     * Drop the cached inventory after schedule.json was written.
+     */
+    public static function invalidate(?string $path = null): void
+    {
+        if ($path === null) {
+            self::$cache = [];
+            return;
+        }
+        unset(self::$cache[$path]);
+    }
+
+    /* =====================================================================
+     * Accessors
+     * ===================================================================== */
+
+    /**
+     * Entries in file order (non-object entries already dropped).
+     *
+     * @return array<int,array<string,mixed>>
+     */
+    public function entries(): array
+    {
+        return $this->entries;
+    }
+
+    /**
+     * hash('fnv1a64') of the schedule.json bytes read ('' when built
+     * from entries).
+     */
+    public function digest(): string
+    {
+        return $this->digest;
+    }
+
+    /**
+     * Identity key per entry index (null = unmanaged).
+     *
+     * @return array<int,string|null>
+     */
+    public function keys(): array
+    {
+        return $this->keys;
+    }
+
+    /**
+     * @return array<string,int>
+     */
+    public function keyIndex(): array
+    {
+        return $this->keyIndex;
+    }
+
+    public function isManaged(int $index): bool
+    {
+        return ($this->keys[$index] ?? null) !== null;
+    }
+
+    /**
+     * @return array<int,int>
+     */
+    public function managedIndexes(): array
+    {
+        return $this->managed;
+    }
+
+    /**
+     * @return array<int,int>
+     */
+    public function unmanagedIndexes(): array
+    {
+        return $this->unmanaged;
+    }
+
+    /**
+     * Unmanaged entries for export, with the legacy sequence form
+     * (playlist "<name>.fseq") normalized to sequence + bare name.
+     *
+     * @return array<int,array<string,mixed>>
+     */
+    public function unmanagedEntries(): array
+    {
+        $out = [];
+        foreach ($this->unmanaged as $i) {
+            $entry = $this->entries[$i];
+
+            if (
+                isset($entry['playlist']) &&
+                is_string($entry['playlist']) &&
+                str_ends_with($entry['playlist'], '.fseq')
+            ) {
+                $entry['sequence'] = 1;
+                $entry['playlist'] = pathinfo($entry['playlist'], PATHINFO_FILENAME);
+            }
+
+            $out[] = $entry;
+        }
+        return $out;
+    }
+
+    /**
+     * @return array{total:int,managed:int,unmanaged:int,unmanaged_disabled:int}
+     */
+    public function counts(): array
+    {
+        return [
+            'total'              => count($this->entries),
+            'managed'            => count($this->managed),
+            'unmanaged'          => count($this->unmanaged),
+            'unmanaged_disabled' => $this->unmanagedDisabled,
+        ];
+    }
+
+    /**
+     * Diff view of the entries; identity keys are carried over.
+     */
+    public function state(): SchedulerState
+    {
+        if ($this->state === null) {
+            $existing = [];
+            foreach ($this->entries as $i => $entry) {
+                $existing[] = ExistingScheduleEntry::withKey($entry, $this->keys[$i]);
+            }
+            $this->state = new SchedulerState($existing);
+        }
+        return $this->state;
+    }
+
+    /**
+     * Stat signature of schedule.json ("-" when missing); changes with
+     * every replace of the file.
+     */
+    public static function signature(string $path = SchedulerSync::SCHEDULE_JSON_PATH): string
+    {
+        clearstatcache(true, $path);
+        $st = @stat($path);
+        if ($st === false) {
+            return '-';
+        }
+        return $st['ino'] . ':' . $st['size'] . ':' . $st['mtime'];
+    }
+}
@@ -17,6 +17,11 @@ declare(strict_types=1);
  * - Determine CREATE / UPDATE / DELETE actions
  * - Delegate semantic equality checks to SchedulerComparator
  *
+ * Complexity:
+ * - Both sides are indexed by UID (hash lookups), and each matched pair
+ *   costs one digest comparison; existing entries memoize their UID and
+ *   digest, so the whole diff is O(n) in the number of entries
+ *
  * Guarantees:
  * - No writes
  * - No side effects
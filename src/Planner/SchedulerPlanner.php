@@ -18,15 +18,25 @@ declare(strict_types=1);
  * - NEVER mutates schedule.json
  * - Deterministic output
  *
- * DEBUGGING:
- * - When enabled, writes detailed traces to /tmp:
- *   /tmp/gcs_planner_order_debug.log          (JSONL)
+ * CACHING:
+ * - Ordered bundles + desiredEntries are cached in runtime/ (PlanCache),
+ *   keyed on calendar content, environment and config; the debug path
+ *   always plans from scratch
+ *
+ * METRICS:
+ * - Stage timings (fetch, plan_cache, parse, expand, bundles, order,
+ *   flatten, diff, native_*) and counters are returned as 'metrics'
+ *   and appended to runtime/metrics.jsonl (GcsMetrics)
+ *
+ * DEBUGGING (GcsTrace category "ordering"):
+ * - SUMMARY: one "plan" event per call
+ * - DETAIL: ordering runs in PHP with per-step events, plus
  *   /tmp/gcs_planner_order_initial.txt        (human list)
  *   /tmp/gcs_planner_order_after_passes.txt   (human list)
+ *   Events go to /tmp/gcs_trace_ordering.jsonl
  *
- * Enable debug via:
- * - config['runtime']['debug_ordering'] = true
- *   (or export GCS_DEBUG_ORDERING=1)
+ * Enable via config['runtime']['trace']['ordering'] = 2
+ * (or export GCS_TRACE=ordering; runtime.debug_ordering still works)
  */
 final class SchedulerPlanner
 {
@@ -38,8 +48,26 @@ final class SchedulerPlanner
      */
     private const MAX_ORDER_PASSES = 50;
 
-    public static function plan(array $config): array
+    /**
+     * @param array<int,array<string,mixed>>|null $sources Calendars already
+     *        fetched by SchedulerRunner::fetchSources(); null fetches
+     */
+    public static function plan(array $config, ?array $sources = null): array
+    {
+        GcsTrace::configure($config);
+
+        return GcsMetrics::measure('plan', static fn(): array => self::planMeasured($config, $sources));
+    }
+
+    /**
+     * plan() inside its metrics run.
+     *
+     * @param array<int,array<string,mixed>>|null $sources
+     * @return array<string,mixed>
+     */
+    private static function planMeasured(array $config, ?array $sources): array
     {
+
         $debug = self::isDebugOrderingEnabled($config);
         if ($debug) {
             self::dbgReset();
@@ -62,10 +90,159 @@ final class SchedulerPlanner
         }
 
         /* -----------------------------------------------------------------
-         * 1. Calendar ingestion
+         * 1. Calendar fetch + plan cache
+         *
+         * Steps 2-5 are a pure function of the calendar bodies,
+         * environment, guard date and config (see PlanCache); a hit
+         * skips expansion and ordering (natively the calendars were
+         * already parsed by the fetch workers, keyed on the digests they
+         * returned). The diff (step 6)
+         * always runs against the live schedule.json.
          * ----------------------------------------------------------------- */
         $runner = new SchedulerRunner($config);
-        $runnerResult = $runner->run();
+
+        if ($sources === null) {
+            GcsMetrics::start('fetch');
+            $sources = $runner->fetchSources();
+            GcsMetrics::stop('fetch');
+        }
+
+        GcsMetrics::start('plan_cache');
+        $cacheKey = $debug ? null : PlanCache::key($config, $sources, $guardDate);
+        $desired  = ($cacheKey !== null) ? PlanCache::load($config, $cacheKey) : null;
+        $cacheHit = ($desired !== null);
+        GcsMetrics::stop('plan_cache');
+        GcsMetrics::set('cacheHit', $cacheHit);
+
+        if ($desired === null) {
+            $desired = self::planIncremental($config, $runner, $sources, $guardDate, $debug);
+            if ($cacheKey !== null && !empty($desired['ok'])) {
+                PlanCache::store($cacheKey, $desired);
+            }
+        }
+        unset($sources);
+
+        if (empty($desired['ok'])) {
+            return $desired;
+        }
+
+        $desiredEntries = $desired['desiredEntries'];
+        $bundles        = $desired['desiredBundles'];
+
+        /* -----------------------------------------------------------------
+         * 6. Load existing scheduler state + diff
+         * ----------------------------------------------------------------- */
+        GcsMetrics::start('diff');
+        $inventory   = ScheduleInventory::load();
+        $existingRaw = $inventory->entries();
+
+        $diff = (new SchedulerDiff($desiredEntries, $inventory->state()))->compute();
+        GcsMetrics::stop('diff');
+
+        GcsMetrics::set('entries', count($desiredEntries));
+        GcsMetrics::set('existing', count($existingRaw));
+
+        GcsTrace::event(GcsTrace::ORDERING, 'plan', [
+            'cacheHit' => $cacheHit,
+            'entries'  => count($desiredEntries),
+            'creates'  => count($diff->creates()),
+            'updates'  => count($diff->updates()),
+            'deletes'  => count($diff->deletes()),
+        ]);
+
+        return [
+            'ok'             => true,
+            'creates'        => $diff->creates(),
+            'updates'        => $diff->updates(),
+            'deletes'        => $diff->deletes(),
+            'desiredEntries' => $desiredEntries,
+            'desiredBundles' => $bundles,
+            'existingRaw'    => $existingRaw,
+            'existingKeys'   => $inventory->keys(),
+            'existingDigest' => $inventory->digest(),
+        ];
+    }
+
+    /**
+     * Steps 2-5 with per-UID bundle reuse (BundleCache): only UIDs whose
+     * event group changed are resolved, expanded and rebuilt; ordering
+     * and everything after it still run over the full bundle list, so
+     * the result equals a full plan.
+     *
+     * runtime.verify_incremental re-plans in full as well and logs (and
+     * uses) the full result when the two differ.
+     *
+     * @param array<int,array<string,mixed>> $sources
+     * @return array<string,mixed> planDesired() result
+     */
+    private static function planIncremental(
+        array $config,
+        SchedulerRunner $runner,
+        array $sources,
+        string $guardDate,
+        bool $debug
+    ): array {
+        $stamp  = $debug ? null : BundleCache::stamp($config, $guardDate);
+        $cached = ($stamp !== null) ? BundleCache::load($stamp) : [];
+
+        $known = [];
+        foreach ($cached as $uid => $entry) {
+            $known[$uid] = (string)($entry['hash'] ?? '');
+        }
+
+        $entries = [];
+        $desired = self::planDesired($config, $runner->run($sources, $known), $guardDate, $debug, $cached, $entries);
+        if (empty($desired['ok'])) {
+            return $desired;
+        }
+
+        if ($stamp !== null && !empty($config['runtime']['verify_incremental'])) {
+            $full = self::planDesired($config, $runner->run($sources), $guardDate, $debug);
+            if (serialize($full) !== serialize($desired)) {
+                GcsLogger::instance()->error('Incremental plan differs from full plan; bundle cache dropped', [
+                    'cachedUids' => count($known),
+                    'entries'    => count($full['desiredEntries'] ?? []),
+                ]);
+                BundleCache::clear();
+                return $full;
+            }
+        }
+
+        if ($stamp !== null && $entries !== $cached) {
+            BundleCache::store($stamp, $entries);
+        }
+
+        return $desired;
+    }
+
+    /**
+     * Steps 2-5: runner series -> ordered bundles + guarded entries.
+     *
+     * @param array<string,array<string,mixed>> $cachedBundles BundleCache::load()
+     *        entries for the series the runner emitted as cached
+     * @param array<string,array<string,mixed>> $bundleEntries Receives the
+     *        BundleCache entry of every series planned here
+     * @return array<string,mixed> ['ok' => true, 'desiredEntries',
+     *         'desiredBundles'], or an error result (runner failure,
+     *         entry limit)
+     */
+    private static function planDesired(
+        array $config,
+        array $runnerResult,
+        string $guardDate,
+        bool $debug,
+        array $cachedBundles = [],
+        ?array &$bundleEntries = null
+    ): array {
+        $bundleEntries = [];
+
+        // A calendar that failed to fetch must not read as "no events"
+        if (empty($runnerResult['ok'])) {
+            return [
+                'ok'    => false,
+                'error' => $runnerResult['errors'][0] ?? ['type' => 'runner_failed'],
+            ];
+        }
 
         $series = (isset($runnerResult['series']) && is_array($runnerResult['series']))
             ? $runnerResult['series']
@@ -85,7 +262,9 @@ final class SchedulerPlanner
          * For now, overrides are kept as an empty array to keep bundle cohesion
          * logic stable and ready for future override emission.
          * ----------------------------------------------------------------- */
+        GcsMetrics::start('bundles');
         $bundles = [];
+        $reused  = 0;
 
         foreach ($series as $s) {
             if (!is_array($s)) {
@@ -97,76 +276,26 @@ final class SchedulerPlanner
                 continue;
             }
 
-            $summary  = (string)($s['summary'] ?? '');
-            $resolved = (isset($s['resolved']) && is_array($s['resolved'])) ? $s['resolved'] : null;
-            if (!$resolved || empty($resolved['type']) || !array_key_exists('target', $resolved)) {
-                if ($debug) {
-                    self::dbg($config, 'skip_series_unresolved', [
-                        'uid'     => $uid,
-                        'summary' => $summary,
-                        'resolved'=> $resolved,
-                    ]);
-                }
-                continue;
+            // Unchanged event group: the runner skipped it, reuse its bundle
+            if (!empty($s['cached']) && isset($cachedBundles[$uid])) {
+                $bundle = $cachedBundles[$uid]['bundle'];
+                $reused++;
+            } else {
+                $bundle = self::buildBaseBundle($config, $s, $guardDate, $debug);
             }
 
-            $baseEv = (isset($s['base']) && is_array($s['base'])) ? $s['base'] : null;
-            if (!$baseEv || empty($baseEv['start']) || empty($baseEv['end'])) {
-                if ($debug) {
-                    self::dbg($config, 'skip_series_no_base', [
-                        'uid'     => $uid,
-                        'summary' => $summary,
-                    ]);
-                }
-                continue;
+            if (isset($s['groupHash'])) {
+                $bundleEntries[$uid] = ['hash' => (string)$s['groupHash'], 'bundle' => $bundle];
             }
-
-            try {
-                $baseStartDT = new DateTime((string)$baseEv['start']);
-                $baseEndDT   = new DateTime((string)$baseEv['end']);
-            } catch (\Throwable $e) {
-                if ($debug) {
-                    self::dbg($config, 'skip_series_bad_base_dates', [
-                        'uid'     => $uid,
-                        'summary' => $summary,
-                        'err'     => $e->getMessage(),
-                        'start'   => $baseEv['start'] ?? null,
-                        'end'     => $baseEv['end'] ?? null,
-                    ]);
-                }
-                continue;
+            if ($bundle !== null) {
+                $bundles[] = $bundle;
             }
-
-            $seriesStartDate = $baseStartDT->format('Y-m-d');
-            $seriesEndDate   = self::pickSeriesEndDateFromRrule($baseEv, $guardDate) ?? $guardDate;
-            $daysShort       = self::deriveDaysShortFromBase($baseEv, $baseStartDT);
-
-            $bundles[] = [
-                'overrides' => [],
-                'base' => [
-                    'uid' => $uid,
-                    'template' => [
-                        'uid'        => $uid,
-                        'summary'    => $summary,
-                        'type'       => FPPSemantics::normalizeType((string)$resolved['type']),
-                        'target'     => $resolved['target'],
-                        'start'      => $baseStartDT->format('Y-m-d H:i:s'),
-                        'end'        => $baseEndDT->format('Y-m-d H:i:s'),
-                        'stopType'   => FPPSemantics::getDefaultStopType(),
-                        'repeat'     => FPPSemantics::getDefaultRepeatForType(
-                            FPPSemantics::normalizeType((string)$resolved['type'])
-                        ),
-                        'isOverride' => false,
-                    ],
-                    'range' => [
-                        'start' => $seriesStartDate,
-                        'end'   => $seriesEndDate,
-                        'days'  => $daysShort,
-                    ],
-                ],
-            ];
         }
 
+        GcsMetrics::stop('bundles');
+        GcsMetrics::set('bundles', count($bundles));
+        GcsMetrics::set('bundlesReused', $reused);
+
         if ($debug) {
             self::dbg($config, 'bundles_built', [
                 'bundle_count' => count($bundles),
@@ -187,6 +316,7 @@ final class SchedulerPlanner
          * ----------------------------------------------------------------- */
 
         // 3a) Baseline chronological order (date / time / type / target)
+        GcsMetrics::start('order');
         usort($bundles, static function (array $a, array $b): int {
             $ar = $a['base']['range'] ?? [];
             $br = $b['base']['range'] ?? [];
@@ -224,7 +354,7 @@ final class SchedulerPlanner
         });
 
         if ($debug) {
-            self::dbgWriteHuman('/tmp/gcs_planner_order_initial.txt', $bundles);
+            self::dbgWriteHuman('gcs_planner_order_initial.txt', $bundles);
             self::dbg($config, 'order_baseline_done', ['bundle_count' => count($bundles)]);
         }
 
@@ -233,7 +363,16 @@ final class SchedulerPlanner
         $swapsTotal = 0;
         $n          = count($bundles);
 
-        while ($passes < self::MAX_ORDER_PASSES) {
+        // Same relaxation in the native engine (overlap-indexed); the
+        // PHP loop below remains the reference and the debug path
+        $native = $debug ? null : NativeEngine::orderBundles($config, $bundles, self::MAX_ORDER_PASSES);
+        if ($native !== null) {
+            $bundles    = $native['bundles'];
+            $passes     = $native['passes'];
+            $swapsTotal = $native['swaps'];
+        }
+
+        while ($native === null && $passes < self::MAX_ORDER_PASSES) {
             $passes++;
             $changed = false;
 
@@ -293,6 +432,11 @@ final class SchedulerPlanner
             }
         }
 
+        GcsMetrics::stop('order');
+        GcsMetrics::set('orderPasses', $passes);
+        GcsMetrics::set('orderSwaps', $swapsTotal);
+        GcsMetrics::set('orderNative', $native !== null);
+
         // Final ordering snapshot
         if ($debug) {
             self::dbg($config, 'order_done', [
@@ -300,12 +444,13 @@ final class SchedulerPlanner
                 'swapsTotal' => $swapsTotal,
                 'note'       => ($passes >= self::MAX_ORDER_PASSES) ? 'hit_max_passes' : 'stabilized',
             ]);
-            self::dbgWriteHuman('/tmp/gcs_planner_order_after_passes.txt', $bundles);
+            self::dbgWriteHuman('gcs_planner_order_after_passes.txt', $bundles);
         }
 
         /* -----------------------------------------------------------------
          * 4. Flatten bundles (bundle cohesion preserved)
          * ----------------------------------------------------------------- */
+        GcsMetrics::start('flatten');
         $desiredEntries = [];
 
         foreach ($bundles as $bundle) {
@@ -321,6 +466,8 @@ final class SchedulerPlanner
             }
         }
 
+        GcsMetrics::stop('flatten');
+
         /* -----------------------------------------------------------------
          * 5. Global managed entry cap
          * ----------------------------------------------------------------- */
@@ -336,39 +483,91 @@ final class SchedulerPlanner
             ];
         }
 
-        /* -----------------------------------------------------------------
-         * 6. Load existing scheduler state + diff
-         * ----------------------------------------------------------------- */
-        $existingRaw = SchedulerSync::readScheduleJsonStatic(
-            SchedulerSync::SCHEDULE_JSON_PATH
-        );
-
-        $existingEntries = [];
-        foreach ($existingRaw as $row) {
-            if (is_array($row)) {
-                $existingEntries[] = new ExistingScheduleEntry($row);
+        return [
+            'ok'             => true,
+            'desiredEntries' => $desiredEntries,
+            'desiredBundles' => $bundles,
+        ];
+    }
+
+    /**
+     * Step 2 for one runner series: its base bundle, or null when the
+     * series is skipped (unresolved target, missing / invalid base).
+     *
+     * @param array<string,mixed> $s
+     * @return array<string,mixed>|null
+     */
+    private static function buildBaseBundle(array $config, array $s, string $guardDate, bool $debug): ?array
+    {
+        $uid      = (string)($s['uid'] ?? '');
+        $summary  = (string)($s['summary'] ?? '');
+        $resolved = (isset($s['resolved']) && is_array($s['resolved'])) ? $s['resolved'] : null;
+        if (!$resolved || empty($resolved['type']) || !array_key_exists('target', $resolved)) {
+            if ($debug) {
+                self::dbg($config, 'skip_series_unresolved', [
+                    'uid'     => $uid,
+                    'summary' => $summary,
+                    'resolved'=> $resolved,
+                ]);
             }
+            return null;
         }
 
-        $state = new SchedulerState($existingEntries);
-        $diff  = (new SchedulerDiff($desiredEntries, $state))->compute();
+        $baseEv = (isset($s['base']) && is_array($s['base'])) ? $s['base'] : null;
+        if (!$baseEv || empty($baseEv['start']) || empty($baseEv['end'])) {
+            if ($debug) {
+                self::dbg($config, 'skip_series_no_base', [
+                    'uid'     => $uid,
+                    'summary' => $summary,
+                ]);
+            }
+            return null;
+        }
 
-        if ($debug) {
-            self::dbg($config, 'diff', [
-                'creates' => count($diff->creates()),
-                'updates' => count($diff->updates()),
-                'deletes' => count($diff->deletes()),
-            ]);
+        try {
+            $baseStartDT = new DateTime((string)$baseEv['start']);
+            $baseEndDT   = new DateTime((string)$baseEv['end']);
+        } catch (\Throwable $e) {
+            if ($debug) {
+                self::dbg($config, 'skip_series_bad_base_dates', [
+                    'uid'     => $uid,
+                    'summary' => $summary,
+                    'err'     => $e->getMessage(),
+                    'start'   => $baseEv['start'] ?? null,
+                    'end'     => $baseEv['end'] ?? null,
+                ]);
+            }
+            return null;
         }
 
+        $seriesStartDate = $baseStartDT->format('Y-m-d');
+        $seriesEndDate   = self::pickSeriesEndDateFromRrule($baseEv, $guardDate) ?? $guardDate;
+        $dayMask         = self::deriveDayMaskFromBase($baseEv, $baseStartDT);
+
         return [
-            'ok'             => true,
-            'creates'        => $diff->creates(),
-            'updates'        => $diff->updates(),
-            'deletes'        => $diff->deletes(),
-            'desiredEntries' => $desiredEntries,
-            'desiredBundles' => $bundles,
-            'existingRaw'    => $existingRaw,
+            'overrides' => [],
+            'base' => [
+                'uid' => $uid,
+                'template' => [
+                    'uid'        => $uid,
+                    'summary'    => $summary,
+                    'type'       => FPPSemantics::normalizeType((string)$resolved['type']),
+                    'target'     => $resolved['target'],
+                    'start'      => $baseStartDT->format('Y-m-d H:i:s'),
+                    'end'        => $baseEndDT->format('Y-m-d H:i:s'),
+                    'stopType'   => FPPSemantics::getDefaultStopType(),
+                    'repeat'     => FPPSemantics::getDefaultRepeatForType(
+                        FPPSemantics::normalizeType((string)$resolved['type'])
+                    ),
+                    'isOverride' => false,
+                ],
+                'range' => [
+                    'start' => $seriesStartDate,
+                    'end'   => $seriesEndDate,
+                    'days'    => DayMask::toShort($dayMask),
+                    'dayMask' => $dayMask,
+                ],
+            ],
         ];
     }
 
@@ -376,37 +575,28 @@ final class SchedulerPlanner
      * Debug helpers
      * =============================================================== */
 
+    /**
+     * Ordering traced at DETAIL (levels resolved in plan() from $cfg).
+     */
     private static function isDebugOrderingEnabled(array $cfg): bool
     {
-        if (!empty($cfg['runtime']['debug_ordering'])) {
-            return true;
-        }
-        $env = getenv('GCS_DEBUG_ORDERING');
-        return ($env !== false && $env !== '' && $env !== '0');
+        return GcsTrace::enabled(GcsTrace::ORDERING, GcsTrace::DETAIL);
     }
 
     private static function dbgReset(): void
     {
-        @unlink('/tmp/gcs_planner_order_debug.log');
-        @unlink('/tmp/gcs_planner_order_initial.txt');
-        @unlink('/tmp/gcs_planner_order_after_passes.txt');
+        GcsTrace::reset(GcsTrace::ORDERING, [
+            'gcs_planner_order_initial.txt',
+            'gcs_planner_order_after_passes.txt',
+        ]);
     }
 
     private static function dbg(array $cfg, string $tag, array $data): void
     {
-        if (!self::isDebugOrderingEnabled($cfg)) {
-            return;
-        }
-        $line = json_encode([
-            'ts'   => date('c'),
-            'tag'  => $tag,
-            'data' => $data,
-        ], JSON_UNESCAPED_SLASHES) . PHP_EOL;
-
-        file_put_contents('/tmp/gcs_planner_order_debug.log', $line, FILE_APPEND);
+        GcsTrace::event(GcsTrace::ORDERING, $tag, $data, GcsTrace::DETAIL);
     }
 
-    private static function dbgWriteHuman(string $path, array $bundles): void
+    private static function dbgWriteHuman(string $file, array $bundles): void
     {
         $lines = [];
         foreach ($bundles as $i => $b) {
@@ -425,7 +615,7 @@ final class SchedulerPlanner
                     : gettype($b['base']['template']['target'] ?? null)
             );
         }
-        file_put_contents($path, implode("\n", $lines) . "\n");
+        GcsTrace::dump(GcsTrace::ORDERING, $file, implode("\n", $lines) . "\n");
     }
 
     private static function bundleDebugRow(array $bundle): array
@@ -464,21 +654,21 @@ final class SchedulerPlanner
         return $entry;
     }
 
-    private static function deriveDaysShortFromBase(array $baseEv, DateTime $dtStart): string
+    private static function deriveDayMaskFromBase(array $baseEv, DateTime $dtStart): int
     {
         $rrule = $baseEv['rrule'] ?? null;
         if (is_array($rrule)) {
             if (strtoupper((string)($rrule['FREQ'] ?? '')) === 'DAILY') {
-                return 'SuMoTuWeThFrSa';
+                return DayMask::ALL;
             }
             if (!empty($rrule['BYDAY'])) {
-                $days = self::shortDaysFromByDay((string)$rrule['BYDAY']);
-                if ($days !== '') {
-                    return $days;
+                $mask = DayMask::fromByDay((string)$rrule['BYDAY']);
+                if ($mask !== DayMask::NONE) {
+                    return $mask;
                 }
             }
         }
-        return self::dowToShortDay((int)$dtStart->format('w'));
+        return DayMask::fromDow((int)$dtStart->format('w'));
     }
 
     /**
@@ -522,24 +712,6 @@ final class SchedulerPlanner
         }
     }
 
-    private static function dowToShortDay(int $dow): string
-    {
-        return ['Su','Mo','Tu','We','Th','Fr','Sa'][$dow] ?? '';
-    }
-
-    private static function shortDaysFromByDay(string $bydayRaw): string
-    {
-        $map = ['SU'=>'Su','MO'=>'Mo','TU'=>'Tu','WE'=>'We','TH'=>'Th','FR'=>'Fr','SA'=>'Sa'];
-        $out = '';
-        foreach (explode(',', strtoupper(trim($bydayRaw))) as $d) {
-            $d = preg_replace('/^[+-]?\d+/', '', trim($d));
-            if (isset($map[$d])) {
-                $out .= $map[$d];
-            }
-        }
-        return $out;
-    }
-
     private static function isValidYmd(string $s): bool
     {
         return preg_match('/^\d{4}-\d{2}-\d{2}$/', $s) === 1;
@@ -556,6 +728,8 @@ final class SchedulerPlanner
 
     private static function basesOverlapVerbose(array $a, array $b, ?array $debugCfg): array
     {
+        GcsMetrics::count('overlapChecks');
+
         $ar = $a['range'] ?? [];
         $br = $b['range'] ?? [];
 
@@ -578,14 +752,14 @@ final class SchedulerPlanner
             ];
         }
 
-        $aDays = (string)($ar['days'] ?? '');
-        $bDays = (string)($br['days'] ?? '');
-        if (!self::daysOverlapShort($aDays, $bDays)) {
+        $aDays = self::rangeDayMask($ar);
+        $bDays = self::rangeDayMask($br);
+        if (!DayMask::overlaps($aDays, $bDays)) {
             return [
                 'overlaps' => false,
                 'reason'   => 'days_no_intersection',
-                'A_days'   => $aDays,
-                'B_days'   => $bDays,
+                'A_days'   => DayMask::toShort($aDays),
+                'B_days'   => DayMask::toShort($bDays),
             ];
         }
 
@@ -614,36 +788,14 @@ final class SchedulerPlanner
     }
 
     /**
-     * true if EVERY day in $inner exists in $outer (both compact 2-letter chunks)
+     * Range day set as a mask ('days' string accepted for older bundles)
      */
-    private static function daysContainShort(string $inner, string $outer): bool
+    private static function rangeDayMask(array $range): int
     {
-        if ($inner === '' || $outer === '') {
-            return false;
-        }
-        $len = strlen($inner);
-        for ($i = 0; $i + 1 < $len; $i += 2) {
-            $d = substr($inner, $i, 2);
-            if ($d !== '' && strpos($outer, $d) === false) {
-                return false;
-            }
+        if (is_int($range['dayMask'] ?? null)) {
+            return $range['dayMask'];
         }
-        return true;
-    }
-
-    private static function daysOverlapShort(string $a, string $b): bool
-    {
-        if ($a === '' || $b === '') {
-            return false;
-        }
-        $len = strlen($a);
-        for ($i = 0; $i + 1 < $len; $i += 2) {
-            $d = substr($a, $i, 2);
-            if ($d !== '' && strpos($b, $d) !== false) {
-                return true;
-            }
-        }
-        return false;
+        return DayMask::fromShort((string)($range['days'] ?? ''));
     }
 
     private static function timeToSeconds(string $t): int
@@ -711,10 +863,8 @@ final class SchedulerPlanner
 
         // Day mask: A must run on B's start day
         $bDow = (int)(new DateTime($bStartDate))->format('w');
-        $bDowShort = self::dowToShortDay($bDow);
 
-        $aDays = (string)($aBase['range']['days'] ?? '');
-        if ($aDays === '' || strpos($aDays, $bDowShort) === false) {
+        if (!DayMask::has(self::rangeDayMask($aBase['range'] ?? []), $bDow)) {
             return false;
         }
 
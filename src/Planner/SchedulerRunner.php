@@ -33,27 +33,113 @@ final class SchedulerRunner
     public function __construct(array $cfg)
     {
         $this->cfg = $cfg;
+        GcsTrace::configure($cfg);
     }
 
-    public function run(): array
+    /**
+     * Fetch every configured calendar.
+     *
+     * Each source carries the content digest of its body
+     * (hash('fnv1a64'), the same on the native and PHP paths).
+     * Natively, the calendars are fetched and parsed concurrently in
+     * the engine's workers (each body parsed while it streams in), and
+     * the source carries the cached body path and its 'events'; the PHP
+     * path carries the body itself, parsed by run() only when needed.
+     * SchedulerPlanner keys its plan cache on the digests, then hands
+     * the sources back to run().
+     *
+     * @return array<int,array{url:string,digest:string,path:?string,ics:?string,events?:array<int,array<string,mixed>>}>
+     */
+    public function fetchSources(): array
     {
-        // heartbeat (debug only; safe side-effect)
-        file_put_contents('/tmp/gcs_runner_ran.txt', date('c') . PHP_EOL, FILE_APPEND);
+        $sources = [];
+        $icsUrls = Config::icsUrls($this->cfg);
+        $fetched = NativeEngine::fetchCalendars(
+            $this->cfg,
+            $icsUrls,
+            new DateTime('now'),
+            FPPSemantics::getSchedulerGuardDate()
+        );
 
-        /* ------------------------------------------------------------
-         * Calendar fetch
-         * ---------------------------------------------------------- */
-        $icsUrl = trim((string)($this->cfg['calendar']['ics_url'] ?? ''));
-        if ($icsUrl === '') {
-            GcsLogger::instance()->warn('No ICS URL configured');
-            return $this->emptyResult();
+        foreach ($icsUrls as $i => $icsUrl) {
+            if (isset($fetched[$i])) {
+                $sources[] = [
+                    'url'    => $icsUrl,
+                    'digest' => $fetched[$i]['digest'],
+                    'path'   => $fetched[$i]['path'],
+                    'ics'    => null,
+                    'events' => $fetched[$i]['events'],
+                ];
+                continue;
+            }
+
+            $ics = (new IcsFetcher())->fetch($icsUrl);
+            $sources[] = [
+                'url'    => $icsUrl,
+                'digest' => hash('fnv1a64', $ics),
+                'path'   => null,
+                'ics'    => $ics,
+            ];
         }
 
-        $ics = (new IcsFetcher())->fetch($icsUrl);
-        if ($ics === '') {
-            return $this->emptyResult();
+        return $sources;
+    }
+
+    /**
+     * Content digest of every configured calendar, without parsing
+     * (AutoSync change detection): natively a conditional fetch into
+     * the ICS cache, where a 304 costs neither download nor parse.
+     * Same shape as fetchSources() minus 'events'.
+     *
+     * @return array<int,array{url:string,digest:string,path:?string,ics:?string}>
+     */
+    public function pollSources(): array
+    {
+        $sources = [];
+        $icsUrls = Config::icsUrls($this->cfg);
+        $fetched = NativeEngine::fetchCalendars($this->cfg, $icsUrls, null, null, false);
+
+        foreach ($icsUrls as $i => $icsUrl) {
+            if (isset($fetched[$i])) {
+                $sources[] = [
+                    'url'    => $icsUrl,
+                    'digest' => $fetched[$i]['digest'],
+                    'path'   => $fetched[$i]['path'],
+                    'ics'    => null,
+                ];
+                continue;
+            }
+
+            $ics = (new IcsFetcher())->fetch($icsUrl);
+            $sources[] = [
+                'url'    => $icsUrl,
+                'digest' => hash('fnv1a64', $ics),
+                'path'   => null,
+                'ics'    => $ics,
+            ];
         }
 
+        return $sources;
+    }
+
+    /**
+     * A calendar that could not be fetched (or read back) fails the
+     * whole run with ok = false: planning from the other calendars
+     * alone would delete its managed entries.
+     *
+     * Every series carries 'groupHash' (BundleCache::groupHash() of its
+     * event group). A UID whose hash matches $known is neither resolved
+     * nor expanded: it is emitted as ['uid', 'groupHash', 'cached' =>
+     * true] in its usual position, and the caller reuses its bundle.
+     *
+     * @param array<int,array<string,mixed>>|null $sources fetchSources()
+     *        result; null fetches (and natively, parses) in one step
+     * @param array<string,string> $known uid => group hash already planned
+     */
+    public function run(?array $sources = null, array $known = []): array
+    {
+        GcsTrace::event(GcsTrace::RUNNER, 'run', ['prefetched' => $sources !== null]);
+
         /* ------------------------------------------------------------
          * Horizon (analysis bound only)
          * ---------------------------------------------------------- */
@@ -61,15 +147,67 @@ final class SchedulerRunner
         $horizonEnd = FPPSemantics::getSchedulerGuardDate();
 
         /* ------------------------------------------------------------
-         * Parse ICS
+         * Calendar fetch + parse (every configured calendar)
+         *
+         * Native path: all calendars fetched concurrently with
+         * conditional requests into runtime/ (a 304 reuses the cached
+         * body), each parsed while its body streams in; events starting
+         * beyond the horizon are never materialized.
+         * Otherwise, per calendar: IcsFetcher + parse of the body.
+         * Prefetched sources (fetchSources()) arrive parsed from the
+         * native path; PHP-fetched bodies are parsed here.
+         *
+         * Events are concatenated in config order and merged by UID
+         * below (first calendar's base wins).
          * ---------------------------------------------------------- */
-        $parser = new IcsParser();
-        $events = $parser->parse($ics, $now, $horizonEnd);
+        if ($sources === null) {
+            $icsUrls = Config::icsUrls($this->cfg);
+            $fetched = NativeEngine::fetchCalendars($this->cfg, $icsUrls, $now, $horizonEnd);
+
+            $sources = [];
+            foreach ($icsUrls as $i => $icsUrl) {
+                $sources[] = isset($fetched[$i])
+                    ? ['url' => $icsUrl, 'events' => $fetched[$i]['events']]
+                    : ['url' => $icsUrl];
+            }
+            unset($fetched);
+        }
 
-        file_put_contents(
-            '/tmp/gcs_parsed_events_debug.json',
-            json_encode($events, JSON_PRETTY_PRINT)
-        );
+        if ($sources === []) {
+            GcsLogger::instance()->warn('No ICS URL configured');
+            return $this->emptyResult();
+        }
+
+        GcsMetrics::start('parse');
+        $events = [];
+        $failed = [];
+        foreach ($sources as $i => $src) {
+            $parsed = $this->parseSource($src, $now, $horizonEnd);
+            if ($parsed === null) {
+                $failed[] = $i + 1;
+                continue;
+            }
+            array_push($events, ...$parsed);
+        }
+        unset($sources);
+        GcsMetrics::stop('parse');
+
+        if ($failed !== []) {
+            GcsLogger::instance()->error('Calendar fetch failed; not planning from partial data', [
+                'calendars' => $failed,
+            ]);
+            return [
+                'ok'     => false,
+                'series' => [],
+                'errors' => [['type' => 'calendar_fetch_failed', 'calendars' => $failed]],
+            ];
+        }
+        GcsMetrics::set('events', count($events));
+
+        GcsTrace::event(GcsTrace::PARSER, 'parsed', ['events' => count($events)]);
+        GcsTrace::dump(GcsTrace::PARSER, 'gcs_parsed_events_debug.json', static function () use ($events) {
+            return json_encode($events, JSON_PRETTY_PRINT);
+        });
 
         if (empty($events)) {
             return $this->emptyResult();
@@ -78,6 +216,7 @@ final class SchedulerRunner
         /* ------------------------------------------------------------
          * Group by UID
          * ---------------------------------------------------------- */
+        GcsMetrics::start('expand');
         $byUid = [];
         foreach ($events as $ev) {
             if (!is_array($ev)) continue;
@@ -87,12 +226,10 @@ final class SchedulerRunner
             }
         }
 
-        $seriesOut = [];
-        $trace = [];
-
         /* ------------------------------------------------------------
-         * Per-UID processing (analysis only; no intent emission)
+         * Split each UID into base + overrides
          * ---------------------------------------------------------- */
+        $grouped = [];
         foreach ($byUid as $uid => $items) {
             $base = null;
             $overrides = [];
@@ -110,6 +247,44 @@ final class SchedulerRunner
             if (!is_array($refEv)) continue;
             if (!empty($refEv['isAllDay'])) continue;
 
+            $grouped[$uid] = [$base, $overrides, $refEv, BundleCache::groupHash($base, $overrides)];
+        }
+
+        /* ------------------------------------------------------------
+         * Bulk occurrence expansion (native when available; any
+         * series the engine cannot expand falls back to PHP below).
+         * UIDs whose group is unchanged since the last plan are skipped.
+         * ---------------------------------------------------------- */
+        $jobs = [];
+        $jobUids = [];
+        foreach ($grouped as $uid => [$base, $overrides, , $groupHash]) {
+            if (($known[$uid] ?? null) === $groupHash) {
+                continue;
+            }
+            $jobs[] = ['base' => $base, 'overrides' => $overrides];
+            $jobUids[] = $uid;
+        }
+
+        $nativeOccs = [];
+        $expanded = ($jobs !== []) ? NativeEngine::expandOccurrences($this->cfg, $jobs, $now, $horizonEnd) : null;
+        if ($expanded !== null) {
+            $nativeOccs = array_combine($jobUids, $expanded);
+        }
+
+        $seriesOut = [];
+        $trace = [];
+        $reused = 0;
+
+        /* ------------------------------------------------------------
+         * Per-UID processing (analysis only; no intent emission)
+         * ---------------------------------------------------------- */
+        foreach ($grouped as $uid => [$base, $overrides, $refEv, $groupHash]) {
+            if (($known[$uid] ?? null) === $groupHash) {
+                $seriesOut[] = ['uid' => (string)$uid, 'groupHash' => $groupHash, 'cached' => true];
+                $reused++;
+                continue;
+            }
+
             $summary = (string)($refEv['summary'] ?? '');
             $resolved = TargetResolver::resolve($summary);
             if (!$resolved) {
@@ -122,12 +297,14 @@ final class SchedulerRunner
             }
 
             // Expand occurrences (bounded). This is analysis-only now.
-            $occurrences = self::expandEventOccurrences(
-                $base,
-                $overrides,
-                $now,
-                $horizonEnd
-            );
+            $occurrences = isset($nativeOccs[$uid])
+                ? self::attachOccurrenceSources($nativeOccs[$uid], $base, $overrides)
+                : self::expandEventOccurrences(
+                    $base,
+                    $overrides,
+                    $now,
+                    $horizonEnd
+                );
 
             $trace[] = [
                 'uid' => $uid,
@@ -140,16 +317,13 @@ final class SchedulerRunner
             // Parse a stable YAML blob for base (prefer base description, else empty)
             $baseYaml = [];
             if (is_array($base)) {
-                $desc = self::extractDescriptionFromEvent($base);
-                $yaml = YamlMetadata::parse($desc, [
+                $yaml = self::eventYaml($base, [
                     'uid'     => $uid,
                     'summary' => $summary,
                     'start'   => (string)($base['start'] ?? ''),
                 ]);
-                if (is_array($yaml)) {
-                    ksort($yaml);
-                    $baseYaml = $yaml;
-                }
+                ksort($yaml);
+                $baseYaml = $yaml;
             }
 
             // Extract override occurrences (only those occurrences that are overrides)
@@ -164,16 +338,12 @@ final class SchedulerRunner
 
                 $yaml = [];
                 if ($sourceEv) {
-                    $desc = self::extractDescriptionFromEvent($sourceEv);
-                    $parsed = YamlMetadata::parse($desc, [
+                    $yaml = self::eventYaml($sourceEv, [
                         'uid'     => $uid,
                         'summary' => $summary,
                         'start'   => $rid,
                     ]);
-                    if (is_array($parsed)) {
-                        ksort($parsed);
-                        $yaml = $parsed;
-                    }
+                    ksort($yaml);
                 }
 
                 $overrideOccs[] = [
@@ -187,6 +357,7 @@ final class SchedulerRunner
             // Planner will create a base schedule from DTSTART/RRULE even if occurrence_count == 0.
             $seriesOut[] = [
                 'uid'          => $uid,
+                'groupHash'    => $groupHash,
                 'summary'      => $summary,
                 'resolved'     => $resolved,
                 'base'         => $base,
@@ -201,10 +372,18 @@ final class SchedulerRunner
             ];
         }
 
-        file_put_contents(
-            '/tmp/gcs_runner_trace.json',
-            json_encode($trace, JSON_PRETTY_PRINT)
-        );
+        GcsMetrics::stop('expand');
+        GcsMetrics::set('series', count($seriesOut));
+        GcsMetrics::set('seriesReused', $reused);
+
+        GcsTrace::event(GcsTrace::RUNNER, 'series', [
+            'series'  => count($seriesOut),
+            'reused'  => $reused,
+            'skipped' => count($trace),
+        ]);
+        GcsTrace::dump(GcsTrace::RUNNER, 'gcs_runner_trace.json', static function () use ($trace) {
+            return json_encode($trace, JSON_PRETTY_PRINT);
+        });
 
         return [
             'ok'     => true,
@@ -213,6 +392,35 @@ final class SchedulerRunner
         ];
     }
 
+    /**
+     * Events of one calendar source (already parsed, cached file,
+     * fetched body, or fetched here), native parser first.
+     *
+     * @param array<string,mixed> $src
+     * @return array<int,array<string,mixed>>|null null when the body
+     *         could not be fetched or read
+     */
+    private function parseSource(array $src, DateTime $now, DateTime $horizonEnd): ?array
+    {
+        if (isset($src['events'])) {
+            return $src['events'];
+        }
+
+        if (isset($src['path'])) {
+            $events = NativeEngine::parseIcsFile($this->cfg, $src['path'], $now, $horizonEnd);
+            $ics = ($events === null) ? @file_get_contents($src['path']) : '';
+        } else {
+            $ics = $src['ics'] ?? (new IcsFetcher())->fetch((string)$src['url']);
+            $events = ($ics !== '') ? NativeEngine::parseIcs($this->cfg, $ics, $now, $horizonEnd) : null;
+        }
+
+        if ($events === null && is_string($ics) && $ics !== '') {
+            $parser = new IcsParser();
+            $events = $parser->parse($ics, $now, $horizonEnd);
+        }
+        return $events;
+    }
+
     private function emptyResult(): array
     {
         return ['ok' => true, 'series' => [], 'errors' => []];
@@ -227,6 +435,55 @@ final class SchedulerRunner
         return null;
     }
 
+    /**
+     * YAML metadata of an event: pre-parsed by the native parser
+     * ('yaml', see bin/gcs/YamlMeta.h) or parsed here from its
+     * description.
+     *
+     * @param array<string,mixed> $ev
+     * @param array<string,mixed> $context
+     * @return array<string,mixed>
+     */
+    private static function eventYaml(array $ev, array $context): array
+    {
+        if (is_array($ev['yaml'] ?? null)) {
+            return $ev['yaml'];
+        }
+
+        return YamlMetadata::parse(self::extractDescriptionFromEvent($ev), $context);
+    }
+
+    /**
+     * Re-attach the 'source' event to natively expanded occurrences
+     * (the engine only returns start/end/isOverride).
+     *
+     * @param array<int,array<string,mixed>> $occs
+     * @param array<string,array<string,mixed>> $overrides
+     * @return array<int,array<string,mixed>>
+     */
+    private static function attachOccurrenceSources(array $occs, ?array $base, array $overrides): array
+    {
+        $byStart = [];
+        foreach ($overrides as $ov) {
+            $byStart[(string)($ov['start'] ?? '')] = $ov;
+        }
+
+        $out = [];
+        foreach ($occs as $occ) {
+            $isOverride = !empty($occ['isOverride']);
+            $start = (string)($occ['start'] ?? '');
+
+            $out[] = [
+                'start'      => $start,
+                'end'        => (string)($occ['end'] ?? ''),
+                'isOverride' => $isOverride,
+                'source'     => $isOverride ? ($byStart[$start] ?? null) : $base,
+            ];
+        }
+
+        return $out;
+    }
+
     /**
      * Expand recurring and non-recurring events into concrete
      * occurrences intersecting the horizon.
@@ -23,6 +23,9 @@ final class SchedulerSync
 {
     public const SCHEDULE_JSON_PATH = '/home/fpp/media/config/schedule.json';
 
+    /** Delta backups (schedule.json.delta-*) kept by the native apply */
+    public const SCHEDULE_BACKUPS_KEPT = 10;
+
     /* -------------------------------------------------------------------------
      * schedule.json I/O
      * ---------------------------------------------------------------------- */
@@ -45,6 +48,17 @@ final class SchedulerSync
             return [];
         }
 
+        return self::decodeScheduleJsonStatic($raw);
+    }
+
+    /**
+     * Decode schedule.json bytes already read by the caller
+     * (ScheduleInventory, which also digests them).
+     *
+     * @return array<int,array<string,mixed>>
+     */
+    public static function decodeScheduleJsonStatic(string $raw): array
+    {
         $rawTrim = trim($raw);
         if ($rawTrim === '') {
             return [];
@@ -101,6 +115,25 @@ final class SchedulerSync
         return $decoded;
     }
 
+    /**
+     * Refuse to rewrite a schedule.json edited since it was planned.
+     *
+     * @param string $expectDigest hash('fnv1a64') of the bytes planned
+     *        against (ScheduleInventory::digest()); '' skips the check
+     * @throws RuntimeException when the file's bytes differ
+     */
+    public static function assertScheduleUnchangedOrThrow(string $path, string $expectDigest): void
+    {
+        if ($expectDigest === '') {
+            return;
+        }
+
+        $raw = is_file($path) ? @file_get_contents($path) : '';
+        if (!is_string($raw) || hash('fnv1a64', $raw) !== $expectDigest) {
+            throw new RuntimeException("schedule.json changed since it was planned; plan again before applying");
+        }
+    }
+
     /**
      * Create a timestamped backup of schedule.json.
      *
@@ -139,7 +172,18 @@ final class SchedulerSync
 
         $json .= "\n";
 
-        if (@file_put_contents($tmp, $json, LOCK_EX) === false) {
+        // fsync (PHP 8.1+) so the rename never exposes an unwritten file
+        $fh = @fopen($tmp, 'wb');
+        $ok = $fh !== false
+            && flock($fh, LOCK_EX)
+            && fwrite($fh, $json) === strlen($json)
+            && fflush($fh)
+            && (!function_exists('fsync') || fsync($fh));
+        if ($fh !== false) {
+            fclose($fh);
+        }
+        if (!$ok) {
+            @unlink($tmp);
             throw new RuntimeException("Failed to write temp schedule file '{$tmp}'");
         }
 
@@ -151,6 +195,8 @@ final class SchedulerSync
             @unlink($tmp);
             throw new RuntimeException("Failed to replace schedule.json atomically at '{$path}'");
         }
+
+        ScheduleInventory::invalidate($path);
     }
 
     /**
@@ -277,18 +323,19 @@ final class SchedulerSync
 
         $startDate = null;
         $endDate   = null;
-        $shortDays = '';
+        $dayMask   = DayMask::NONE;
 
         if (is_array($range)) {
             $rStart = isset($range['start']) ? (string)$range['start'] : '';
             $rEnd   = isset($range['end']) ? (string)$range['end'] : '';
-            $rDays  = isset($range['days']) ? (string)$range['days'] : '';
 
             if (self::isDateYmd($rStart)) $startDate = $rStart;
             if (self::isDateYmd($rEnd))   $endDate = $rEnd;
 
-            if ($rDays !== '') {
-                $shortDays = trim($rDays);
+            if (is_int($range['dayMask'] ?? null)) {
+                $dayMask = $range['dayMask'];
+            } elseif (isset($range['days'])) {
+                $dayMask = DayMask::fromShort(trim((string)$range['days']));
             }
         }
 
@@ -302,12 +349,13 @@ final class SchedulerSync
         }
 
         // If days were not provided by range, fall back to the start date's weekday.
-        if ($shortDays === '') {
-            $shortDays = self::dowToShortDay((int)$startDt->format('w'));
+        if ($dayMask === DayMask::NONE) {
+            $dayMask = DayMask::fromDow((int)$startDt->format('w'));
         }
 
         // Phase 20 FIX: FPP "day" MUST be an enum selector (0..15), not a weekday bitmask.
-        $fppDayEnum = self::shortDaysToFppDayEnum($shortDays, $startDt);
+        // Sets FPP has no selector for fall back to the start date's weekday.
+        $fppDayEnum = DayMask::toFppEnum($dayMask) ?? (int)$startDt->format('w');
 
         // Phase 29+: canonical managed tag (UID-only identity; no range/days metadata)
         $tag = SchedulerIdentity::buildArgsTag($uid);
@@ -411,52 +459,6 @@ final class SchedulerSync
 
     /* -------------------- helpers -------------------- */
 
-    private static function shortDaysToFppDayEnum(string $shortDays, DateTime $startDt): int
-    {
-        $d = trim($shortDays);
-
-        if ($d === 'SuMoTuWeThFrSa') return 7;
-        if ($d === 'MoTuWeThFr')     return 8;
-        if ($d === 'SuSa')           return 9;
-        if ($d === 'MoWeFr')         return 10;
-        if ($d === 'TuTh')           return 11;
-        if ($d === 'SuMoTuWeTh')     return 12;
-        if ($d === 'FrSa')           return 13;
-
-        $single = self::singleShortDayToFppEnum($d);
-        if ($single !== null) return $single;
-
-        return (int)$startDt->format('w');
-    }
-
-    private static function singleShortDayToFppEnum(string $d): ?int
-    {
-        return match ($d) {
-            'Su' => 0,
-            'Mo' => 1,
-            'Tu' => 2,
-            'We' => 3,
-            'Th' => 4,
-            'Fr' => 5,
-            'Sa' => 6,
-            default => null,
-        };
-    }
-
-    private static function dowToShortDay(int $dow): string
-    {
-        return match ($dow) {
-            0 => 'Su',
-            1 => 'Mo',
-            2 => 'Tu',
-            3 => 'We',
-            4 => 'Th',
-            5 => 'Fr',
-            6 => 'Sa',
-            default => 'Su',
-        };
-    }
-
     /**
      * Remove any GCS-owned tags from args[].
      *
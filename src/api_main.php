@@ -7,7 +7,7 @@ declare(strict_types=1);
  * RESPONSIBILITIES:
  * - Handle POSTed actions from content.php
  * - Save configuration
- * - Trigger scheduler sync (dry-run or live)
+ * - Queue a scheduler sync job (dry-run or live)
  *
  * HARD RULES:
  * - MUST NOT render UI
@@ -42,42 +42,21 @@ if ($action === 'save') {
 
 /*
  * --------------------------------------------------------------------
- * Run scheduler sync (dry-run or live)
+ * Run scheduler sync (plan-only, never writes)
  * --------------------------------------------------------------------
  */
 if ($action === 'sync') {
     $cfg    = Config::load();
     $dryRun = !empty($cfg['runtime']['dry_run']);
 
-    GcsLog::info('Starting scheduler sync', [
+    // Planned by the background worker (see SyncJobs). Plan-only, as
+    // the runner call this replaced: applying is the apply endpoint's job
+    $job = SyncJobs::submit(SyncJobs::TYPE_PREVIEW);
+
+    GcsLog::info('Scheduler sync queued', [
         'dryRun' => $dryRun,
-        'mode'   => $dryRun ? 'dry-run' : 'live',
+        'job'    => $job['id'] ?? null,
     ]);
-
-    /*
-     * Horizon:
-     * - Fixed, non-configurable
-     * - Passed only to satisfy runner constructor
-     * - Planning scope is owned by SchedulerPlanner
-     */
-    $runner = new SchedulerRunner(
-        $cfg,
-        365,
-        $dryRun
-    );
-
-    $result = $runner->run();
-
-    GcsLog::info(
-        'Scheduler sync completed',
-        array_merge(
-            $result,
-            [
-                'dryRun' => $dryRun,
-                'mode'   => $dryRun ? 'dry-run' : 'live',
-            ]
-        )
-    );
 }
 
 /*
@@ -35,8 +35,11 @@ define('GCS_LOG_PATH', '/home/fpp/media/logs/google-calendar-scheduler.log');
  */
 require_once __DIR__ . '/Core/Config.php';
 require_once __DIR__ . '/Core/GcsLog.php';
+require_once __DIR__ . '/Core/GcsTrace.php';
+require_once __DIR__ . '/Core/GcsMetrics.php';
 
 /* ---------- Runtime environment + semantics ---------- */
+require_once __DIR__ . '/Core/DayMask.php';
 require_once __DIR__ . '/Core/FppEnvironment.php';
 require_once __DIR__ . '/Core/FppSemantics.php';
 
@@ -55,9 +58,13 @@ require_once __DIR__ . '/Core/SchedulerIntent.php';
 /* ---------- Parsing / metadata ---------- */
 require_once __DIR__ . '/Core/IcsFetcher.php';
 require_once __DIR__ . '/Core/IcsParser.php';
+require_once __DIR__ . '/Core/NativeRecords.php';
+require_once __DIR__ . '/Core/NativeEngine.php';
 require_once __DIR__ . '/Core/YamlMetadata.php';
 
 require_once __DIR__ . '/Core/TargetResolver.php';
+require_once __DIR__ . '/Core/PlanCache.php';
+require_once __DIR__ . '/Core/BundleCache.php';
 
 require_once __DIR__ . '/Core/DiffPreviewer.php';
 require_once __DIR__ . '/Core/ScheduleEntryExportAdapter.php';
@@ -70,12 +77,10 @@ require_once __DIR__ . '/Core/ScheduleEntryExportAdapter.php';
 try {
     $warnings = [];
 
-    $env = FppEnvironment::loadFromFile(
-        '/home/fpp/media/plugins/GoogleCalendarScheduler/runtime/fpp-env.json',
-        $warnings
-    );
+    $env = FppEnvironment::loadRuntime($warnings);
 
     FPPSemantics::setEnvironment($env->toArray());
+    FPPSemantics::setSunTable($env->getSunTable());
 
     // Optional: log warnings (recommended)
     foreach ($warnings as $w) {
@@ -92,6 +97,7 @@ try {
  * ============================================================
  */
 require_once __DIR__ . '/Planner/SchedulerSync.php';
+require_once __DIR__ . '/Planner/ScheduleInventory.php';
 require_once __DIR__ . '/Planner/SchedulerRunner.php';
 require_once __DIR__ . '/Planner/SchedulerDiff.php';
 require_once __DIR__ . '/Planner/InventorySnapshot.php';
@@ -106,4 +112,6 @@ require_once __DIR__ . '/Planner/SchedulerPlanner.php';
  */
 require_once __DIR__ . '/Apply/SchedulerCleanupPlanner.php';
 require_once __DIR__ . '/Apply/SchedulerCleanupApplier.php';
-require_once __DIR__ . '/Apply/SchedulerApply.php';
\ No newline at end of file
+require_once __DIR__ . '/Apply/SchedulerApply.php';
+require_once __DIR__ . '/Apply/SyncJobs.php';
+require_once __DIR__ . '/Apply/AutoSync.php';
\ No newline at end of file